@@ -151,6 +151,11 @@ void FiffRawViewModel::initFiffData(QIODevice& p_IODevice)
         return;
     }
 
+    // decode the data blocks straight from the file mapping when scrolling
+    if(!m_pFiffIO->m_qlistRaw[0]->file->map_file()) {
+        qInfo() << "[FiffRawViewModel::initFiffData] Could not map the Fiff file into memory. Reading tag by tag instead.";
+    }
+
     // load channel infos
     for(qint32 i=0; i < m_pFiffIO->m_qlistRaw[0]->info.nchan; ++i) {
         m_ChannelInfoList.append(m_pFiffIO->m_qlistRaw[0]->info.chs[i]);
@@ -636,6 +641,16 @@ bool FiffRawViewModel::filterDataBlock(MatrixXd& matData,
     bUseThread = false;
     #endif
 
+    // IIR filters start from zero states for every loaded segment and settle on the lead-in in front of the shown
+    // blocks. The streaming states of m_pRtFilter would continue from an unrelated segment.
+    if(m_filterKernel.isIir()) {
+        matData = RTPROCESSINGLIB::filterData(matData,
+                                              m_filterKernel,
+                                              m_lFilterChannelList,
+                                              bUseThread);
+        return true;
+    }
+
     matData = m_pRtFilter->calculate(matData,
                                      m_filterKernel,
                                      m_lFilterChannelList,
@@ -709,7 +724,11 @@ int FiffRawViewModel::loadEarlierBlocks(qint32 numBlocks)
     int iFilterDelay = 0;
     bool bBeforeStartReached = false;
 
-    if(m_bPerformFiltering) {
+    if(m_bPerformFiltering && m_filterKernel.isIir()) {
+        // IIR filters are causal, they only need a lead-in which covers their impulse response
+        iFilterDelay = qMin(int(m_filterKernel.getCoefficients().cols()), qMax(start - absoluteFirstSample(), 0));
+        start -= iFilterDelay;
+    } else if(m_bPerformFiltering) {
         iFilterDelay = m_filterKernel.getFilterOrder()/2;
         end += m_filterKernel.getFilterOrder()/2;
 
@@ -740,11 +759,18 @@ int FiffRawViewModel::loadEarlierBlocks(qint32 numBlocks)
     // Filter data if activated, otherwise set to raw data
     if(m_bPerformFiltering) {
         bool bFilterSuccess = false;
-        if(bBeforeStartReached) {
+        int iFilteredOffset = 0;
+        if(m_filterKernel.isIir()) {
+            // The causal IIR output is not delayed
+            bFilterSuccess = filterDataBlock(matData, true);
+            iFilteredOffset = iFilterDelay;
+        } else if(bBeforeStartReached) {
             iFilterDelay = m_filterKernel.getFilterOrder()/4;
             bFilterSuccess = filterDataBlock(matData, true, true);
+            iFilteredOffset = 2*iFilterDelay;
         } else {
             bFilterSuccess = filterDataBlock(matData, true);
+            iFilteredOffset = 2*iFilterDelay;
         }
 
         if(!bFilterSuccess) {
@@ -753,8 +779,8 @@ int FiffRawViewModel::loadEarlierBlocks(qint32 numBlocks)
         }
 
         for(int i = 0; i < numBlocks; ++i) {
-            m_lFilteredNewData.push_front(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, (i*m_iSamplesPerBlock)+(2*iFilterDelay), matData.rows(), m_iSamplesPerBlock),
-                                                                                                       matTimes.block(0, (i*m_iSamplesPerBlock)+(2*iFilterDelay), matTimes.rows(), m_iSamplesPerBlock))));
+            m_lFilteredNewData.push_front(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, (i*m_iSamplesPerBlock)+iFilteredOffset, matData.rows(), m_iSamplesPerBlock),
+                                                                                                       matTimes.block(0, (i*m_iSamplesPerBlock)+iFilteredOffset, matTimes.rows(), m_iSamplesPerBlock))));
         }
     } else {
         m_lFilteredNewData = m_lNewData;
@@ -804,7 +830,11 @@ int FiffRawViewModel::loadLaterBlocks(qint32 numBlocks)
     // Account for filter delay of current filter kernel
     int iFilterDelay = 0;
 
-    if(m_bPerformFiltering) {
+    if(m_bPerformFiltering && m_filterKernel.isIir()) {
+        // IIR filters are causal, they only need a lead-in which covers their impulse response
+        iFilterDelay = qMin(int(m_filterKernel.getCoefficients().cols()), qMax(start - absoluteFirstSample(), 0));
+        start -= iFilterDelay;
+    } else if(m_bPerformFiltering) {
         iFilterDelay = m_filterKernel.getFilterOrder()/2;
 
         // Check if we have reached the beginning/end of the file
@@ -841,9 +871,12 @@ int FiffRawViewModel::loadLaterBlocks(qint32 numBlocks)
             return 1;
         }
 
+        // The causal IIR output is not delayed
+        int iFilteredOffset = m_filterKernel.isIir() ? iFilterDelay : 2*iFilterDelay;
+
         for(int i = 0; i < numBlocks; ++i) {
-            m_lFilteredNewData.push_back(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, i*m_iSamplesPerBlock+(2*iFilterDelay), matData.rows(), m_iSamplesPerBlock),
-                                                                                                      matTimes.block(0, i*m_iSamplesPerBlock+(2*iFilterDelay), matTimes.rows(), m_iSamplesPerBlock))));
+            m_lFilteredNewData.push_back(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, i*m_iSamplesPerBlock+iFilteredOffset, matData.rows(), m_iSamplesPerBlock),
+                                                                                                      matTimes.block(0, i*m_iSamplesPerBlock+iFilteredOffset, matTimes.rows(), m_iSamplesPerBlock))));
         }
     } else {
         m_lFilteredNewData = m_lNewData;
@@ -939,7 +972,11 @@ void FiffRawViewModel::reloadAllData()
     int iFilterDelay = 0;
     bool bBeforeStartReached = false;
 
-    if(m_bPerformFiltering) {
+    if(m_bPerformFiltering && m_filterKernel.isIir()) {
+        // IIR filters are causal, they only need a lead-in which covers their impulse response
+        iFilterDelay = qMin(int(m_filterKernel.getCoefficients().cols()), qMax(start - absoluteFirstSample(), 0));
+        start -= iFilterDelay;
+    } else if(m_bPerformFiltering) {
         iFilterDelay = m_filterKernel.getFilterOrder()/2;
         end += m_filterKernel.getFilterOrder()/2;
 
@@ -971,11 +1008,18 @@ void FiffRawViewModel::reloadAllData()
     // Filter data if activated, otherwise set to raw data
     if(m_bPerformFiltering) {
         bool bFilterSuccess = false;
-        if(bBeforeStartReached) {
+        int iFilteredOffset = 0;
+        if(m_filterKernel.isIir()) {
+            // The causal IIR output is not delayed
+            bFilterSuccess = filterDataBlock(matData, true);
+            iFilteredOffset = iFilterDelay;
+        } else if(bBeforeStartReached) {
             iFilterDelay = m_filterKernel.getFilterOrder()/4;
             bFilterSuccess = filterDataBlock(matData, true, true);
+            iFilteredOffset = 2*iFilterDelay;
         } else {
             bFilterSuccess = filterDataBlock(matData, true);
+            iFilteredOffset = 2*iFilterDelay;
         }
 
         if(!bFilterSuccess) {
@@ -984,8 +1028,8 @@ void FiffRawViewModel::reloadAllData()
         }
 
         for(int i = 0; i < m_iTotalBlockCount; ++i) {
-            m_lFilteredData.push_back(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, (i*m_iSamplesPerBlock)+(2*iFilterDelay), matData.rows(), m_iSamplesPerBlock),
-                                                                                                   matTimes.block(0, (i*m_iSamplesPerBlock)+(2*iFilterDelay), matTimes.rows(), m_iSamplesPerBlock))));
+            m_lFilteredData.push_back(QSharedPointer<QPair<MatrixXd, MatrixXd> >::create(qMakePair(matData.block(0, (i*m_iSamplesPerBlock)+iFilteredOffset, matData.rows(), m_iSamplesPerBlock),
+                                                                                                   matTimes.block(0, (i*m_iSamplesPerBlock)+iFilteredOffset, matTimes.rows(), m_iSamplesPerBlock))));
         }
     } else {
         m_lFilteredData = m_lData;
@@ -43,6 +43,8 @@
 #include "info.h"
 #include "analyzecore.h"
 
+#include <fiff/fiff_stream.h>
+
 //=============================================================================================================
 // Qt INCLUDES
 //=============================================================================================================
@@ -101,6 +103,11 @@ int main(int argc, char *argv[])
     QCoreApplication::setApplicationName(CInfo::AppNameShort());
     QCoreApplication::setOrganizationDomain("www.mne-cpp.org");
 
+    #ifndef WASMBUILD
+        // Files are usually opened more than once, keep their tag directories in the user cache location
+        FIFFLIB::FiffStream::setDirCacheEnabled(true);
+    #endif
+
     QSurfaceFormat fmt;
     fmt.setSamples(4);
     QSurfaceFormat::setDefaultFormat(fmt);
@@ -44,6 +44,9 @@
 
 #include "mne_rt_server.h"
 
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_stream.h>
+
 #include <stdlib.h>
 
 //=============================================================================================================
@@ -159,6 +162,88 @@ void FiffStreamServer::comStopAll(Command p_command)
 
 //=============================================================================================================
 
+void FiffStreamServer::comStreamMode(Command p_command)
+{
+    qint32 t_id = -1;
+    QString t_sOutput("");
+    QString t_sAlias(p_command["id"].toString());
+    t_sOutput.append(parseToId(t_sAlias,t_id));
+
+    if(t_id != -1 && m_qClientList.contains(t_id))
+    {
+        qint32 t_iDecimation = p_command["decimation"].toInt();
+        qint32 t_iCompression = p_command["compression"].toInt();
+
+        // The channel indices refer to the measurement info, which the client has to request first
+        bool t_bChannelsValid = m_fiffInfo.nchan > 0;
+        Eigen::RowVectorXi t_vecChannels;
+        QString t_sChannels = p_command["channels"].toString();
+        if(t_bChannelsValid && t_sChannels.compare("all", Qt::CaseInsensitive) != 0)
+        {
+            QStringList t_qListChannels = t_sChannels.split(",", QString::SkipEmptyParts);
+            t_vecChannels.resize(t_qListChannels.size());
+            for(qint32 i = 0; i < t_qListChannels.size(); ++i)
+            {
+                bool t_isInt;
+                t_vecChannels[i] = t_qListChannels[i].trimmed().toInt(&t_isInt);
+                if(!t_isInt || t_vecChannels[i] < 0 || t_vecChannels[i] >= m_fiffInfo.nchan)
+                    t_bChannelsValid = false;
+            }
+        }
+
+        RtStreamCodec::SPtr t_pCodec(new RtStreamCodec(t_iDecimation, t_vecChannels, t_iCompression));
+
+        // Current mode of the client, a mode without encoder is the full rate raw stream
+        QString t_sLastMode = m_qClientList[t_id]->getStreamMode();
+        RtStreamCodec::SPtr t_pLastCodec = m_qStreamCodecs.value(t_sLastMode, RtStreamCodec::SPtr(new RtStreamCodec()));
+        bool t_bLayoutChanged = !t_pCodec->hasSameLayout(*t_pLastCodec);
+
+        if(m_fiffInfo.nchan <= 0)
+        {
+            t_sOutput.append("\twarning: request the measurement info before setting the stream mode\r\n\n");
+        }
+        else if(!t_bChannelsValid)
+        {
+            QString str = QString("\twarning: channels has to be all or a list of channel indices within [0, %1]\r\n\n").arg(m_fiffInfo.nchan - 1);
+            t_sOutput.append(str);
+        }
+        else if(t_iDecimation < 1 || t_iCompression < -1 || t_iCompression > 24)
+        {
+            t_sOutput.append("\twarning: decimation has to be >= 1 and compression within [-1, 24]\r\n\n");
+        }
+        else if(t_bLayoutChanged && m_qClientList[t_id]->isSendingRawBuffer())
+        {
+            // The client reads the number of channels and the sampling frequency from the measurement info only
+            t_sOutput.append("\twarning: channels and decimation can only be changed while the measurement of the client is stopped\r\n\n");
+        }
+        else
+        {
+            QString t_sMode;
+            if(!t_pCodec->isDefault())
+            {
+                t_sMode = t_pCodec->mode();
+                if(!m_qStreamCodecs.contains(t_sMode))
+                    m_qStreamCodecs.insert(t_sMode, t_pCodec);
+            }
+            m_qClientList[t_id]->setStreamMode(t_sMode);
+
+            QString str = QString("\tFiffStreamClient (ID: %1) stream mode: %2\r\n").arg(t_id).arg(t_sMode.isEmpty() ? QString("raw") : t_sMode);
+            t_sOutput.append(str);
+
+            // Send the measurement info which describes the reduced raw buffers
+            if(t_bLayoutChanged)
+            {
+                emit remitMeasInfo(t_id, t_pCodec->reduceInfo(m_fiffInfo));
+                t_sOutput.append(QString("\tsend measurement info to FiffStreamClient (ID: %1)\r\n").arg(t_id));
+            }
+            t_sOutput.append("\n");
+        }
+    }
+    qobject_cast<MNERTServer*>(this->parent())->getCommandManager()["streammode"].reply(t_sOutput);
+}
+
+//=============================================================================================================
+
 void FiffStreamServer::connectCommands()
 {
     //Connect slots
@@ -169,6 +254,7 @@ void FiffStreamServer::connectCommands()
     QObject::connect(&t_pMNERTServer->getCommandManager()["start"], &Command::executed, this, &FiffStreamServer::comStart);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop"], &Command::executed, this, &FiffStreamServer::comStop);
     QObject::connect(&t_pMNERTServer->getCommandManager()["stop-all"], &Command::executed, this, &FiffStreamServer::comStopAll);
+    QObject::connect(&t_pMNERTServer->getCommandManager()["streammode"], &Command::executed, this, &FiffStreamServer::comStreamMode);
 
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("clist"), this, &FiffStreamServer::comClist);
 //    t_pMNERTServer->getCommandManager().connectSlot(QString("measinfo"), this, &FiffStreamServer::comMeasinfo);
@@ -348,14 +434,54 @@ QByteArray FiffStreamServer::parseToId(QString& p_sRawId, qint32& p_iParsedId)
 
 void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 {
-    emit remitMeasInfo(ID, p_fiffInfo);
+    m_fiffInfo = p_fiffInfo;
+
+    // Clients in a reduced stream mode get the measurement info of their channels and sampling frequency
+    QString t_sMode = m_qClientList.contains(ID) ? m_qClientList[ID]->getStreamMode() : QString();
+    if(m_qStreamCodecs.contains(t_sMode))
+        emit remitMeasInfo(ID, m_qStreamCodecs[t_sMode]->reduceInfo(p_fiffInfo));
+    else
+        emit remitMeasInfo(ID, p_fiffInfo);
 }
 
 //=============================================================================================================
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    // Encode the tag once per stream mode in use, all clients of a mode queue the same implicitly shared block
+    QMap<QString, QByteArray> t_mapRawBuffers;
+
+    QMap<qint32, FiffStreamThread*>::const_iterator i;
+    for (i = m_qClientList.constBegin(); i != m_qClientList.constEnd(); ++i)
+    {
+        QString t_sMode = i.value()->getStreamMode();
+        if(t_mapRawBuffers.contains(t_sMode))
+            continue;
+
+        if(t_sMode.isEmpty() || !m_qStreamCodecs.contains(t_sMode))
+        {
+            QByteArray t_blockRawBuffer;
+            FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+            t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), m_pMatRawData->rows()*m_pMatRawData->cols());
+            t_mapRawBuffers.insert(t_sMode, t_blockRawBuffer);
+        }
+        else
+        {
+            t_mapRawBuffers.insert(t_sMode, m_qStreamCodecs[t_sMode]->encode(*m_pMatRawData));
+        }
+    }
+
+    // Drop the encoders of modes no client uses anymore
+    QMap<QString, RtStreamCodec::SPtr>::iterator itCodec = m_qStreamCodecs.begin();
+    while(itCodec != m_qStreamCodecs.end())
+    {
+        if(t_mapRawBuffers.contains(itCodec.key()))
+            ++itCodec;
+        else
+            itCodec = m_qStreamCodecs.erase(itCodec);
+    }
+
+    emit remitRawBuffer(t_mapRawBuffers);
 }
 
 //=============================================================================================================
@@ -43,11 +43,13 @@
 
 #include <fiff/fiff_info.h>
 #include <communication/rtCommand/commandmanager.h>
+#include <communication/rtClient/rtstreamcodec.h>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QMap>
 #include <QStringList>
 #include <QTcpServer>
 
@@ -117,7 +119,7 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitRawBuffer(const QMap<QString, QByteArray>& p_mapRawBuffers);
 
     void closeFiffStreamServer();
 
@@ -166,10 +168,23 @@ private:
      */
     void comStopAll(COMMUNICATIONLIB::Command p_command);
 
+    //=========================================================================================================
+    /**
+     * Sets the decimation, channel subset and compression of the raw buffers sent to a client. If channels or
+     * decimation change, the client is sent the measurement info of the reduced stream. This is refused while
+     * the measurement of the client is running.
+     *
+     * @param[in] p_command  The stream mode command.
+     */
+    void comStreamMode(COMMUNICATIONLIB::Command p_command);
+
     QByteArray parseToId(QString& p_sRawId, qint32& p_iParsedId);
 
     QMap<qint32, FiffStreamThread*> m_qClientList;
     qint32                          m_iNextClientId;
+
+    QMap<QString, COMMUNICATIONLIB::RtStreamCodec::SPtr> m_qStreamCodecs;   /**< Encoders of the stream modes in use, shared by all clients of a mode. */
+    FIFFLIB::FiffInfo                                    m_fiffInfo;        /**< Last forwarded measurement info, the channel indices of the stream modes refer to it. */
 };
 
 //=============================================================================================================
@@ -67,6 +67,12 @@ using namespace UTILSLIB;
 using namespace RTSERVER;
 using namespace FIFFLIB;
 
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define SOCKET_HIGH_WATER_MARK  4194304     /**< Bytes buffered in the socket after which no further blocks are moved out of the send queue. */
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -76,8 +82,10 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_iNumQueuedRawBuffers(0)
+, m_iMaxQueuedRawBuffers(40)
+, m_iNumDroppedRawBuffers(0)
 , m_bIsSendingRawBuffer(false)
-, m_bIsRunning(false)
 {
 }
 
@@ -90,7 +98,8 @@ FiffStreamThread::~FiffStreamThread()
     if(t_pFiffStreamServer)
         t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
 
-    m_bIsRunning = false;
+    QThread::requestInterruption();
+    QThread::quit();
     QThread::wait();
 }
 
@@ -102,10 +111,13 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockStart;
+        FiffStream t_FiffStreamOut(&t_blockStart, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        queueBlock(t_blockStart);
+
+        m_qMutex.lock();
         m_bIsSendingRawBuffer = true;
         m_qMutex.unlock();
     }
@@ -121,10 +133,13 @@ void FiffStreamThread::stopMeas(qint32 ID)
         qDebug() << "stop raw buffer sending.";
 
         m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
         m_bIsSendingRawBuffer = false;
         m_qMutex.unlock();
+
+        QByteArray t_blockEnd;
+        FiffStream t_FiffStreamOut(&t_blockEnd, QIODevice::WriteOnly);
+        t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
+        queueBlock(t_blockEnd);
     }
 }
 
@@ -167,19 +182,18 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //=============================================================================================================
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::sendRawBuffer(const QMap<QString, QByteArray>& p_mapRawBuffers)
 {
     if(m_bIsSendingRawBuffer)
     {
 //        qDebug() << "Send RawBuffer to client";
 
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
-
-        m_qMutex.unlock();
-
+        // A decimating mode may not have completed an output sample yet
+        QByteArray t_blockRawBuffer = p_mapRawBuffers.value(m_sStreamMode);
+        if(!t_blockRawBuffer.isEmpty())
+        {
+            queueBlock(t_blockRawBuffer, true);
+        }
     }
 //    else
 //    {
@@ -212,9 +226,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 {
     if(ID == m_iDataClientId)
     {
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockMeasInfo;
+        FiffStream t_FiffStreamOut(&t_blockMeasInfo, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
 //        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
@@ -225,7 +238,7 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 //FiffStream::start_writing_raw
 
         p_fiffInfo.writeToStream(&t_FiffStreamOut);
-        m_qMutex.unlock();
+        queueBlock(t_blockMeasInfo);
 
 //        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
     }
@@ -235,9 +248,116 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 void FiffStreamThread::writeClientId()
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    QByteArray t_blockClientId;
+    FiffStream t_FiffStreamOut(&t_blockClientId, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+    queueBlock(t_blockClientId);
+}
+
+//=============================================================================================================
+
+void FiffStreamThread::queueBlock(const QByteArray& p_blockData, bool p_bIsRawBuffer)
+{
+    SendBlock t_sendBlock;
+    t_sendBlock.data = p_blockData;
+    t_sendBlock.bIsRawBuffer = p_bIsRawBuffer;
+
+    m_qMutex.lock();
+
+    bool t_bWasEmpty = m_qSendQueue.isEmpty();
+    m_qSendQueue.enqueue(t_sendBlock);
+
+    if(p_bIsRawBuffer && ++m_iNumQueuedRawBuffers > m_iMaxQueuedRawBuffers)
+    {
+        // The client does not keep up - drop the oldest raw buffer it has not received yet
+        for(QQueue<SendBlock>::iterator it = m_qSendQueue.begin(); it != m_qSendQueue.end(); ++it)
+        {
+            if(it->bIsRawBuffer)
+            {
+                m_qSendQueue.erase(it);
+                --m_iNumQueuedRawBuffers;
+                break;
+            }
+        }
+
+        if(m_iNumDroppedRawBuffers++ % 100 == 0)
+        {
+            printf("FiffStreamClient (ID %d): client is too slow, %lld raw buffer(s) dropped\r\n\n", m_iDataClientId, m_iNumDroppedRawBuffers);
+        }
+    }
+
+    m_qMutex.unlock();
+
+    if(t_bWasEmpty)
+    {
+        emit blockQueued();
+    }
+}
+
+//=============================================================================================================
+
+void FiffStreamThread::writeQueuedBlocks(QTcpSocket& p_qTcpSocket)
+{
+    QList<QByteArray> t_listBlocks;
+
+    m_qMutex.lock();
+    qint64 t_iBytesPending = p_qTcpSocket.bytesToWrite();
+    while(!m_qSendQueue.isEmpty() && t_iBytesPending < SOCKET_HIGH_WATER_MARK)
+    {
+        SendBlock t_sendBlock = m_qSendQueue.dequeue();
+        if(t_sendBlock.bIsRawBuffer)
+        {
+            --m_iNumQueuedRawBuffers;
+        }
+        t_iBytesPending += t_sendBlock.data.size();
+        t_listBlocks.append(t_sendBlock.data);
+    }
+    m_qMutex.unlock();
+
+    // The socket sends asynchronously, bytesWritten calls back in here once it drained
+    for(int i = 0; i < t_listBlocks.size(); ++i)
+    {
+        p_qTcpSocket.write(t_listBlocks[i]);
+    }
+}
+
+//=============================================================================================================
+
+void FiffStreamThread::readCommands(FiffStream& p_FiffStreamIn, QTcpSocket& p_qTcpSocket)
+{
+    while(true)
+    {
+        //
+        // Read the tag header as soon as it is complete
+        //
+        if(!m_pPendingTag)
+        {
+            if(p_qTcpSocket.bytesAvailable() < (int)sizeof(qint32)*4)
+            {
+                return;
+            }
+            p_FiffStreamIn.read_tag_info(m_pPendingTag, false);
+        }
+
+        //
+        // Read the tag data once it arrived completely
+        //
+        if(p_qTcpSocket.bytesAvailable() < m_pPendingTag->size())
+        {
+            return;
+        }
+        p_FiffStreamIn.read_tag_data(m_pPendingTag);
+
+        //
+        // Parse the tag
+        //
+        if(m_pPendingTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(m_pPendingTag);
+        }
+        m_pPendingTag.clear();
+    }
 }
 
 //=============================================================================================================
@@ -280,8 +400,6 @@ void FiffStreamThread::writeClientId()
 
 void FiffStreamThread::run()
 {
-    m_bIsRunning = true;
-
     FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
 
     connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
@@ -308,61 +426,29 @@ void FiffStreamThread::run()
 
     FiffStream t_FiffStreamIn(&t_qTcpSocket);
 
-//    int i = 0;
-    while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
+    //
+    // Serve the client from this thread's event loop: the socket lives here, so the slots below run here
+    //
+    connect(&t_qTcpSocket, &QTcpSocket::readyRead, &t_qTcpSocket, [&]() {
+        readCommands(t_FiffStreamIn, t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::bytesWritten, &t_qTcpSocket, [&]() {
+        writeQueuedBlocks(t_qTcpSocket);
+    });
+    connect(this, &FiffStreamThread::blockQueued, &t_qTcpSocket, [&]() {
+        writeQueuedBlocks(t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::disconnected, &t_qTcpSocket, [this]() {
+        QThread::quit();
+    });
+
+    // Blocks may have been queued before the connections above were made
+    writeQueuedBlocks(t_qTcpSocket);
+    readCommands(t_FiffStreamIn, t_qTcpSocket);
+
+    if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && !isInterruptionRequested())
     {
-        //
-        // Write available data
-        //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
-        {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
-            {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
-            }
-        }
-        m_qMutex.unlock();
-
-        //
-        // Read: Wait 10ms for incomming tag header, read and continue
-        //
-        t_qTcpSocket.waitForReadyRead(10);
-
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-        {
-//            qDebug() << "goes to read bytes " ;
-            FiffTag::SPtr t_pTag;
-            t_FiffStreamIn.read_tag_info(t_pTag, false);
-
-            //
-            // wait until tag size data are available and read the data
-            //
-            while (t_qTcpSocket.bytesAvailable() < t_pTag->size())
-            {
-                t_qTcpSocket.waitForReadyRead(10);
-            }
-            t_FiffStreamIn.read_tag_data(t_pTag);
-
-            //
-            // Parse the tag
-            //
-            if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-            {
-                parseCommand(t_pTag);
-            }
-        }
+        exec();
     }
 
     t_qTcpSocket.disconnectFromHost();
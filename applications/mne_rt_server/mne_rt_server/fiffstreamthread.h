@@ -44,6 +44,7 @@
 
 #include <fiff/fiff_stream.h>
 #include <fiff/fiff_info.h>
+#include <fiff/fiff_tag.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -51,7 +52,9 @@
 
 #include <QThread>
 #include <QTcpSocket>
+#include <QMap>
 #include <QMutex>
+#include <QQueue>
 #include <QSharedPointer>
 
 //=============================================================================================================
@@ -80,6 +83,30 @@ public:
 
     inline QString getAlias();
 
+    //=========================================================================================================
+    /**
+     * Returns the stream mode of the client, empty for full rate raw buffers.
+     *
+     * @return the mode description as given by COMMUNICATIONLIB::RtStreamCodec::mode.
+     */
+    inline QString getStreamMode();
+
+    //=========================================================================================================
+    /**
+     * Sets the stream mode of the client.
+     *
+     * @param[in] p_sStreamMode  The mode description, empty for full rate raw buffers.
+     */
+    inline void setStreamMode(const QString& p_sStreamMode);
+
+    //=========================================================================================================
+    /**
+     * Returns whether the measurement of the client was started, i.e., whether raw buffers are sent.
+     *
+     * @return true if raw buffers are sent.
+     */
+    inline bool isSendingRawBuffer();
+
 //    void deactivateRawBufferSending();
 
     void parseCommand(QSharedPointer<FIFFLIB::FiffTag> p_pTag);
@@ -91,18 +118,38 @@ public:
 signals:
     void error(QTcpSocket::SocketError socketError);
 
+    //=========================================================================================================
+    /**
+     * Emitted when a block was queued to an empty send queue. Wakes the socket event loop of this thread.
+     */
+    void blockQueued();
+
 private:
+    //=========================================================================================================
+    /**
+     * A block of encoded FIFF tags waiting to be written to the client socket.
+     */
+    struct SendBlock {
+        QByteArray  data;           /**< The encoded tags. Raw buffer blocks are shared among all clients. */
+        bool        bIsRawBuffer;   /**< Whether the block holds a raw buffer which may be dropped for a slow client. */
+    };
+
     qint32 m_iDataClientId;
     QString m_sDataClientAlias;
 
     int m_iSocketDescriptor;
 
     QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    QQueue<SendBlock> m_qSendQueue;     /**< Blocks waiting to be written to the socket. */
+    int m_iNumQueuedRawBuffers;         /**< Number of raw buffer blocks in the send queue. */
+    int m_iMaxQueuedRawBuffers;         /**< Raw buffer backlog after which the oldest queued raw buffer is dropped. */
+    qint64 m_iNumDroppedRawBuffers;     /**< Number of raw buffers dropped because the client did not keep up. */
 
     bool m_bIsSendingRawBuffer;
 
-    bool m_bIsRunning;
+    QString m_sStreamMode;              /**< Stream mode of the client, empty for full rate raw buffers. */
+
+    FIFFLIB::FiffTag::SPtr m_pPendingTag;   /**< Command tag whose header was read but whose data is still incomplete. */
 
     void startMeas(qint32 ID);
 
@@ -110,7 +157,41 @@ private:
 
     void sendMeasurementInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    //=========================================================================================================
+    /**
+     * Queues the encoded raw buffer tag of the client's stream mode. The blocks are shared with all other clients
+     * in the same mode and never re-encoded.
+     *
+     * @param[in] p_mapRawBuffers    The encoded raw buffer tags by stream mode.
+     */
+    void sendRawBuffer(const QMap<QString, QByteArray>& p_mapRawBuffers);
+
+    //=========================================================================================================
+    /**
+     * Appends a block to the send queue. If the client lags behind by more than m_iMaxQueuedRawBuffers raw
+     * buffers, the oldest queued raw buffer is dropped. Control blocks are never dropped.
+     *
+     * @param[in] p_blockData        The encoded tags.
+     * @param[in] p_bIsRawBuffer     Whether the block holds a raw buffer.
+     */
+    void queueBlock(const QByteArray& p_blockData, bool p_bIsRawBuffer = false);
+
+    //=========================================================================================================
+    /**
+     * Moves queued blocks to the socket until the socket write buffer reaches its high water mark.
+     *
+     * @param[in] p_qTcpSocket   The client socket.
+     */
+    void writeQueuedBlocks(QTcpSocket& p_qTcpSocket);
+
+    //=========================================================================================================
+    /**
+     * Reads and parses all complete command tags available on the socket.
+     *
+     * @param[in] p_FiffStreamIn     The stream reading from the client socket.
+     * @param[in] p_qTcpSocket       The client socket.
+     */
+    void readCommands(FIFFLIB::FiffStream& p_FiffStreamIn, QTcpSocket& p_qTcpSocket);
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -124,6 +205,21 @@ inline QString FiffStreamThread::getAlias()
 {
     return m_sDataClientAlias;
 }
+
+inline QString FiffStreamThread::getStreamMode()
+{
+    return m_sStreamMode;
+}
+
+inline void FiffStreamThread::setStreamMode(const QString& p_sStreamMode)
+{
+    m_sStreamMode = p_sStreamMode;
+}
+
+inline bool FiffStreamThread::isSendingRawBuffer()
+{
+    return m_bIsSendingRawBuffer;
+}
 } // NAMESPACE
 
 #endif //FIFFSTREAMTHREAD_H
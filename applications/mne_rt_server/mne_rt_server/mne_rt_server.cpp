@@ -354,6 +354,27 @@ void MNERTServer::init()
             "       \"stop-all\": {"
             "           \"description\": \"Stops the whole acquisition process.\","
             "           \"parameters\": {}"
+            "        },"
+            "       \"streammode\": {"
+            "           \"description\": \"Sets the raw buffers sent to the specified FiffStreamClient to a decimated, channel subset and/or compressed stream. Requires the measurement info to be requested first. If channels or decimation change, the reduced measurement info is sent to the client, which is refused while its measurement is running.\","
+            "           \"parameters\": {"
+            "               \"channels\": {"
+            "                   \"description\": \"Comma separated channel indices or all\","
+            "                   \"type\": \"QString\" "
+            "               },"
+            "               \"compression\": {"
+            "                   \"description\": \"-1 none, 0 lossless, 2-24 near lossless quantisation bits\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"decimation\": {"
+            "                   \"description\": \"Number of samples averaged into one\","
+            "                   \"type\": \"int\" "
+            "               },"
+            "               \"id\": {"
+            "                   \"description\": \"ID/Alias\","
+            "                   \"type\": \"QString\" "
+            "               }"
+            "           }"
             "        }"
             "    }"
             "}";
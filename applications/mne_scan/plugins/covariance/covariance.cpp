@@ -81,7 +81,7 @@ using namespace Eigen;
 
 Covariance::Covariance()
 : m_iEstimationSamples(2000)
-, m_pCircularBuffer(CircularBuffer_Matrix_double::SPtr::create(40))
+, m_pCircularBuffer(MatrixRingBuffer_double::SPtr::create(40))
 {
 }
 
@@ -259,6 +259,10 @@ void Covariance::run()
     m_mutex.unlock();
     RTPROCESSINGLIB::RtCov rtCov(m_pFiffInfo);
 
+    // Slide the estimation window and refresh the covariance every second
+    rtCov.setWindowMode(RtCov::Sliding);
+    rtCov.setUpdateInterval(qRound(m_pFiffInfo->sfreq));
+
     // Start processing data
     while(!isInterruptionRequested()) {
         // Get the current data
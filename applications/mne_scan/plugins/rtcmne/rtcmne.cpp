@@ -93,7 +93,7 @@ using namespace Eigen;
 //=============================================================================================================
 
 RtcMne::RtcMne()
-: m_pCircularMatrixBuffer(CircularBuffer_Matrix_double::SPtr(new CircularBuffer_Matrix_double(40)))
+: m_pCircularMatrixBuffer(MatrixRingBuffer_double::SPtr(new MatrixRingBuffer_double(40)))
 , m_pCircularEvokedBuffer(CircularBuffer<FIFFLIB::FiffEvoked>::SPtr::create(40))
 , m_bEvokedInput(false)
 , m_bRawInput(false)
@@ -607,6 +607,9 @@ void RtcMne::run()
             m_bUpdateMinimumNorm = false;
             m_qMutex.unlock();
 
+            // The factorized kernel is applied as two thin products, which is cheaper for rank reduced data
+            pMinimumNorm->setFactorizedKernel(true);
+
             // Set up the inverse according to the parameters.
             // Use 1 nave here because in case of evoked data as input the minimum norm will always be updated when the source estimate is calculated (see run method).
             pMinimumNorm->doInverseSetup(1,true);
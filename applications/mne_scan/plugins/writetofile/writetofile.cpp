@@ -43,11 +43,14 @@
 #include <disp/viewers/projectsettingsview.h>
 #include <scMeas/realtimemultisamplearray.h>
 #include <fiff/fiff_stream.h>
+#include <fiff/fiff_raw_writer.h>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -288,8 +291,10 @@ void WriteToFile::run()
                         this->splitRecordingFile();
                     }
 
-                    if(m_pOutfid) {
-                        m_pOutfid->write_raw_buffer(matData);
+                    // Never wait for the disk here. A full writer queue drops the buffer, the writer records the
+                    // dropped samples with a FIFF_DATA_SKIP tag and they are reported on stop.
+                    if(m_pRawWriter) {
+                        m_pRawWriter->write_raw_buffer(matData, 0);
                     }
                 } else {
                     size = 0;
@@ -338,7 +343,14 @@ void WriteToFile::toggleRecordingFile()
     //Setup writing to file
     if(m_bWriteToFile) {
         m_mutex.lock();
-        m_pOutfid->finish_writing_raw();
+        finishRecordingFile(m_pRawWriter, m_pOutfid, m_pFileOut);
+        m_pRawWriter.reset();
+        m_pOutfid.reset();
+        m_pFileOut.reset();
+
+        //Wait for the files of earlier splits which are still written in the background
+        m_futureSynchronizer.waitForFinished();
+        m_futureSynchronizer.clearFutures();
         m_mutex.unlock();
 
         m_bWriteToFile = false;
@@ -372,8 +384,7 @@ void WriteToFile::toggleRecordingFile()
         }
 
         //Initiate the stream for writing to the fif file
-        m_qFileOut.setFileName(m_sRecordFileName);
-        if(m_qFileOut.exists()) {
+        if(QFile::exists(m_sRecordFileName)) {
             QMessageBox msgBox;
             msgBox.setText("The file you want to write already exists.");
             msgBox.setInformativeText("Do you want to overwrite this file?");
@@ -393,11 +404,14 @@ void WriteToFile::toggleRecordingFile()
         //Start/Prepare writing process. Actual writing is done in run() method.
         m_mutex.lock();
         RowVectorXd cals;
-        m_pOutfid = FiffStream::start_writing_raw(m_qFileOut,
+        m_pFileOut = QSharedPointer<QFile>::create(m_sRecordFileName);
+        m_pOutfid = FiffStream::start_writing_raw(*m_pFileOut,
                                                   *m_pFiffInfo,
                                                   cals);
         fiff_int_t first = 0;
         m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+        m_pRawWriter = FiffRawWriter::SPtr(new FiffRawWriter(m_pOutfid));
+        m_pRawWriter->start();
         m_mutex.unlock();
 
         m_bWriteToFile = true;
@@ -422,31 +436,75 @@ void WriteToFile::splitRecordingFile()
     QString nextFileName = m_sRecordFileName.remove("_raw.fif");
     nextFileName += QString("-%1_raw.fif").arg(m_iSplitCount);
 
-    //Write the link to the next file
-    qint32 data;
-    m_pOutfid->start_block(FIFFB_REF);
-    data = FIFFV_ROLE_NEXT_FILE;
-    m_pOutfid->write_int(FIFF_REF_ROLE,&data);
-    m_pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
-    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
-    data = m_iSplitCount - 1;
-    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
-    m_pOutfid->end_block(FIFFB_REF);
-
-    //finish file
-    m_pOutfid->finish_writing_raw();
+    //Write the pending buffers, the link to the next file and finish the file in the background, so the
+    //acquisition does not wait for the disk
+    m_futureSynchronizer.addFuture(QtConcurrent::run(&WriteToFile::finishRecordingFile,
+                                                     m_pRawWriter,
+                                                     m_pOutfid,
+                                                     m_pFileOut,
+                                                     nextFileName,
+                                                     m_iSplitCount - 1));
 
     //start next file
-    m_qFileOut.setFileName(nextFileName);
+    m_pFileOut = QSharedPointer<QFile>::create(nextFileName);
     RowVectorXd cals;
     MatrixXi sel;
-    m_pOutfid = FiffStream::start_writing_raw(m_qFileOut,
+    m_pOutfid = FiffStream::start_writing_raw(*m_pFileOut,
                                               *m_pFiffInfo,
                                               cals,
                                               sel,
                                               false);
     fiff_int_t first = 0;
     m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
+    m_pRawWriter = FiffRawWriter::SPtr(new FiffRawWriter(m_pOutfid));
+    m_pRawWriter->start();
+}
+
+//=============================================================================================================
+
+void WriteToFile::finishRecordingFile(QSharedPointer<FiffRawWriter> pRawWriter,
+                                      QSharedPointer<FiffStream> pOutfid,
+                                      QSharedPointer<QFile> pFileOut,
+                                      const QString& sNextFileName,
+                                      qint32 iFileNum)
+{
+    Q_UNUSED(pFileOut)
+
+    if(!pOutfid) {
+        return;
+    }
+
+    //Write all pending buffers before the link to the next file
+    if(pRawWriter) {
+        pRawWriter->stop();
+
+        FiffRawWriter::Statistics stats = pRawWriter->getStatistics();
+        qInfo() << "[WriteToFile::finishRecordingFile] Wrote" << stats.iNumWrittenBuffers << "buffers in" << stats.iNumBatches
+                << "batches, max queue size" << stats.iMaxQueueSize;
+        if(stats.iNumDroppedBuffers > 0) {
+            qWarning() << "[WriteToFile::finishRecordingFile] Dropped" << stats.iNumDroppedBuffers << "buffers because the disk could not keep up."
+                       << "They were skipped with" << stats.iNumSkipTags << "FIFF_DATA_SKIP tags.";
+        }
+        if(stats.iNumFailedBuffers > 0) {
+            qWarning() << "[WriteToFile::finishRecordingFile] Failed to write" << stats.iNumFailedBuffers << "buffers to the device.";
+        }
+    }
+
+    //Write the link to the next file
+    if(!sNextFileName.isEmpty()) {
+        qint32 data;
+        pOutfid->start_block(FIFFB_REF);
+        data = FIFFV_ROLE_NEXT_FILE;
+        pOutfid->write_int(FIFF_REF_ROLE,&data);
+        pOutfid->write_string(FIFF_REF_FILE_NAME, sNextFileName);
+        pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
+        data = iFileNum;
+        pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
+        pOutfid->end_block(FIFFB_REF);
+    }
+
+    //finish file
+    pOutfid->finish_writing_raw();
 }
 
 //=============================================================================================================
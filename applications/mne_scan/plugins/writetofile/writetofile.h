@@ -51,6 +51,7 @@
 #include <QPointer>
 #include <QAction>
 #include <QFile>
+#include <QFutureSynchronizer>
 #include <QTime>
 
 //=============================================================================================================
@@ -66,6 +67,7 @@
 namespace FIFFLIB{
     class FiffInfo;
     class FiffStream;
+    class FiffRawWriter;
 }
 
 namespace SCMEASLIB{
@@ -187,6 +189,24 @@ private:
      */
     void changeRecordingButton();
 
+    //=========================================================================================================
+    /**
+     * Writes all pending raw buffers of a file, stops its background writer and reports the writer statistics.
+     * Then writes the link to the next file, if any, and finishes the file. Runs in the background for file
+     * splits, hence it only works on its arguments.
+     *
+     * @param[in] pRawWriter     The writer of the file.
+     * @param[in] pOutfid        The stream of the file.
+     * @param[in] pFileOut       The file, kept open until the stream is finished.
+     * @param[in] sNextFileName  The name of the next file of a split recording, empty for the last file.
+     * @param[in] iFileNum       The number of the file in a split recording.
+     */
+    static void finishRecordingFile(QSharedPointer<FIFFLIB::FiffRawWriter> pRawWriter,
+                                    QSharedPointer<FIFFLIB::FiffStream> pOutfid,
+                                    QSharedPointer<QFile> pFileOut,
+                                    const QString& sNextFileName = QString(),
+                                    qint32 iFileNum = 0);
+
     bool                                    m_bWriteToFile;                 /**< Flag for for writing the received samples to a file. Defined by the user via the GUI.*/
     bool                                    m_bUseRecordTimer;              /**< Flag whether to use data recording timer.*/
 
@@ -198,12 +218,14 @@ private:
 
     QSharedPointer<FIFFLIB::FiffInfo>       m_pFiffInfo;                    /**< Fiff measurement info.*/
     QSharedPointer<FIFFLIB::FiffStream>     m_pOutfid;                      /**< FiffStream to write to.*/
+    QSharedPointer<FIFFLIB::FiffRawWriter>  m_pRawWriter;                   /**< Writes the raw buffers to m_pOutfid in the background.*/
 
     QSharedPointer<QTimer>                  m_pUpdateTimeInfoTimer;         /**< timer to control remaining time. */
     QSharedPointer<QTimer>                  m_pBlinkingRecordButtonTimer;   /**< timer to control blinking recording button. */
     QSharedPointer<QTimer>                  m_pRecordTimer;                 /**< timer to control recording time. */
 
-    QFile                                   m_qFileOut;                     /**< QFile for writing to fif file.*/
+    QSharedPointer<QFile>                   m_pFileOut;                     /**< QFile for writing to fif file.*/
+    QFutureSynchronizer<void>               m_futureSynchronizer;           /**< Finishes the files of earlier splits in the background.*/
     QString                                 m_sRecordFileName;              /**< Current record file. */
     QTime                                   m_recordingStartedTime;         /**< The time when the recording started.*/
 
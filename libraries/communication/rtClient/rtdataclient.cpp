@@ -39,7 +39,9 @@
 //=============================================================================================================
 
 #include "rtdataclient.h"
+#include "rtstreamcodec.h"
 #include <fiff/fiff_file.h>
+#include <fiff/fiff_constants.h>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -385,6 +387,12 @@ void RtDataClient::readRawBuffer(qint32 p_nChannels,
         qint32 nSamples = (t_pTag->size()/4)/p_nChannels;
         data = MatrixXf(Map< MatrixXf >(t_pTag->toFloat(), p_nChannels, nSamples));
     }
+    else if(kind == FIFF_MNE_RT_STREAM_BUFFER)
+    {
+        // Reduced stream mode - the tag carries its own dimensions
+        if(RtStreamCodec::decode(*t_pTag, data))
+            kind = FIFF_DATA_BUFFER;
+    }
 //        else
 //            data = tag.data;
 }
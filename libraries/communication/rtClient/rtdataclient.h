@@ -112,6 +112,10 @@ public:
     /**
      * Reads fiff measurement information of a data the connection
      *
+     * Buffers of a reduced stream mode (see the streammode command) are decoded and reported as FIFF_DATA_BUFFER.
+     * Their channels and sampling frequency are those of the reduced measurement info, which the server sends when
+     * the stream mode is set and which has to be read with readInfo() before the measurement is started.
+     *
      * @param[in] p_nChannels    Number of channels to reshape the received data
      * @param[out] data          The read data - ToDo change this to raw buffer data object
      * @param[out] kind          Data kind
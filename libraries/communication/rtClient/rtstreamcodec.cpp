@@ -0,0 +1,504 @@
+//=============================================================================================================
+/**
+ * @file     rtstreamcodec.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     RtStreamCodec class definition.
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtstreamcodec.h"
+
+#include <fiff/fiff_constants.h>
+#include <fiff/fiff_file.h>
+
+#include <cmath>
+#include <cstring>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDataStream>
+#include <QStringList>
+#include <QVector>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace COMMUNICATIONLIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define RICE_ESCAPE     16      /**< Unary quotient length after which a residual is stored verbatim. */
+
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+namespace {
+
+/**
+ * Writes MSB first bit fields to a byte array.
+ */
+struct BitWriter
+{
+    QByteArray* pData;
+    quint64     acc;
+    int         nBits;
+
+    void put(quint32 value, int n)
+    {
+        if(n == 0) {
+            return;
+        }
+        acc = (acc << n) | (n < 32 ? (value & ((1u << n) - 1u)) : value);
+        nBits += n;
+        while(nBits >= 8) {
+            nBits -= 8;
+            pData->append(static_cast<char>((acc >> nBits) & 0xFF));
+        }
+    }
+
+    void flush()
+    {
+        if(nBits > 0) {
+            pData->append(static_cast<char>((acc << (8 - nBits)) & 0xFF));
+            nBits = 0;
+        }
+    }
+};
+
+/**
+ * Reads MSB first bit fields from a byte buffer.
+ */
+struct BitReader
+{
+    const uchar*    pData;
+    int             iSize;
+    int             iPos;
+    quint64         acc;
+    int             nBits;
+
+    bool get(int n, quint32& value)
+    {
+        while(nBits < n) {
+            if(iPos >= iSize) {
+                return false;
+            }
+            acc = (acc << 8) | pData[iPos++];
+            nBits += 8;
+        }
+        nBits -= n;
+        value = n == 0 ? 0 : static_cast<quint32>((acc >> nBits) & (n < 32 ? ((1ull << n) - 1ull) : 0xFFFFFFFFull));
+        return true;
+    }
+};
+
+//=============================================================================================================
+
+inline quint32 floatToOrdered(float fValue)
+{
+    qint32 iBits;
+    std::memcpy(&iBits, &fValue, sizeof(iBits));
+    // Map sign-magnitude to two's complement so neighbouring floats have neighbouring codes
+    return static_cast<quint32>(iBits < 0 ? (iBits ^ 0x7FFFFFFF) : iBits);
+}
+
+//=============================================================================================================
+
+inline float orderedToFloat(quint32 uCode)
+{
+    qint32 iBits = static_cast<qint32>(uCode);
+    iBits = iBits < 0 ? (iBits ^ 0x7FFFFFFF) : iBits;
+    float fValue;
+    std::memcpy(&fValue, &iBits, sizeof(fValue));
+    return fValue;
+}
+
+//=============================================================================================================
+
+inline quint32 zigzag(quint32 uDelta)
+{
+    qint32 iDelta = static_cast<qint32>(uDelta);
+    return (static_cast<quint32>(iDelta) << 1) ^ static_cast<quint32>(iDelta >> 31);
+}
+
+//=============================================================================================================
+
+inline quint32 unzigzag(quint32 uValue)
+{
+    return (uValue >> 1) ^ (0u - (uValue & 1u));
+}
+
+//=============================================================================================================
+
+inline int riceParameter(const quint32* pResiduals, int iCount)
+{
+    double dMean = 0.0;
+    for(int i = 0; i < iCount; ++i) {
+        dMean += pResiduals[i];
+    }
+    dMean = iCount > 0 ? dMean / iCount : 0.0;
+
+    int k = 0;
+    while(k < 31 && std::ldexp(1.0, k + 1) <= dMean) {
+        ++k;
+    }
+    return k;
+}
+
+} // anonymous namespace
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtStreamCodec::RtStreamCodec(int iDecimation,
+                             const RowVectorXi& vecChannels,
+                             int iCompression)
+: m_iDecimation(qMax(1, iDecimation))
+, m_vecChannels(vecChannels)
+, m_iCompression(iCompression == 1 ? 2 : qBound(-1, iCompression, 24))
+, m_iBlockCount(0)
+{
+}
+
+//=============================================================================================================
+
+bool RtStreamCodec::isDefault() const
+{
+    return m_iDecimation == 1 && m_vecChannels.size() == 0 && m_iCompression == -1;
+}
+
+//=============================================================================================================
+
+QString RtStreamCodec::mode() const
+{
+    QStringList slChannels;
+    for(int i = 0; i < m_vecChannels.size(); ++i) {
+        slChannels << QString::number(m_vecChannels[i]);
+    }
+
+    return QString("decimation=%1 channels=%2 compression=%3").arg(m_iDecimation)
+                                                              .arg(slChannels.isEmpty() ? QString("all") : slChannels.join(","))
+                                                              .arg(m_iCompression);
+}
+
+//=============================================================================================================
+
+int RtStreamCodec::getDecimation() const
+{
+    return m_iDecimation;
+}
+
+//=============================================================================================================
+
+const RowVectorXi& RtStreamCodec::getChannels() const
+{
+    return m_vecChannels;
+}
+
+//=============================================================================================================
+
+bool RtStreamCodec::hasSameLayout(const RtStreamCodec& other) const
+{
+    return m_iDecimation == other.m_iDecimation
+           && m_vecChannels.size() == other.m_vecChannels.size()
+           && m_vecChannels == other.m_vecChannels;
+}
+
+//=============================================================================================================
+
+FiffInfo RtStreamCodec::reduceInfo(const FiffInfo& info) const
+{
+    FiffInfo infoReduced = info;
+
+    if(m_vecChannels.size() > 0) {
+        QVector<int> vecValid;
+        for(int i = 0; i < m_vecChannels.size(); ++i) {
+            if(m_vecChannels[i] >= 0 && m_vecChannels[i] < info.nchan) {
+                vecValid.append(m_vecChannels[i]);
+            }
+        }
+
+        RowVectorXi vecSel = Map<RowVectorXi>(vecValid.data(), vecValid.size());
+        if(vecSel.size() > 0) {
+            infoReduced = info.pick_info(vecSel);
+        } else {
+            infoReduced.chs.clear();
+            infoReduced.ch_names.clear();
+            infoReduced.nchan = 0;
+        }
+    }
+
+    // The block average is the only anti aliasing filter
+    infoReduced.sfreq = info.sfreq / m_iDecimation;
+    if(m_iDecimation > 1 && (infoReduced.lowpass <= 0.0f || infoReduced.lowpass > infoReduced.sfreq / 2.0f)) {
+        infoReduced.lowpass = infoReduced.sfreq / 2.0f;
+    }
+
+    return infoReduced;
+}
+
+//=============================================================================================================
+
+QByteArray RtStreamCodec::encode(const MatrixXf& matData)
+{
+    //
+    // Pick channels
+    //
+    MatrixXf matPicked;
+    if(m_vecChannels.size() > 0) {
+        int iNumValid = 0;
+        for(int i = 0; i < m_vecChannels.size(); ++i) {
+            if(m_vecChannels[i] >= 0 && m_vecChannels[i] < matData.rows()) {
+                ++iNumValid;
+            }
+        }
+        matPicked.resize(iNumValid, matData.cols());
+        for(int i = 0, r = 0; i < m_vecChannels.size(); ++i) {
+            if(m_vecChannels[i] >= 0 && m_vecChannels[i] < matData.rows()) {
+                matPicked.row(r++) = matData.row(m_vecChannels[i]);
+            }
+        }
+    }
+    const MatrixXf& matSel = m_vecChannels.size() > 0 ? matPicked : matData;
+
+    //
+    // Decimate by averaging blocks, incomplete blocks carry over to the next buffer
+    //
+    MatrixXf matDecimated;
+    if(m_iDecimation > 1) {
+        if(m_vecBlockSum.size() != matSel.rows()) {
+            m_vecBlockSum = VectorXf::Zero(matSel.rows());
+            m_iBlockCount = 0;
+        }
+
+        matDecimated.resize(matSel.rows(), (m_iBlockCount + matSel.cols()) / m_iDecimation);
+        for(int j = 0, iOut = 0; j < matSel.cols(); ++j) {
+            m_vecBlockSum += matSel.col(j);
+            if(++m_iBlockCount == m_iDecimation) {
+                matDecimated.col(iOut++) = m_vecBlockSum / static_cast<float>(m_iDecimation);
+                m_vecBlockSum.setZero();
+                m_iBlockCount = 0;
+            }
+        }
+    }
+    const MatrixXf& matOut = m_iDecimation > 1 ? matDecimated : matSel;
+
+    if(matOut.cols() == 0 || matOut.rows() == 0) {
+        return QByteArray();
+    }
+
+    const int iNumChannels = static_cast<int>(matOut.rows());
+    const int iNumSamples = static_cast<int>(matOut.cols());
+
+    //
+    // Payload
+    //
+    QByteArray baPayload;
+    QDataStream payloadStream(&baPayload, QIODevice::WriteOnly);
+    payloadStream.setByteOrder(QDataStream::BigEndian);
+    payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    payloadStream << (qint32)iNumChannels << (qint32)iNumSamples << (qint32)m_iCompression;
+
+    if(m_iCompression < 0) {
+        // Same sample interleaved layout as FIFF_DATA_BUFFER
+        for(int j = 0; j < iNumSamples; ++j) {
+            for(int i = 0; i < iNumChannels; ++i) {
+                payloadStream << matOut(i,j);
+            }
+        }
+    } else {
+        // Per channel codes, delta coded along time and zigzag mapped
+        QVector<quint32> vecCodes(iNumSamples);
+        QVector<quint32> vecResiduals(iNumChannels * iNumSamples);
+        QVector<float> vecSteps(iNumChannels, 0.0f);
+        QByteArray baBits;
+        BitWriter writer = {&baBits, 0, 0};
+
+        for(int i = 0; i < iNumChannels; ++i) {
+            if(m_iCompression > 0) {
+                const float fMaxAbs = matOut.row(i).cwiseAbs().maxCoeff();
+                const float fStep = fMaxAbs > 0.0f ? fMaxAbs / static_cast<float>((1 << (m_iCompression - 1)) - 1) : 1.0f;
+                vecSteps[i] = fStep;
+                for(int j = 0; j < iNumSamples; ++j) {
+                    vecCodes[j] = static_cast<quint32>(static_cast<qint32>(std::lround(matOut(i,j) / fStep)));
+                }
+            } else {
+                for(int j = 0; j < iNumSamples; ++j) {
+                    vecCodes[j] = floatToOrdered(matOut(i,j));
+                }
+            }
+
+            quint32* pResiduals = vecResiduals.data() + i * iNumSamples;
+            pResiduals[0] = vecCodes[0];
+            for(int j = 1; j < iNumSamples; ++j) {
+                pResiduals[j] = zigzag(vecCodes[j] - vecCodes[j-1]);
+            }
+        }
+
+        for(int i = 0; i < iNumChannels; ++i) {
+            const quint32* pResiduals = vecResiduals.constData() + i * iNumSamples;
+            const int k = riceParameter(pResiduals + 1, iNumSamples - 1);
+
+            if(m_iCompression > 0) {
+                payloadStream << vecSteps[i];
+            }
+            payloadStream << (quint8)k;
+
+            writer.put(pResiduals[0], 32);
+            for(int j = 1; j < iNumSamples; ++j) {
+                const quint32 q = pResiduals[j] >> k;
+                if(q < RICE_ESCAPE) {
+                    writer.put((1u << q) - 1u, static_cast<int>(q));
+                    writer.put(0, 1);
+                    writer.put(pResiduals[j], k);
+                } else {
+                    writer.put((1u << RICE_ESCAPE) - 1u, RICE_ESCAPE);
+                    writer.put(pResiduals[j], 32);
+                }
+            }
+        }
+        writer.flush();
+
+        payloadStream.writeRawData(baBits.constData(), baBits.size());
+    }
+
+    //
+    // Tag
+    //
+    QByteArray baTag;
+    QDataStream tagStream(&baTag, QIODevice::WriteOnly);
+    tagStream.setByteOrder(QDataStream::BigEndian);
+
+    tagStream << (qint32)FIFF_MNE_RT_STREAM_BUFFER;
+    tagStream << (qint32)FIFFT_BYTE;
+    tagStream << (qint32)baPayload.size();
+    tagStream << (qint32)FIFFV_NEXT_SEQ;
+    tagStream.writeRawData(baPayload.constData(), baPayload.size());
+
+    return baTag;
+}
+
+//=============================================================================================================
+
+bool RtStreamCodec::decode(const FiffTag& tag,
+                           MatrixXf& matData)
+{
+    QDataStream payloadStream(tag);
+    payloadStream.setByteOrder(QDataStream::BigEndian);
+    payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    qint32 iNumChannels, iNumSamples, iCompression;
+    payloadStream >> iNumChannels >> iNumSamples >> iCompression;
+
+    if(payloadStream.status() != QDataStream::Ok || iNumChannels <= 0 || iNumSamples <= 0) {
+        return false;
+    }
+
+    matData.resize(iNumChannels, iNumSamples);
+
+    if(iCompression < 0) {
+        for(int j = 0; j < iNumSamples; ++j) {
+            for(int i = 0; i < iNumChannels; ++i) {
+                payloadStream >> matData(i,j);
+            }
+        }
+        return payloadStream.status() == QDataStream::Ok;
+    }
+
+    QVector<float> vecSteps(iNumChannels, 0.0f);
+    QVector<int> vecK(iNumChannels);
+    for(int i = 0; i < iNumChannels; ++i) {
+        if(iCompression > 0) {
+            payloadStream >> vecSteps[i];
+        }
+        quint8 k;
+        payloadStream >> k;
+        vecK[i] = k;
+    }
+
+    if(payloadStream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    const int iHeaderSize = static_cast<int>(payloadStream.device()->pos());
+    BitReader reader = {reinterpret_cast<const uchar*>(tag.constData()) + iHeaderSize, tag.size() - iHeaderSize, 0, 0, 0};
+
+    for(int i = 0; i < iNumChannels; ++i) {
+        const int k = vecK[i];
+        quint32 uCode;
+        if(!reader.get(32, uCode)) {
+            return false;
+        }
+
+        for(int j = 0; j < iNumSamples; ++j) {
+            if(j > 0) {
+                quint32 q = 0, uBit = 1, uResidual;
+                while(q < RICE_ESCAPE) {
+                    if(!reader.get(1, uBit)) {
+                        return false;
+                    }
+                    if(uBit == 0) {
+                        break;
+                    }
+                    ++q;
+                }
+                if(q == RICE_ESCAPE) {
+                    if(!reader.get(32, uResidual)) {
+                        return false;
+                    }
+                } else {
+                    quint32 uLow;
+                    if(!reader.get(k, uLow)) {
+                        return false;
+                    }
+                    uResidual = (q << k) | uLow;
+                }
+                uCode += unzigzag(uResidual);
+            }
+
+            matData(i,j) = iCompression > 0 ? static_cast<float>(static_cast<qint32>(uCode)) * vecSteps[i]
+                                            : orderedToFloat(uCode);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,187 @@
+//=============================================================================================================
+/**
+ * @file     rtstreamcodec.h
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     RtStreamCodec class declaration.
+ *
+ */
+
+#ifndef RTSTREAMCODEC_H
+#define RTSTREAMCODEC_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../communication_global.h"
+
+#include <fiff/fiff_tag.h>
+#include <fiff/fiff_info.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE COMMUNICATIONLIB
+//=============================================================================================================
+
+namespace COMMUNICATIONLIB
+{
+
+//=============================================================================================================
+/**
+ * Encodes raw buffers for a reduced mne_rt_server stream mode and decodes them on the client side.
+ *
+ * A stream mode combines channel subsetting, decimation by block averaging and compression. Compressed samples
+ * are delta coded per channel and Golomb-Rice coded. Lossless compression codes the float bit patterns, near
+ * lossless compression first quantises each channel to the requested number of bits relative to the largest
+ * absolute value of the channel in the buffer. Encoded buffers are sent as self describing
+ * FIFF_MNE_RT_STREAM_BUFFER tags.
+ *
+ * @brief Encoder and decoder of decimated, channel subset and compressed raw buffers.
+ */
+class COMMUNICATIONSHARED_EXPORT RtStreamCodec
+{
+public:
+    typedef QSharedPointer<RtStreamCodec> SPtr;               /**< Shared pointer type for RtStreamCodec. */
+    typedef QSharedPointer<const RtStreamCodec> ConstSPtr;    /**< Const shared pointer type for RtStreamCodec. */
+
+    //=========================================================================================================
+    /**
+     * Creates the stream codec.
+     *
+     * @param[in] iDecimation    Number of samples averaged into one output sample.
+     * @param[in] vecChannels    Indices of the channels to stream. Empty streams all channels.
+     * @param[in] iCompression   -1 for uncompressed floats, 0 for lossless compression, 2 to 24 for near lossless
+     *                           compression with the given number of quantisation bits.
+     */
+    explicit RtStreamCodec(int iDecimation = 1,
+                           const Eigen::RowVectorXi& vecChannels = Eigen::RowVectorXi(),
+                           int iCompression = -1);
+
+    //=========================================================================================================
+    /**
+     * Returns whether the mode equals the full rate, uncompressed FIFF_DATA_BUFFER stream.
+     *
+     * @return true if no reduction is applied.
+     */
+    bool isDefault() const;
+
+    //=========================================================================================================
+    /**
+     * Returns a canonical description of the stream mode. Clients with equal modes can share one encoder.
+     *
+     * @return the mode description.
+     */
+    QString mode() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of samples averaged into one output sample.
+     *
+     * @return the decimation factor.
+     */
+    int getDecimation() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the indices of the streamed channels.
+     *
+     * @return the channel indices, empty if all channels are streamed.
+     */
+    const Eigen::RowVectorXi& getChannels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns whether the encoded buffers have the channels and the sampling frequency of another mode, i.e.,
+     * whether both modes differ at most in their compression.
+     *
+     * @param[in] other      The mode to compare with.
+     *
+     * @return true if channels and decimation are equal.
+     */
+    bool hasSameLayout(const RtStreamCodec& other) const;
+
+    //=========================================================================================================
+    /**
+     * Returns the measurement info which describes the encoded buffers, i.e., the streamed channels and the
+     * decimated sampling frequency. Channel indices which are out of range are skipped like in encode().
+     *
+     * @param[in] info       The measurement info of the full rate raw buffers.
+     *
+     * @return the measurement info of the reduced stream.
+     */
+    FIFFLIB::FiffInfo reduceInfo(const FIFFLIB::FiffInfo& info) const;
+
+    //=========================================================================================================
+    /**
+     * Encodes a raw buffer to a complete FIFF_MNE_RT_STREAM_BUFFER tag. Samples which do not complete a
+     * decimation block are kept and averaged together with the next buffer.
+     *
+     * @param[in] matData    The raw buffer (channels x samples).
+     *
+     * @return the encoded tag, or an empty array if the buffer did not complete an output sample.
+     */
+    QByteArray encode(const Eigen::MatrixXf& matData);
+
+    //=========================================================================================================
+    /**
+     * Decodes the data of a FIFF_MNE_RT_STREAM_BUFFER tag.
+     *
+     * @param[in] tag        The stream buffer tag.
+     * @param[out] matData   The decoded buffer (channels x samples).
+     *
+     * @return true if the tag could be decoded.
+     */
+    static bool decode(const FIFFLIB::FiffTag& tag,
+                       Eigen::MatrixXf& matData);
+
+private:
+    int                 m_iDecimation;      /**< Number of samples averaged into one output sample. */
+    Eigen::RowVectorXi  m_vecChannels;      /**< Indices of the streamed channels, empty for all channels. */
+    int                 m_iCompression;     /**< -1 uncompressed, 0 lossless, otherwise number of quantisation bits. */
+
+    Eigen::VectorXf     m_vecBlockSum;      /**< Sum of the samples of the incomplete decimation block. */
+    int                 m_iBlockCount;      /**< Number of samples in the incomplete decimation block. */
+};
+
+} // NAMESPACE
+
+#endif // RTSTREAMCODEC_H
@@ -42,6 +42,7 @@
 
 #include "connectivitysettings.h"
 #include "network/network.h"
+#include "metrics/abstractmetric.h"
 #include "metrics/correlation.h"
 #include "metrics/crosscorrelation.h"
 #include "metrics/coherence.h"
@@ -91,6 +92,26 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
     QElapsedTimer timer;
     timer.start();
 
+    // Compute the tapered spectra once and share them between all spectral metrics
+    bool bShareTaperedSpectra = false;
+    QStringList lSpectralMethods = QStringList() << "WPLI" << "USPLI" << "XCOR" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+
+    for(const QString& sMethod : lSpectralMethods) {
+        if(lMethods.contains(sMethod)) {
+            bShareTaperedSpectra = true;
+            break;
+        }
+    }
+
+    if(bShareTaperedSpectra) {
+        if(!AbstractMetric::isStorageModeActive(connectivitySettings)) {
+            connectivitySettings.clearIntermediateData();
+        }
+
+        AbstractMetric::computeTaperedSpectra(connectivitySettings);
+        connectivitySettings.setTaperedSpectraShared(true);
+    }
+
     if(lMethods.contains("WPLI")) {
         results.append(WeightedPhaseLagIndex::calculate(connectivitySettings));
     }
@@ -127,6 +148,15 @@ QList<Network> Connectivity::calculate(ConnectivitySettings& connectivitySetting
         results.append(DebiasedSquaredWeightedPhaseLagIndex::calculate(connectivitySettings));
     }
 
+    // Release the shared spectra if they are not kept in storage mode
+    if(bShareTaperedSpectra) {
+        connectivitySettings.setTaperedSpectraShared(false);
+
+        if(!AbstractMetric::isStorageModeActive(connectivitySettings)) {
+            connectivitySettings.clearIntermediateData();
+        }
+    }
+
     qWarning() << "Total" << timer.elapsed();
     qDebug() << "Connectivity::calculateMultiMethods - Calculated"<< lMethods <<"for" << connectivitySettings.size() << "trials in"<< timer.elapsed() << "msecs.";
 
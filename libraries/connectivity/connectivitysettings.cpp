@@ -76,6 +76,9 @@ ConnectivitySettings::ConnectivitySettings()
 : m_fFreqResolution(1.0f)
 , m_fSFreq(1000.0f)
 , m_sWindowType("hanning")
+, m_bCompactNetworkStorage(false)
+, m_bStorageModeIsActive(false)
+, m_bTaperedSpectraAreShared(false)
 {
     m_iNfft = int(m_fSFreq/m_fFreqResolution);
     qRegisterMetaType<CONNECTIVITYLIB::ConnectivitySettings>("CONNECTIVITYLIB::ConnectivitySettings");
@@ -92,12 +95,14 @@ void ConnectivitySettings::clearAllData()
 
 //*******************************************************************************************************
 
-void ConnectivitySettings::clearIntermediateData() 
+void ConnectivitySettings::clearIntermediateData(bool bKeepTaperedSpectra)
 {
     for (int i = 0; i < m_trialData.size(); ++i) {
         m_trialData[i].matPsd.resize(0,0);
         m_trialData[i].vecPairCsd.clear();
-        m_trialData[i].vecTapSpectra.clear();
+        if(!bKeepTaperedSpectra) {
+            m_trialData[i].vecTapSpectra.clear();
+        }
         m_trialData[i].vecPairCsdNormalized.clear();
         m_trialData[i].vecPairCsdImagSign.clear();
         m_trialData[i].vecPairCsdImagAbs.clear();
@@ -339,6 +344,48 @@ const QString& ConnectivitySettings::getWindowType() const
 
 //*******************************************************************************************************
 
+void ConnectivitySettings::setCompactNetworkStorage(bool bCompactNetworkStorage)
+{
+    m_bCompactNetworkStorage = bCompactNetworkStorage;
+}
+
+//*******************************************************************************************************
+
+bool ConnectivitySettings::isCompactNetworkStorage() const
+{
+    return m_bCompactNetworkStorage;
+}
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::setStorageModeActive(bool bStorageModeIsActive)
+{
+    m_bStorageModeIsActive = bStorageModeIsActive;
+}
+
+//*******************************************************************************************************
+
+bool ConnectivitySettings::isStorageModeActive() const
+{
+    return m_bStorageModeIsActive;
+}
+
+//*******************************************************************************************************
+
+void ConnectivitySettings::setTaperedSpectraShared(bool bTaperedSpectraAreShared)
+{
+    m_bTaperedSpectraAreShared = bTaperedSpectraAreShared;
+}
+
+//*******************************************************************************************************
+
+bool ConnectivitySettings::areTaperedSpectraShared() const
+{
+    return m_bTaperedSpectraAreShared;
+}
+
+//*******************************************************************************************************
+
 void ConnectivitySettings::setNodePositions(const FiffInfo& fiffInfo,
                                             const RowVectorXi& picks)
 {
@@ -123,7 +123,7 @@ public:
 
     void clearAllData();
 
-    void clearIntermediateData();
+    void clearIntermediateData(bool bKeepTaperedSpectra = false);
 
     void append(const QList<Eigen::MatrixXd>& matInputData);
 
@@ -157,6 +157,18 @@ public:
 
     const QString& getWindowType() const;
 
+    void setCompactNetworkStorage(bool bCompactNetworkStorage);
+
+    bool isCompactNetworkStorage() const;
+
+    void setStorageModeActive(bool bStorageModeIsActive);
+
+    bool isStorageModeActive() const;
+
+    void setTaperedSpectraShared(bool bTaperedSpectraAreShared);
+
+    bool areTaperedSpectraShared() const;
+
     void setNodePositions(const FIFFLIB::FiffInfo& fiffInfo,
                           const Eigen::RowVectorXi& picks);
 
@@ -175,6 +187,10 @@ protected:
     QStringList                     m_sConnectivityMethods;         /**< The connectivity methods. */
     QString                         m_sWindowType;                  /**< The window type used to compute tapered spectra. */
 
+    bool                            m_bCompactNetworkStorage;       /**< Whether the resulting networks keep their edge weights in compact storage, see Network::setCompactStorage. */
+    bool                            m_bStorageModeIsActive;         /**< Whether the intermediate data of the trials is kept after a computation, e.g., to add new trials incrementally. */
+    bool                            m_bTaperedSpectraAreShared;     /**< Whether the tapered spectra are shared between metrics and must not be cleared by them. */
+
     float                           m_fSFreq;                       /**< The sampling frequency. */
     int                             m_iNfft;                        /**< The FFT length. Also includes the negativ frequencies. Gets recalculated if the sFreq or spectrum resolution change. */
     float                           m_fFreqResolution;              /**< The spectrum's resolution. */
@@ -38,19 +38,33 @@
 
 #include "abstractmetric.h"
 
+#include <utils/spectral.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QtConcurrent>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
 
+#include <unsupported/Eigen/FFT>
+
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
 //=============================================================================================================
 // USED NAMESPACES
 //=============================================================================================================
 
 using namespace CONNECTIVITYLIB;
+using namespace Eigen;
+using namespace UTILSLIB;
 
 //=============================================================================================================
 // DEFINE GLOBAL METHODS
@@ -68,3 +82,185 @@ AbstractMetric::AbstractMetric()
 {
 }
 
+//*******************************************************************************************************
+
+bool AbstractMetric::isStorageModeActive(const ConnectivitySettings& connectivitySettings)
+{
+    return m_bStorageModeIsActive || connectivitySettings.isStorageModeActive();
+}
+
+
+//*******************************************************************************************************
+
+void AbstractMetric::computeTaperedSpectra(ConnectivitySettings& connectivitySettings)
+{
+    if(connectivitySettings.isEmpty()) {
+        return;
+    }
+
+    #ifdef EIGEN_FFTW_DEFAULT
+        fftw_make_planner_thread_safe();
+    #endif
+
+    int iSignalLength = connectivitySettings.at(0).matData.cols();
+    int iNfft = connectivitySettings.getFFTSize();
+
+    // Generate tapers once for all trials
+    QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+        computeTaperedSpectra(inputData,
+                              iNfft,
+                              tapers);
+    };
+
+    // Compute the tapered spectra in parallel for all trials
+    QtConcurrent::blockingMap(connectivitySettings.getTrialData(),
+                              computeLambda);
+}
+
+//*******************************************************************************************************
+
+void AbstractMetric::computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                           int iNfft,
+                                           const QPair<MatrixXd, VectorXd>& tapers)
+{
+    int iNRows = inputData.matData.rows();
+
+    if(inputData.vecTapSpectra.size() == iNRows) {
+        return;
+    }
+
+    inputData.vecTapSpectra.clear();
+    inputData.vecTapSpectra.reserve(iNRows);
+
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+    int iNTapers = tapers.first.rows();
+    int iSignalLength = inputData.matData.cols();
+
+    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
+    RowVectorXd vecInputFFT = RowVectorXd::Zero(qMax(iNfft, iSignalLength));
+    RowVectorXd rowData;
+    RowVectorXcd vecTmpFreq;
+    MatrixXcd matTapSpectrum(iNTapers, iNFreqs);
+
+    FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    for(int i = 0; i < iNRows; ++i) {
+        // Substract mean
+        rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
+
+        for(int j = 0; j < iNTapers; ++j) {
+            // Zero padd if necessary. The padding stays untouched between tapers and rows.
+            vecInputFFT.head(iSignalLength) = rowData.cwiseProduct(tapers.first.row(j));
+
+            // FFT for freq domain returning the half spectrum and multiply taper weights
+            fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
+            matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
+        }
+
+        inputData.vecTapSpectra.append(matTapSpectrum);
+    }
+}
+
+//*******************************************************************************************************
+
+void AbstractMetric::computeCrossSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                         int iNfft,
+                                         const QPair<MatrixXd, VectorXd>& tapers)
+{
+    int iNRows = inputData.matData.rows();
+    int iNTapers = tapers.first.rows();
+    int iNFreqs = int(floor(iNfft / 2.0)) + 1;
+
+    double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+    bool bNfftEven = false;
+    if (iNfft % 2 == 0){
+        bNfftEven = true;
+    }
+
+    // Preallocate the output
+    inputData.vecPairCsd.clear();
+    inputData.vecPairCsd.reserve(iNRows);
+
+    for (int i = 0; i < iNRows; ++i) {
+        inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,MatrixXcd(iNRows, m_iNumberBinAmount)));
+    }
+
+    MatrixXcd matSpectra(iNRows, iNTapers);
+    MatrixXcd matCsdLower(iNRows, iNRows);
+    MatrixXcd matCsd(iNRows, iNRows);
+
+    for (int iBin = 0; iBin < m_iNumberBinAmount; ++iBin) {
+        int iFreq = m_iNumberBinStart + iBin;
+
+        // Gather the spectra of all rows and tapers for this frequency bin
+        for (int i = 0; i < iNRows; ++i) {
+            matSpectra.row(i) = inputData.vecTapSpectra.at(i).col(iFreq).transpose();
+        }
+
+        // Divide first and last element by 2 due to half spectrum
+        double dScale = 1.0 / denomCSD;
+
+        if(iFreq == 0) {
+            dScale /= 2.0;
+        }
+
+        if(bNfftEven && iFreq == iNFreqs - 1) {
+            dScale /= 2.0;
+        }
+
+        // Compute X*X^H (average over tapers if necessary). Only the lower triangular part is computed.
+        matCsdLower.setZero();
+        matCsdLower.selfadjointView<Lower>().rankUpdate(matSpectra, dScale);
+        matCsd = matCsdLower.selfadjointView<Lower>();
+
+        // The CSD is Hermitian, row i is the conjugate of column i
+        for (int i = 0; i < iNRows; ++i) {
+            inputData.vecPairCsd[i].second.col(iBin) = matCsd.col(i).conjugate();
+        }
+    }
+}
+
+//*******************************************************************************************************
+
+void AbstractMetric::reduceIntermediateSumData(ConnectivitySettings::IntermediateSumData& sumData,
+                                               const ConnectivitySettings::IntermediateSumData& partialSumData)
+{
+    if(partialSumData.matPsdSum.size() != 0) {
+        if(sumData.matPsdSum.size() == 0) {
+            sumData.matPsdSum = partialSumData.matPsdSum;
+        } else {
+            sumData.matPsdSum += partialSumData.matPsdSum;
+        }
+    }
+
+    std::function<void(QVector<QPair<int,MatrixXcd> >&, const QVector<QPair<int,MatrixXcd> >&)> reduceComplex = [](QVector<QPair<int,MatrixXcd> >& vecSum,
+                                                                                                                    const QVector<QPair<int,MatrixXcd> >& vecPartialSum) {
+        if(vecSum.isEmpty()) {
+            vecSum = vecPartialSum;
+        } else {
+            for(int j = 0; j < vecPartialSum.size(); ++j) {
+                vecSum[j].second += vecPartialSum.at(j).second;
+            }
+        }
+    };
+
+    std::function<void(QVector<QPair<int,MatrixXd> >&, const QVector<QPair<int,MatrixXd> >&)> reduceReal = [](QVector<QPair<int,MatrixXd> >& vecSum,
+                                                                                                               const QVector<QPair<int,MatrixXd> >& vecPartialSum) {
+        if(vecSum.isEmpty()) {
+            vecSum = vecPartialSum;
+        } else {
+            for(int j = 0; j < vecPartialSum.size(); ++j) {
+                vecSum[j].second += vecPartialSum.at(j).second;
+            }
+        }
+    };
+
+    reduceComplex(sumData.vecPairCsdSum, partialSumData.vecPairCsdSum);
+    reduceComplex(sumData.vecPairCsdNormalizedSum, partialSumData.vecPairCsdNormalizedSum);
+    reduceReal(sumData.vecPairCsdImagSignSum, partialSumData.vecPairCsdImagSignSum);
+    reduceReal(sumData.vecPairCsdImagAbsSum, partialSumData.vecPairCsdImagAbsSum);
+    reduceReal(sumData.vecPairCsdImagSqrdSum, partialSumData.vecPairCsdImagSqrdSum);
+}
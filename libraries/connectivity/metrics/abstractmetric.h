@@ -40,6 +40,7 @@
 //=============================================================================================================
 
 #include "../connectivity_global.h"
+#include "../connectivitysettings.h"
 
 //=============================================================================================================
 // QT INCLUDES
@@ -47,6 +48,9 @@
 
 #include <QSharedPointer>
 #include <QVector>
+#include <QPair>
+#include <QThread>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -54,6 +58,12 @@
 
 #include <Eigen/Core>
 
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <functional>
+
 //=============================================================================================================
 // FORWARD DECLARATIONS
 //=============================================================================================================
@@ -87,7 +97,82 @@ public:
      */
     explicit AbstractMetric();
 
-    static bool     m_bStorageModeIsActive;
+    //=========================================================================================================
+    /**
+     * Returns whether the intermediate data is kept for the given computation. This is the case if the storage
+     * mode is active for all computations or only for the given connectivity settings.
+     *
+     * @param[in] connectivitySettings   The connectivity settings of the computation.
+     *
+     * @return true if the intermediate data is kept, false otherwise.
+     */
+    static bool isStorageModeActive(const ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+     * Computes the tapered spectra of all trials in parallel. This is the shared spectral front-end: the spectra
+     * are stored in the intermediate trial data and are picked up by all metrics computed afterwards.
+     *
+     * @param[in] connectivitySettings   The connectivity settings holding the trial data.
+     */
+    static void computeTaperedSpectra(ConnectivitySettings& connectivitySettings);
+
+    //=========================================================================================================
+    /**
+     * Computes the tapered spectra of a single trial if they are not available already.
+     *
+     * @param[in] inputData      The trial data. The spectra are stored in inputData.vecTapSpectra.
+     * @param[in] iNfft          The FFT length.
+     * @param[in] tapers         The taper windows and their weights.
+     */
+    static void computeTaperedSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                      int iNfft,
+                                      const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+     * Computes the cross spectral densities between all rows of a single trial from its tapered spectra, for the
+     * frequency bins set by m_iNumberBinStart and m_iNumberBinAmount. For each frequency bin the spectra of all
+     * rows and tapers form a (rows x tapers) matrix X and the CSD is computed as a Hermitian rank-k update X*X^H.
+     * The result is written to inputData.vecPairCsd, which holds one (rows x bins) matrix per row i with the CSD
+     * between row i and all rows j. The tapered spectra must have been computed already.
+     *
+     * @param[in, out] inputData     The trial data.
+     * @param[in]      iNfft         The FFT length.
+     * @param[in]      tapers        The taper windows and their weights.
+     */
+    static void computeCrossSpectra(ConnectivitySettings::IntermediateTrialData& inputData,
+                                    int iNfft,
+                                    const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+
+    //=========================================================================================================
+    /**
+     * Computes all trials in parallel and sums up their contributions without a shared lock. The trials are
+     * distributed over one partial sum per thread, each thread accumulates into its own partial sum only. The
+     * partial sums are combined pairwise in a tree reduction and finally added to sum.
+     *
+     * @param[in, out] vecTrialData      The trial data.
+     * @param[in]      computeTrial      Computes a single trial and adds its contribution to the given partial sum.
+     * @param[in]      reduce            Adds the second sum to the first one. Must handle empty sums.
+     * @param[in, out] sum               The sum to add the result to.
+     */
+    template<typename T>
+    static void mapReduceTrials(QVector<ConnectivitySettings::IntermediateTrialData>& vecTrialData,
+                                const std::function<void(ConnectivitySettings::IntermediateTrialData&, T&)>& computeTrial,
+                                const std::function<void(T&, const T&)>& reduce,
+                                T& sum);
+
+    //=========================================================================================================
+    /**
+     * Adds the partial intermediate sums to sumData. Empty sums in sumData are initialized with the partial ones.
+     *
+     * @param[in, out] sumData           The sums to add to.
+     * @param[in]      partialSumData    The partial sums to add.
+     */
+    static void reduceIntermediateSumData(ConnectivitySettings::IntermediateSumData& sumData,
+                                          const ConnectivitySettings::IntermediateSumData& partialSumData);
+
+    static bool     m_bStorageModeIsActive;         /**< Whether the intermediate data is kept for all computations, see also ConnectivitySettings::setStorageModeActive. */
     static int      m_iNumberBinStart;
     static int      m_iNumberBinAmount;
 
@@ -96,6 +181,57 @@ protected:
 
 //=============================================================================================================
 // INLINE DEFINITIONS
+//=============================================================================================================
+
+template<typename T>
+void AbstractMetric::mapReduceTrials(QVector<ConnectivitySettings::IntermediateTrialData>& vecTrialData,
+                                     const std::function<void(ConnectivitySettings::IntermediateTrialData&, T&)>& computeTrial,
+                                     const std::function<void(T&, const T&)>& reduce,
+                                     T& sum)
+{
+    int iNTrials = vecTrialData.size();
+
+    if(iNTrials == 0) {
+        return;
+    }
+
+    // One partial sum per thread. Trials are interleaved so that already computed trials in storage mode spread evenly.
+    int iNPartials = qBound(1, QThread::idealThreadCount(), iNTrials);
+    QVector<T> vecPartialSums(iNPartials);
+    QVector<int> vecIndices(iNPartials);
+
+    for(int i = 0; i < iNPartials; ++i) {
+        vecIndices[i] = i;
+    }
+
+    std::function<void(int&)> computeLambda = [&](int& iPartial) {
+        for(int i = iPartial; i < iNTrials; i += iNPartials) {
+            computeTrial(vecTrialData[i], vecPartialSums[iPartial]);
+        }
+    };
+
+    QtConcurrent::blockingMap(vecIndices,
+                              computeLambda);
+
+    // Tree reduction of the partial sums
+    for(int iStride = 1; iStride < iNPartials; iStride *= 2) {
+        QVector<int> vecTargets;
+
+        for(int i = 0; i + iStride < iNPartials; i += 2 * iStride) {
+            vecTargets.append(i);
+        }
+
+        std::function<void(int&)> reduceLambda = [&](int& iTarget) {
+            reduce(vecPartialSums[iTarget], vecPartialSums.at(iTarget + iStride));
+        };
+
+        QtConcurrent::blockingMap(vecTargets,
+                                  reduceLambda);
+    }
+
+    reduce(sum, vecPartialSums.at(0));
+}
+
 //=============================================================================================================
 } // namespace CONNECTIVITYLIB
 
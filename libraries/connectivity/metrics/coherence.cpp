@@ -89,11 +89,12 @@ Network Coherence::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
-        connectivitySettings.clearIntermediateData();
+    if(!isStorageModeActive(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData(connectivitySettings.areTaperedSpectraShared());
     }
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     // Check if start and bin amount need to be reset to full spectrum
     int iNfft = connectivitySettings.getFFTSize();
@@ -111,24 +111,30 @@ void Coherency::calculateAbs(Network& finalNetwork,
     // Compute PSD/CSD for each trial
     QMutex mutex;
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                                                       ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
+                sumData.matPsdSum,
+                sumData.vecPairCsdSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
     };
 
 //    iTime = timer.elapsed();
 //    qWarning() << "Preparation" << iTime;
 //    timer.restart();
 
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    mapReduceTrials<ConnectivitySettings::IntermediateSumData>(connectivitySettings.getTrialData(),
+                                                               computeLambda,
+                                                               reduceIntermediateSumData,
+                                                               connectivitySettings.getIntermediateSumData());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -182,24 +188,30 @@ void Coherency::calculateImag(Network& finalNetwork,
     // Compute PSD/CSD for each trial
     QMutex mutex;
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                                                       ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().matPsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                mutex,
+                sumData.matPsdSum,
+                sumData.vecPairCsdSum,
                 iNRows,
                 iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
     };
 
 //    iTime = timer.elapsed();
 //    qWarning() << "Preparation" << iTime;
 //    timer.restart();
 
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    mapReduceTrials<ConnectivitySettings::IntermediateSumData>(connectivitySettings.getTrialData(),
+                                                               computeLambda,
+                                                               reduceIntermediateSumData,
+                                                               connectivitySettings.getIntermediateSumData());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -227,11 +239,12 @@ void Coherency::calculateImag(Network& finalNetwork,
 void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         MatrixXd& matPsdSum,
                         QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
-                        const QPair<MatrixXd, VectorXd>& tapers)
+                        const QPair<MatrixXd, VectorXd>& tapers,
+                        bool bStorageModeIsActive,
+                        bool bTaperedSpectraAreShared)
 {
 //    QElapsedTimer timer;
 //    qint64 iTime = 0;
@@ -244,50 +257,24 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
 
     //qDebug() << "Coherency::compute - vecPairCsdSum and matPsdSum are computed for this trial.";
 
-    // Substract mean, compute tapered spectra and PSD
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
+    // Compute PSD
     bool bNfftEven = false;
     if (iNfft % 2 == 0){
         bNfftEven = true;
     }
 
-    FFT<double> fft;
-    fft.SetFlag(fft.HalfSpectrum);
-
     double denomPSD = tapers.second.cwiseAbs2().sum() / 2.0;
 
-    RowVectorXd vecInputFFT, rowData;
-    RowVectorXcd vecTmpFreq;
-
-    MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
     int i,j;
 
+    // Calculate tapered spectra if not available already, e.g. from the shared spectral front-end
+    computeTaperedSpectra(inputData,
+                          iNfft,
+                          tapers);
+
     inputData.matPsd = MatrixXd(iNRows, m_iNumberBinAmount);
 
     for (i = 0; i < iNRows; ++i) {
-        // Substract mean
-        rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-        // Calculate tapered spectra if not available already
-        if(inputData.vecTapSpectra.size() != iNRows) {
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-
         // Compute PSD (average over tapers if necessary).
         inputData.matPsd.row(i) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseAbs2().colwise().sum() / denomPSD;
 
@@ -301,48 +288,21 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
         }
     }
 
-    mutex.lock();
-
     if(matPsdSum.rows() == 0 || matPsdSum.cols() == 0) {
         matPsdSum = inputData.matPsd;
     } else {
         matPsdSum += inputData.matPsd;
     }
 
-    mutex.unlock();
-
 //    iTime = timer.elapsed();
 //    qWarning() << QThread::currentThreadId() << "Coherency::compute timer - compute - Tapered spectra and PSD (summing):" << iTime;
 //    timer.restart();
 
     // Compute CSD
     if(inputData.vecPairCsd.size() != iNRows) {
-        inputData.vecPairCsd.clear();
-
-        //MatrixXcd matCsd = MatrixXcd(iNRows, iNFreqs);
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
-        }
-
-        mutex.lock();
+        computeCrossSpectra(inputData,
+                            iNfft,
+                            tapers);
 
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
@@ -351,8 +311,6 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                 vecPairCsdSum[j].second += inputData.vecPairCsd.at(j).second;
             }
         }
-
-        mutex.unlock();
     }
 
 //    iTime = timer.elapsed();
@@ -360,9 +318,11 @@ void Coherency::compute(ConnectivitySettings::IntermediateTrialData& inputData,
 //    timer.restart();
 
     //Do not store data to save memory
-    if(!m_bStorageModeIsActive) {
+    if(!bStorageModeIsActive) {
         inputData.vecPairCsd.clear();
-        inputData.vecTapSpectra.clear();
+        if(!bTaperedSpectraAreShared) {
+            inputData.vecTapSpectra.clear();
+        }
     }
 
 //    iTime = timer.elapsed();
@@ -387,19 +347,15 @@ void Coherency::computePSDCSDAbs(QMutex& mutex,
     // Average. Note that the number of trials cancel each other out.
     MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
 
-    QSharedPointer<NetworkEdge> pEdge;
     MatrixXd matWeight;
     int j;
     int i = pairInput.first;
 
     for(j = i; j < matCohy.rows(); ++j) {
         matWeight = matCohy.row(j).cwiseAbs().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
 
         mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
+        finalNetwork.append(i, j, matWeight);
         mutex.unlock();
     }
 }
@@ -420,19 +376,15 @@ void Coherency::computePSDCSDImag(QMutex& mutex,
 
     MatrixXcd matCohy = pairInput.second.cwiseQuotient(matPSDtmp.cwiseSqrt());
 
-    QSharedPointer<NetworkEdge> pEdge;
     MatrixXd matWeight;
     int j;
     int i = pairInput.first;
 
     for(j = i; j < matCohy.rows(); ++j) {
         matWeight = matCohy.row(j).imag().transpose();
-        pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
 
         mutex.lock();
-        finalNetwork.getNodeAt(i)->append(pEdge);
-        finalNetwork.getNodeAt(j)->append(pEdge);
-        finalNetwork.append(pEdge);
+        finalNetwork.append(i, j, matWeight);
         mutex.unlock();
     }
 }
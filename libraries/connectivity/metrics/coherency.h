@@ -119,25 +119,27 @@ public:
 private:
     //=========================================================================================================
     /**
-     * Computes the coherency values. This function gets called in parallel.
+     * Computes the coherency values. This function gets called in parallel. The sums are the partial sums of the calling thread.
      *
      * @param[in]    inputData           The input data.
      * @param[out]   matPsdSum           The sum of all PSD matrices for each trial.
      * @param[out]   vecPairCsdSum       The sum of all CSD matrices for each trial.
-     * @param[in]    mutex               The mutex used to safely access matPsdSum and vecPairCsdSum.
      * @param[in]    iNRows              The number of rows.
      * @param[in]    iNFreqs             The number of frequenciy bins.
      * @param[in]    iNfft               The FFT length.
      * @param[in]    tapers              The taper information.
+     * @param[in]    bStorageModeIsActive Whether the intermediate data of the trial is kept.
+     * @param[in]    bTaperedSpectraAreShared Whether the tapered spectra are shared between metrics and must not be cleared.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         Eigen::MatrixXd& matPsdSum,
                         QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
-                        QMutex& mutex,
                         int iNRows,
                         int iNFreqs,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bStorageModeIsActive,
+                        bool bTaperedSpectraAreShared);
 
     //=========================================================================================================
     /**
@@ -90,6 +90,7 @@ Network Correlation::calculate(ConnectivitySettings& connectivitySettings)
     }   
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     //Create nodes
     int rows = connectivitySettings.at(0).matData.rows();
@@ -136,18 +137,13 @@ Network Correlation::calculate(ConnectivitySettings& connectivitySettings)
 
     //Add edges to network
     MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
     for(int i = 0; i < matDist.rows(); ++i) {
         for(j = i; j < matDist.cols(); ++j) {
             matWeight << matDist(i,j);
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+            finalNetwork.append(i, j, matWeight);
         }
     }
 
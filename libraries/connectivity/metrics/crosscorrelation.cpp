@@ -95,11 +95,12 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
-        connectivitySettings.clearIntermediateData();
+    if(!isStorageModeActive(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData(connectivitySettings.areTaperedSpectraShared());
     }
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     //Create nodes
     int rows = connectivitySettings.at(0).matData.rows();
@@ -124,15 +125,32 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
     QPair<MatrixXd, VectorXd> tapers = Spectral::generateTapers(iSignalLength, connectivitySettings.getWindowType());
 
     // Compute the cross correlation in parallel
-    QMutex mutex;
     MatrixXd matDist;
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
+
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, MatrixXd&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                      MatrixXd& matDistPartial) {
         compute(inputData,
-                matDist,
-                mutex,
+                matDistPartial,
                 iNfft,
-                tapers);
+                tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
+    };
+
+    std::function<void(MatrixXd&, const MatrixXd&)> reduceLambda = [](MatrixXd& matDistSum,
+                                                                      const MatrixXd& matDistPartial) {
+        if(matDistPartial.size() == 0) {
+            return;
+        }
+
+        if(matDistSum.size() == 0) {
+            matDistSum = matDistPartial;
+        } else {
+            matDistSum += matDistPartial;
+        }
     };
 
 //    iTime = timer.elapsed();
@@ -140,9 +158,10 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     // Calculate connectivity matrix over epochs and average afterwards
-    QFuture<void> resultMat = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                                computeLambda);
-    resultMat.waitForFinished();
+    mapReduceTrials<MatrixXd>(connectivitySettings.getTrialData(),
+                              computeLambda,
+                              reduceLambda,
+                              matDist);
 
     matDist /= connectivitySettings.size();
 
@@ -152,18 +171,13 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 
     //Add edges to network
     MatrixXd matWeight(1,1);
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
     for(int i = 0; i < matDist.rows(); ++i) {
         for(j = i; j < matDist.cols(); ++j) {
             matWeight << matDist(i,j);
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+            finalNetwork.append(i, j, matWeight);
         }
     }
 
@@ -178,16 +192,16 @@ Network CrossCorrelation::calculate(ConnectivitySettings& connectivitySettings)
 
 void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                                MatrixXd& matDist,
-                               QMutex& mutex,
                                int iNfft,
-                               const QPair<MatrixXd, VectorXd>& tapers)
+                               const QPair<MatrixXd, VectorXd>& tapers,
+                               bool bStorageModeIsActive,
+                               bool bTaperedSpectraAreShared)
 {
 //    QElapsedTimer timer;
 //    qint64 iTime = 0;
 //    timer.start();
 
-    // Calculate tapered spectra if not available already
-    RowVectorXd vecInputFFT, rowData;
+    RowVectorXd vecInputFFT;
     RowVectorXcd vecResultFreq;
 
     FFT<double> fft;
@@ -196,34 +210,10 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
     int i, j;
     int iNRows = inputData.matData.rows();
 
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        int iNFreqs = int(floor(iNfft / 2.0)) + 1;
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecResultFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecResultFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-    }
+    // Calculate tapered spectra if not available already, e.g. from the shared spectral front-end
+    computeTaperedSpectra(inputData,
+                          iNfft,
+                          tapers);
 
 //    iTime = timer.elapsed();
 //    qDebug() << QThread::currentThreadId() << "CrossCorrelation::compute timer - Tapered spectra:" << iTime;
@@ -255,8 +245,6 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
 //    timer.restart();
 
     // Sum up weights
-    mutex.lock();
-
     if(matDist.rows() != matDistTrial.rows() || matDist.cols() != matDistTrial.cols()) {
         matDist.resize(matDistTrial.rows(), matDistTrial.cols());
         matDist.setZero();
@@ -264,13 +252,13 @@ void CrossCorrelation::compute(ConnectivitySettings::IntermediateTrialData& inpu
 
     matDist += matDistTrial;
 
-    mutex.unlock();
-
 //    iTime = timer.elapsed();
 //    qDebug() << QThread::currentThreadId() << "CrossCorrelation::compute timer - Summing up matDist:" << iTime;
 //    timer.restart();
 
-    if(!m_bStorageModeIsActive) {
-        inputData.vecTapSpectra.clear();
+    if(!bStorageModeIsActive) {
+        if(!bTaperedSpectraAreShared) {
+            inputData.vecTapSpectra.clear();
+        }
     }
 }
@@ -49,7 +49,6 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -106,18 +105,21 @@ protected:
     //=========================================================================================================
     /**
      * Calculates the connectivity matrix for a given input data matrix based on the cross correlation coefficient.
+     * This function gets called in parallel. matDist is the partial sum of the calling thread.
      *
      * @param[in]    inputData           The input data.
      * @param[out]   matDist             The sum of all edge weights.
-     * @param[in]    mutex               The mutex used to safely access matDist.
      * @param[in]    iNfft               The FFT length.
      * @param[in]    tapers              The taper information.
+     * @param[in]    bStorageModeIsActive Whether the intermediate data of the trial is kept.
+     * @param[in]    bTaperedSpectraAreShared Whether the tapered spectra are shared between metrics and must not be cleared.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         Eigen::MatrixXd& matDist,
-                        QMutex& mutex,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bStorageModeIsActive,
+                        bool bTaperedSpectraAreShared);
 };
 
 //=============================================================================================================
@@ -95,11 +95,12 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
-        connectivitySettings.clearIntermediateData();
+    if(!isStorageModeActive(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData(connectivitySettings.areTaperedSpectraShared());
     }
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     #ifdef EIGEN_FFTW_DEFAULT
         fftw_make_planner_thread_safe();
@@ -147,18 +148,20 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
-        return compute(inputData,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagAbsSum,
-                       connectivitySettings.getIntermediateSumData().vecPairCsdImagSqrdSum,
-                       mutex,
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                                                       ConnectivitySettings::IntermediateSumData& sumData) {
+        compute(inputData,
+                       sumData.vecPairCsdSum,
+                       sumData.vecPairCsdImagAbsSum,
+                       sumData.vecPairCsdImagSqrdSum,
                        iNRows,
-                       iNFreqs,
                        iNfft,
-                       tapers);
+                       tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
     };
 
 //    iTime = timer.elapsed();
@@ -166,9 +169,10 @@ Network DebiasedSquaredWeightedPhaseLagIndex::calculate(ConnectivitySettings& co
 //    timer.restart();
 
     // Compute DSWPLI in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    mapReduceTrials<ConnectivitySettings::IntermediateSumData>(connectivitySettings.getTrialData(),
+                                                               computeLambda,
+                                                               reduceIntermediateSumData,
+                                                               connectivitySettings.getIntermediateSumData());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -191,11 +195,11 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                                                    QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                                                    QVector<QPair<int,MatrixXd> >& vecPairCsdImagAbsSum,
                                                    QVector<QPair<int,MatrixXd> >& vecPairCsdImagSqrdSum,
-                                                   QMutex& mutex,
                                                    int iNRows,
-                                                   int iNFreqs,
                                                    int iNfft,
-                                                   const QPair<MatrixXd, VectorXd>& tapers)
+                                                   const QPair<MatrixXd, VectorXd>& tapers,
+                                                   bool bStorageModeIsActive,
+                                                   bool bTaperedSpectraAreShared)
 {
     if(inputData.vecPairCsd.size() == iNRows &&
        inputData.vecPairCsdImagSqrd.size() == iNRows &&
@@ -204,75 +208,25 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
         return;
     }
 
-    int i,j;
+    int i;
 
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        RowVectorXd vecInputFFT, rowData;
-        RowVectorXcd vecTmpFreq;
-
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
-
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra if not available already
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-    }
+    // Calculate tapered spectra if not available already, e.g. from the shared spectral front-end
+    computeTaperedSpectra(inputData,
+                          iNfft,
+                          tapers);
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd(iNRows, m_iNumberBinAmount);
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+        computeCrossSpectra(inputData,
+                            iNfft,
+                            tapers);
 
         for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
+            const MatrixXcd& matCsd = inputData.vecPairCsd.at(i).second;
             inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,matCsd.imag().array().square()));
             inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseAbs()));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
@@ -284,16 +238,12 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                 vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdImagSqrd.isEmpty()) {
             for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
                 inputData.vecPairCsdImagSqrd.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().array().square()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagSqrdSum.isEmpty()) {
                 vecPairCsdImagSqrdSum = inputData.vecPairCsdImagSqrd;
             } else {
@@ -301,8 +251,6 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                     vecPairCsdImagSqrdSum[j].second += inputData.vecPairCsdImagSqrd.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
 
         if(inputData.vecPairCsdImagAbs.isEmpty()) {
@@ -310,8 +258,6 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                 inputData.vecPairCsdImagAbs.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseAbs()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagAbsSum.isEmpty()) {
                 vecPairCsdImagAbsSum = inputData.vecPairCsdImagAbs;
             } else {
@@ -319,14 +265,14 @@ void DebiasedSquaredWeightedPhaseLagIndex::compute(ConnectivitySettings::Interme
                     vecPairCsdImagAbsSum[j].second += inputData.vecPairCsdImagAbs.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
-    if(!m_bStorageModeIsActive) {
+    if(!bStorageModeIsActive) {
         inputData.vecPairCsd.clear();
-        inputData.vecTapSpectra.clear();
+        if(!bTaperedSpectraAreShared) {
+            inputData.vecTapSpectra.clear();
+        }
         inputData.vecPairCsdImagAbs.clear();
         inputData.vecPairCsdImagSqrd.clear();
     }
@@ -340,7 +286,6 @@ void DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(ConnectivitySettings &c
     // Compute final DSWPLI and create Network
     MatrixXd matNom, matDenom;
     MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
     for (int i = 0; i < connectivitySettings.at(0).matData.rows(); ++i) {
@@ -357,11 +302,7 @@ void DebiasedSquaredWeightedPhaseLagIndex::computeDSWPLI(ConnectivitySettings &c
         for(j = i; j < connectivitySettings.at(0).matData.rows(); ++j) {
             matWeight = matDenom.row(j).transpose();
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+            finalNetwork.append(i, j, matWeight);
         }
 
     }
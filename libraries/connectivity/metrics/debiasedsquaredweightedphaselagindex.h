@@ -53,7 +53,6 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
-#include <QMutex>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -109,27 +108,27 @@ public:
 protected:
     //=========================================================================================================
     /**
-     * Computes the DSWPLI values. This function gets called in parallel.
+     * Computes the DSWPLI values. This function gets called in parallel. The sums are the partial sums of the calling thread.
      *
      * @param[in] inputData              The input data.
      * @param[out]vecPairCsdSum          The sum of all CSD matrices for each trial.
      * @param[out]vecPairCsdImagAbsSum   The sum of all imag abs CSD matrices for each trial.
      * @param[out]vecPairCsdImagSqrdSum  The sum of all imag aqrd CSD matrices for each trial.
-     * @param[in] mutex                  The mutex used to safely access vecPairCsdSum.
      * @param[in] iNRows                 The number of rows.
-     * @param[in] iNFreqs                The number of frequenciy bins.
      * @param[in] iNfft                  The FFT length.
      * @param[in] tapers                 The taper information.
+     * @param[in] bStorageModeIsActive   Whether the intermediate data of the trial is kept.
+     * @param[in] bTaperedSpectraAreShared Whether the tapered spectra are shared between metrics and must not be cleared.
      */
     static void compute(ConnectivitySettings::IntermediateTrialData& inputData,
                         QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
                         QVector<QPair<int,Eigen::MatrixXd> >& vecPairCsdImagAbsSum,
                         QVector<QPair<int,Eigen::MatrixXd> >& vecPairCsdImagSqrdSum,
-                        QMutex& mutex,
                         int iNRows,
-                        int iNFreqs,
                         int iNfft,
-                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers);
+                        const QPair<Eigen::MatrixXd, Eigen::VectorXd>& tapers,
+                        bool bStorageModeIsActive,
+                        bool bTaperedSpectraAreShared);
 
     //=========================================================================================================
     /**
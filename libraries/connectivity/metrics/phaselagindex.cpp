@@ -95,11 +95,12 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
-        connectivitySettings.clearIntermediateData();
+    if(!isStorageModeActive(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData(connectivitySettings.areTaperedSpectraShared());
     }
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     #ifdef EIGEN_FFTW_DEFAULT
         fftw_make_planner_thread_safe();
@@ -145,17 +146,19 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                                                       ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdImagSignSum,
                 iNRows,
-                iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
     };
 
 //    iTime = timer.elapsed();
@@ -163,9 +166,10 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     // Compute DSWPLV in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    mapReduceTrials<ConnectivitySettings::IntermediateSumData>(connectivitySettings.getTrialData(),
+                                                               computeLambda,
+                                                               reduceIntermediateSumData,
+                                                               connectivitySettings.getIntermediateSumData());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -187,85 +191,35 @@ Network PhaseLagIndex::calculate(ConnectivitySettings& connectivitySettings)
 void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                             QVector<QPair<int,MatrixXcd> >& vecPairCsdSum,
                             QVector<QPair<int,MatrixXd> >& vecPairCsdImagSignSum,
-                            QMutex& mutex,
                             int iNRows,
-                            int iNFreqs,
                             int iNfft,
-                            const QPair<MatrixXd, VectorXd>& tapers)
+                            const QPair<MatrixXd, VectorXd>& tapers,
+                            bool bStorageModeIsActive,
+                            bool bTaperedSpectraAreShared)
 {
     if(inputData.vecPairCsdImagSign.size() == iNRows) {
         //qDebug() << "PhaseLagIndex::compute - vecPairCsdImagSign was already computed for this trial.";
         return;
     }
 
-    int i,j;
+    int i;
 
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        RowVectorXd vecInputFFT, rowData;
-        RowVectorXcd vecTmpFreq;
-
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
-
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-    }
+    // Calculate tapered spectra if not available already, e.g. from the shared spectral front-end
+    computeTaperedSpectra(inputData,
+                          iNfft,
+                          tapers);
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
+        computeCrossSpectra(inputData,
+                            iNfft,
+                            tapers);
 
         for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
+            const MatrixXcd& matCsd = inputData.vecPairCsd.at(i).second;
             inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,matCsd.imag().cwiseSign()));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
@@ -275,16 +229,12 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
                 vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdImagSign.isEmpty()) {
             for (i = 0; i < inputData.vecPairCsd.size(); ++i) {
                 inputData.vecPairCsdImagSign.append(QPair<int,MatrixXd>(i,inputData.vecPairCsd.at(i).second.imag().cwiseSign()));
             }
 
-            mutex.lock();
-
             if(vecPairCsdImagSignSum.isEmpty()) {
                 vecPairCsdImagSignSum = inputData.vecPairCsdImagSign;
             } else {
@@ -292,14 +242,14 @@ void PhaseLagIndex::compute(ConnectivitySettings::IntermediateTrialData& inputDa
                     vecPairCsdImagSignSum[j].second += inputData.vecPairCsdImagSign.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
-    if(!m_bStorageModeIsActive) {
+    if(!bStorageModeIsActive) {
         inputData.vecPairCsd.clear();
-        inputData.vecTapSpectra.clear();
+        if(!bTaperedSpectraAreShared) {
+            inputData.vecTapSpectra.clear();
+        }
         inputData.vecPairCsdImagSign.clear();
     }
 }
@@ -312,7 +262,6 @@ void PhaseLagIndex::computePLI(ConnectivitySettings &connectivitySettings,
     // Compute final PLI and create Network
     MatrixXd matNom;
     MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
     for (int i = 0; i < connectivitySettings.getIntermediateSumData().vecPairCsdImagSignSum.size(); ++i) {
@@ -321,11 +270,7 @@ void PhaseLagIndex::computePLI(ConnectivitySettings &connectivitySettings,
         for(j = i; j < matNom.rows(); ++j) {
             matWeight = matNom.row(j).transpose();
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+            finalNetwork.append(i, j, matWeight);
         }
     }
 }
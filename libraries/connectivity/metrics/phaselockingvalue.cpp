@@ -95,11 +95,12 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
         return finalNetwork;
     }
 
-    if(AbstractMetric::m_bStorageModeIsActive == false) {
-        connectivitySettings.clearIntermediateData();
+    if(!isStorageModeActive(connectivitySettings)) {
+        connectivitySettings.clearIntermediateData(connectivitySettings.areTaperedSpectraShared());
     }
 
     finalNetwork.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    finalNetwork.setCompactStorage(connectivitySettings.isCompactNetworkStorage());
 
     #ifdef EIGEN_FFTW_DEFAULT
         fftw_make_planner_thread_safe();
@@ -146,17 +147,19 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
     finalNetwork.setFFTSize(iNFreqs);
     finalNetwork.setUsedFreqBins(AbstractMetric::m_iNumberBinAmount);
 
-    QMutex mutex;
+    bool bStorageModeIsActive = isStorageModeActive(connectivitySettings);
+    bool bTaperedSpectraAreShared = connectivitySettings.areTaperedSpectraShared();
 
-    std::function<void(ConnectivitySettings::IntermediateTrialData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData) {
+    std::function<void(ConnectivitySettings::IntermediateTrialData&, ConnectivitySettings::IntermediateSumData&)> computeLambda = [&](ConnectivitySettings::IntermediateTrialData& inputData,
+                                                                                                                                       ConnectivitySettings::IntermediateSumData& sumData) {
         compute(inputData,
-                connectivitySettings.getIntermediateSumData().vecPairCsdSum,
-                connectivitySettings.getIntermediateSumData().vecPairCsdNormalizedSum,
-                mutex,
+                sumData.vecPairCsdSum,
+                sumData.vecPairCsdNormalizedSum,
                 iNRows,
-                iNFreqs,
                 iNfft,
-                tapers);
+                tapers,
+                bStorageModeIsActive,
+                bTaperedSpectraAreShared);
     };
 
 //    iTime = timer.elapsed();
@@ -164,9 +167,10 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
 //    timer.restart();
 
     // Compute PLV in parallel for all trials
-    QFuture<void> result = QtConcurrent::map(connectivitySettings.getTrialData(),
-                                             computeLambda);
-    result.waitForFinished();
+    mapReduceTrials<ConnectivitySettings::IntermediateSumData>(connectivitySettings.getTrialData(),
+                                                               computeLambda,
+                                                               reduceIntermediateSumData,
+                                                               connectivitySettings.getIntermediateSumData());
 
 //    iTime = timer.elapsed();
 //    qWarning() << "ComputeSpectraPSDCSD" << iTime;
@@ -188,85 +192,35 @@ Network PhaseLockingValue::calculate(ConnectivitySettings& connectivitySettings)
 void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inputData,
                                 QVector<QPair<int,Eigen::MatrixXcd> >& vecPairCsdSum,
                                 QVector<QPair<int,MatrixXcd> >& vecPairCsdNormalizedSum,
-                                QMutex& mutex,
                                 int iNRows,
-                                int iNFreqs,
                                 int iNfft,
-                                const QPair<MatrixXd, VectorXd>& tapers)
+                                const QPair<MatrixXd, VectorXd>& tapers,
+                                bool bStorageModeIsActive,
+                                bool bTaperedSpectraAreShared)
 {
     if(inputData.vecPairCsdNormalized.size() == iNRows) {
         //qDebug() << "PhaseLockingValue::compute - vecPairCsdNormalized was already computed for this trial.";
         return;
     }
 
-    int i,j;
+    int i;
 
-    // Calculate tapered spectra if not available already
-    // This code was copied and changed modified Utils/Spectra since we do not want to call the function due to time loss.
-    if(inputData.vecTapSpectra.isEmpty()) {
-        RowVectorXd vecInputFFT, rowData;
-        RowVectorXcd vecTmpFreq;
-
-        MatrixXcd matTapSpectrum(tapers.first.rows(), iNFreqs);
-
-        FFT<double> fft;
-        fft.SetFlag(fft.HalfSpectrum);
-
-        for (i = 0; i < iNRows; ++i) {
-            // Substract mean
-            rowData.array() = inputData.matData.row(i).array() - inputData.matData.row(i).mean();
-
-            // Calculate tapered spectra if not available already
-            for(j = 0; j < tapers.first.rows(); j++) {
-                // Zero padd if necessary. The zero padding in Eigen's FFT is only working for column vectors.
-                if (rowData.cols() < iNfft) {
-                    vecInputFFT.setZero(iNfft);
-                    vecInputFFT.block(0,0,1,rowData.cols()) = rowData.cwiseProduct(tapers.first.row(j));;
-                } else {
-                    vecInputFFT = rowData.cwiseProduct(tapers.first.row(j));
-                }
-
-                // FFT for freq domain returning the half spectrum and multiply taper weights
-                fft.fwd(vecTmpFreq, vecInputFFT, iNfft);
-                matTapSpectrum.row(j) = vecTmpFreq * tapers.second(j);
-            }
-
-            inputData.vecTapSpectra.append(matTapSpectrum);
-        }
-    }
+    // Calculate tapered spectra if not available already, e.g. from the shared spectral front-end
+    computeTaperedSpectra(inputData,
+                          iNfft,
+                          tapers);
 
     // Compute CSD
     if(inputData.vecPairCsd.isEmpty()) {
-        MatrixXcd matCsd = MatrixXcd(iNRows, m_iNumberBinAmount);
-
-        bool bNfftEven = false;
-        if (iNfft % 2 == 0){
-            bNfftEven = true;
-        }
-
-        double denomCSD = sqrt(tapers.second.cwiseAbs2().sum()) * sqrt(tapers.second.cwiseAbs2().sum()) / 2.0;
+        computeCrossSpectra(inputData,
+                            iNfft,
+                            tapers);
 
         for (i = 0; i < iNRows; ++i) {
-            for (j = i; j < iNRows; ++j) {
-                // Compute CSD (average over tapers if necessary)
-                matCsd.row(j) = inputData.vecTapSpectra.at(i).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(i).rows(),m_iNumberBinAmount).cwiseProduct(inputData.vecTapSpectra.at(j).block(0,m_iNumberBinStart,inputData.vecTapSpectra.at(j).rows(),m_iNumberBinAmount).conjugate()).colwise().sum() / denomCSD;
-
-                // Divide first and last element by 2 due to half spectrum
-                if(m_iNumberBinStart == 0) {
-                    matCsd.row(j)(0) /= 2.0;
-                }
-
-                if(bNfftEven && m_iNumberBinStart + m_iNumberBinAmount >= iNFreqs) {
-                    matCsd.row(j).tail(1) /= 2.0;
-                }
-            }
-
-            inputData.vecPairCsd.append(QPair<int,MatrixXcd>(i,matCsd));
+            const MatrixXcd& matCsd = inputData.vecPairCsd.at(i).second;
             inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,matCsd.cwiseQuotient(matCsd.cwiseAbs())));
         }
 
-        mutex.lock();
-
         if(vecPairCsdSum.isEmpty()) {
             vecPairCsdSum = inputData.vecPairCsd;
             vecPairCsdNormalizedSum = inputData.vecPairCsdNormalized;
@@ -276,16 +230,12 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
                 vecPairCsdNormalizedSum[j].second += inputData.vecPairCsdNormalized.at(j).second;
             }
         }
-
-        mutex.unlock();
     } else {
         if(inputData.vecPairCsdNormalized.isEmpty()) {
             for (i = 0; i < iNRows; ++i) {
                 inputData.vecPairCsdNormalized.append(QPair<int,MatrixXcd>(i,inputData.vecPairCsd.at(i).second.cwiseQuotient(inputData.vecPairCsd.at(i).second.cwiseAbs())));
             }
 
-            mutex.lock();
-
             if(vecPairCsdNormalizedSum.isEmpty()) {
                 vecPairCsdNormalizedSum = inputData.vecPairCsdNormalized;
             } else {
@@ -293,14 +243,14 @@ void PhaseLockingValue::compute(ConnectivitySettings::IntermediateTrialData& inp
                     vecPairCsdNormalizedSum[j].second += inputData.vecPairCsdNormalized.at(j).second;
                 }
             }
-
-            mutex.unlock();
         }
     }
 
-    if(!m_bStorageModeIsActive) {
+    if(!bStorageModeIsActive) {
         inputData.vecPairCsd.clear();
-        inputData.vecTapSpectra.clear();
+        if(!bTaperedSpectraAreShared) {
+            inputData.vecTapSpectra.clear();
+        }
         inputData.vecPairCsdNormalized.clear();
     }
 }
@@ -313,7 +263,6 @@ void PhaseLockingValue::computePLV(ConnectivitySettings &connectivitySettings,
     // Compute final PLV and create Network
     MatrixXd matNom;
     MatrixXd matWeight;
-    QSharedPointer<NetworkEdge> pEdge;
     int j;
 
     for (int i = 0; i < connectivitySettings.at(0).matData.rows(); ++i) {
@@ -322,11 +271,7 @@ void PhaseLockingValue::computePLV(ConnectivitySettings &connectivitySettings,
         for(j = i; j < connectivitySettings.at(0).matData.rows(); ++j) {
             matWeight = matNom.row(j).transpose();
 
-            pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(i, j, matWeight));
-
-            finalNetwork.getNodeAt(i)->append(pEdge);
-            finalNetwork.getNodeAt(j)->append(pEdge);
-            finalNetwork.append(pEdge);
+            finalNetwork.append(i, j, matWeight);
         }
     }
 }
@@ -81,6 +81,9 @@ Network::Network(const QString& sConnectivityMethod,
 , m_fSFreq(0.0f)
 , m_iFFTSize(128)
 , m_iNumberFreqBins(0)
+, m_bCompactStorage(false)
+, m_bEdgesMaterialized(false)
+, m_iMinMaxFreqBins(QPair<int,int>(-1,-1))
 {
     qRegisterMetaType<CONNECTIVITYLIB::Network>("CONNECTIVITYLIB::Network");
     qRegisterMetaType<CONNECTIVITYLIB::Network::SPtr>("CONNECTIVITYLIB::Network::SPtr");
@@ -95,6 +98,25 @@ MatrixXd Network::getFullConnectivityMatrix(bool bGetMirroredVersion) const
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(m_bCompactStorage) {
+        int iNumNodes = m_lNodes.size();
+        int k = 0;
+
+        for(int i = 0; i < iNumNodes; ++i) {
+            for(int j = i + 1; j < iNumNodes; ++j, ++k) {
+                if(m_bitsCompactEdges.testBit(k)) {
+                    matDist(i,j) = m_vecCompactWeights(k);
+                }
+            }
+        }
+
+        if(bGetMirroredVersion) {
+            matDist += matDist.transpose().eval();
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         int row = m_lFullEdges.at(i)->getStartNodeID();
         int col = m_lFullEdges.at(i)->getEndNodeID();
@@ -119,6 +141,25 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
     MatrixXd matDist(m_lNodes.size(), m_lNodes.size());
     matDist.setZero();
 
+    if(m_bCompactStorage) {
+        int iNumNodes = m_lNodes.size();
+        int k = 0;
+
+        for(int i = 0; i < iNumNodes; ++i) {
+            for(int j = i + 1; j < iNumNodes; ++j, ++k) {
+                if(m_bitsCompactActive.testBit(k)) {
+                    matDist(i,j) = m_vecCompactWeights(k);
+                }
+            }
+        }
+
+        if(bGetMirroredVersion) {
+            matDist += matDist.transpose().eval();
+        }
+
+        return matDist;
+    }
+
     for(int i = 0; i < m_lThresholdedEdges.size(); ++i) {
         int row = m_lThresholdedEdges.at(i)->getStartNodeID();
         int col = m_lThresholdedEdges.at(i)->getEndNodeID();
@@ -140,6 +181,8 @@ MatrixXd Network::getThresholdedConnectivityMatrix(bool bGetMirroredVersion) con
 
 const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 {
+    materializeEdges();
+
     return m_lFullEdges;
 }
 
@@ -147,6 +190,8 @@ const QList<NetworkEdge::SPtr>& Network::getFullEdges() const
 
 const QList<NetworkEdge::SPtr>& Network::getThresholdedEdges() const
 {
+    materializeEdges();
+
     return m_lThresholdedEdges;
 }
 
@@ -170,6 +215,11 @@ qint16 Network::getFullDistribution() const
 {
     qint16 distribution = 0;
 
+    if(m_bCompactStorage) {
+        // Each edge adds to the degree of both of its nodes
+        return 2 * m_bitsCompactEdges.count(true);
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         distribution += m_lNodes.at(i)->getFullDegree();
     }
@@ -183,6 +233,11 @@ qint16 Network::getThresholdedDistribution() const
 {
     qint16 distribution = 0;
 
+    if(m_bCompactStorage) {
+        // Each edge adds to the degree of both of its nodes
+        return 2 * m_bitsCompactActive.count(true);
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         distribution += m_lNodes.at(i)->getThresholdedDegree();
     }
@@ -225,6 +280,14 @@ QPair<int,int> Network::getMinMaxFullDegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(false, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecIndegrees + vecOutdegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getFullDegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getFullDegree();
@@ -243,6 +306,14 @@ QPair<int,int> Network::getMinMaxThresholdedDegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(true, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecIndegrees + vecOutdegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getThresholdedDegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getThresholdedDegree();
@@ -261,6 +332,14 @@ QPair<int,int> Network::getMinMaxFullIndegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(false, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecIndegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getFullIndegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getFullIndegree();
@@ -279,6 +358,14 @@ QPair<int,int> Network::getMinMaxThresholdedIndegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(true, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecIndegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getThresholdedIndegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getThresholdedIndegree();
@@ -297,6 +384,14 @@ QPair<int,int> Network::getMinMaxFullOutdegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(false, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecOutdegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getFullOutdegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getFullOutdegree();
@@ -315,6 +410,14 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
     int maxDegree = 0;
     int minDegree = 1000000;
 
+    if(m_bCompactStorage && !m_lNodes.isEmpty()) {
+        VectorXi vecIndegrees, vecOutdegrees;
+        computeCompactDegrees(true, vecIndegrees, vecOutdegrees);
+        VectorXi vecDegrees = vecOutdegrees;
+
+        return QPair<int,int>(vecDegrees.minCoeff(),vecDegrees.maxCoeff());
+    }
+
     for(int i = 0; i < m_lNodes.size(); ++i) {
         if(m_lNodes.at(i)->getThresholdedOutdegree() > maxDegree){
             maxDegree = m_lNodes.at(i)->getThresholdedOutdegree();
@@ -331,14 +434,26 @@ QPair<int,int> Network::getMinMaxThresholdedOutdegrees() const
 void Network::setThreshold(double dThreshold)
 {
     m_dThreshold = dThreshold;
-    m_lThresholdedEdges.clear();
 
-    for(int i = 0; i < m_lFullEdges.size(); ++i) {
-        if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
-            m_lFullEdges.at(i)->setActive(true);
-            m_lThresholdedEdges.append(m_lFullEdges.at(i));
-        } else {
-            m_lFullEdges.at(i)->setActive(false);
+    if(m_bCompactStorage) {
+        // Mark all existing edges whose averaged weight reaches the threshold
+        for(int k = 0; k < m_vecCompactWeights.size(); ++k) {
+            m_bitsCompactActive.setBit(k, std::fabs(m_vecCompactWeights(k)) >= m_dThreshold);
+        }
+
+        m_bitsCompactActive &= m_bitsCompactEdges;
+    }
+
+    if(!m_bCompactStorage || m_bEdgesMaterialized) {
+        m_lThresholdedEdges.clear();
+
+        for(int i = 0; i < m_lFullEdges.size(); ++i) {
+            if(fabs(m_lFullEdges.at(i)->getWeight()) >= m_dThreshold) {
+                m_lFullEdges.at(i)->setActive(true);
+                m_lThresholdedEdges.append(m_lFullEdges.at(i));
+            } else {
+                m_lFullEdges.at(i)->setActive(false);
+            }
         }
     }
 
@@ -388,6 +503,29 @@ void Network::setFrequencyRange(float fLowerFreq, float fUpperFreq)
     // Update the min max values
     m_minMaxFullWeights = QPair<double,double>(std::numeric_limits<double>::max(),0.0);
 
+    if(m_bCompactStorage) {
+        m_iMinMaxFreqBins = QPair<int,int>(iLowerBin,iUpperBin);
+
+        int iNumBins = m_matCompactWeights.rows();
+
+        if(iLowerBin < iNumBins) {
+            int iNumAveragedBins = qMin(iUpperBin, iNumBins - 1) - iLowerBin + 1;
+            m_vecCompactWeights = m_matCompactWeights.middleRows(iLowerBin, iNumAveragedBins).colwise().mean();
+        }
+
+        for(int k = 0; k < m_vecCompactWeights.size(); ++k) {
+            if(m_bitsCompactEdges.testBit(k)) {
+                double dWeight = std::fabs(m_vecCompactWeights(k));
+                m_minMaxFullWeights.first = qMin(m_minMaxFullWeights.first, dWeight);
+                m_minMaxFullWeights.second = qMax(m_minMaxFullWeights.second, dWeight);
+            }
+        }
+
+        if(!m_bEdgesMaterialized) {
+            return;
+        }
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setFrequencyBins(QPair<int,int>(iLowerBin,iUpperBin));
 
@@ -410,6 +548,13 @@ const QPair<float,float>& Network::getFrequencyRange() const
 
 void Network::append(NetworkEdge::SPtr newEdge)
 {
+    if(m_bCompactStorage) {
+        append(newEdge->getStartNodeID(),
+               newEdge->getEndNodeID(),
+               newEdge->getMatrixWeight());
+        return;
+    }
+
     if(newEdge->getEndNodeID() != newEdge->getStartNodeID()) {
         double dEdgeWeight = newEdge->getWeight();
         if(dEdgeWeight < m_minMaxFullWeights.first) {
@@ -428,6 +573,91 @@ void Network::append(NetworkEdge::SPtr newEdge)
 
 //=============================================================================================================
 
+void Network::append(int iStartNodeID,
+                     int iEndNodeID,
+                     const MatrixXd& matWeight)
+{
+    if(iStartNodeID == iEndNodeID) {
+        return;
+    }
+
+    if(!m_bCompactStorage || m_bEdgesMaterialized) {
+        NetworkEdge::SPtr pEdge = NetworkEdge::SPtr(new NetworkEdge(iStartNodeID,
+                                                                    iEndNodeID,
+                                                                    matWeight,
+                                                                    true,
+                                                                    m_iMinMaxFreqBins.first,
+                                                                    m_iMinMaxFreqBins.second));
+
+        m_lNodes.at(iStartNodeID)->append(pEdge);
+        m_lNodes.at(iEndNodeID)->append(pEdge);
+
+        if(!m_bCompactStorage) {
+            append(pEdge);
+            return;
+        }
+
+        m_lFullEdges << pEdge;
+
+        if(fabs(pEdge->getWeight()) >= m_dThreshold) {
+            m_lThresholdedEdges << pEdge;
+        } else {
+            pEdge->setActive(false);
+        }
+    }
+
+    // Compact storage is non-directional
+    int iRow = qMin(iStartNodeID, iEndNodeID);
+    int iCol = qMax(iStartNodeID, iEndNodeID);
+    int iNumNodes = m_lNodes.size();
+
+    if(iCol >= iNumNodes) {
+        qDebug() << "Network::append - Node id" << iCol << "is out of range. Returning.";
+        return;
+    }
+
+    // Allocate the tensor with the first edge, when the number of nodes and frequency bins is known
+    if(m_matCompactWeights.cols() == 0) {
+        int iNumPairs = iNumNodes * (iNumNodes - 1) / 2;
+        m_matCompactWeights = MatrixXf::Zero(matWeight.rows(), iNumPairs);
+        m_vecCompactWeights = RowVectorXf::Zero(iNumPairs);
+        m_bitsCompactEdges = QBitArray(iNumPairs);
+        m_bitsCompactActive = QBitArray(iNumPairs);
+    }
+
+    if(matWeight.rows() != m_matCompactWeights.rows()) {
+        qDebug() << "Network::append - Number of frequency bins does not match the compact storage. Returning.";
+        return;
+    }
+
+    int k = getCompactPairIndex(iRow, iCol);
+
+    m_matCompactWeights.col(k) = matWeight.rowwise().mean().cast<float>();
+
+    int iStartWeightBin = m_iMinMaxFreqBins.first;
+    int iEndWeightBin = m_iMinMaxFreqBins.second;
+
+    if(iStartWeightBin == -1 && iEndWeightBin == -1) {
+        m_vecCompactWeights(k) = m_matCompactWeights.col(k).mean();
+    } else if(iStartWeightBin < m_matCompactWeights.rows()) {
+        int iNumAveragedBins = qMin(iEndWeightBin, int(m_matCompactWeights.rows()) - 1) - iStartWeightBin + 1;
+        m_vecCompactWeights(k) = m_matCompactWeights.col(k).segment(iStartWeightBin, iNumAveragedBins).mean();
+    }
+
+    double dEdgeWeight = m_vecCompactWeights(k);
+
+    if(dEdgeWeight < m_minMaxFullWeights.first) {
+        m_minMaxFullWeights.first = dEdgeWeight;
+    } else if(dEdgeWeight >= m_minMaxFullWeights.second) {
+        m_minMaxFullWeights.second = dEdgeWeight;
+    }
+
+    m_bitsCompactEdges.setBit(k);
+    m_bitsCompactActive.setBit(k, std::fabs(dEdgeWeight) >= m_dThreshold);
+}
+
+//=============================================================================================================
+
 void Network::append(NetworkNode::SPtr newNode)
 {
     m_lNodes << newNode;
@@ -437,6 +667,10 @@ void Network::append(NetworkNode::SPtr newNode)
 
 bool Network::isEmpty() const
 {
+    if(m_bCompactStorage) {
+        return m_lNodes.isEmpty() || m_bitsCompactEdges.count(true) == 0;
+    }
+
     if(m_lFullEdges.isEmpty() || m_lNodes.isEmpty()) {
         return true;
     }
@@ -454,6 +688,10 @@ void Network::normalize()
         return;
     }
 
+    if(m_bCompactStorage) {
+        m_vecCompactWeights /= m_minMaxFullWeights.second;
+    }
+
     for(int i = 0; i < m_lFullEdges.size(); ++i) {
         m_lFullEdges.at(i)->setWeight(m_lFullEdges.at(i)->getWeight()/m_minMaxFullWeights.second);
     }
@@ -521,3 +759,95 @@ int Network::getFFTSize()
     return m_iFFTSize;
 }
 
+
+//=============================================================================================================
+
+void Network::setCompactStorage(bool bCompactStorage)
+{
+    if(!m_lFullEdges.isEmpty() || m_matCompactWeights.cols() != 0) {
+        qDebug() << "Network::setCompactStorage - The network already holds edges. Returning.";
+        return;
+    }
+
+    m_bCompactStorage = bCompactStorage;
+}
+
+//=============================================================================================================
+
+bool Network::isCompactStorage() const
+{
+    return m_bCompactStorage;
+}
+
+//=============================================================================================================
+
+void Network::computeCompactDegrees(bool bThresholded,
+                                    VectorXi& vecIndegrees,
+                                    VectorXi& vecOutdegrees) const
+{
+    int iNumNodes = m_lNodes.size();
+    const QBitArray& bitsEdges = bThresholded ? m_bitsCompactActive : m_bitsCompactEdges;
+
+    vecIndegrees = VectorXi::Zero(iNumNodes);
+    vecOutdegrees = VectorXi::Zero(iNumNodes);
+
+    if(bitsEdges.isEmpty()) {
+        return;
+    }
+
+    int k = 0;
+
+    for(int i = 0; i < iNumNodes; ++i) {
+        for(int j = i + 1; j < iNumNodes; ++j, ++k) {
+            if(bitsEdges.testBit(k)) {
+                vecOutdegrees(i)++;
+                vecIndegrees(j)++;
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
+void Network::materializeEdges() const
+{
+    if(!m_bCompactStorage || m_bEdgesMaterialized) {
+        return;
+    }
+
+    m_bEdgesMaterialized = true;
+
+    if(m_bitsCompactEdges.isEmpty()) {
+        return;
+    }
+
+    int iNumNodes = m_lNodes.size();
+    int k = 0;
+
+    for(int i = 0; i < iNumNodes; ++i) {
+        for(int j = i + 1; j < iNumNodes; ++j, ++k) {
+            if(!m_bitsCompactEdges.testBit(k)) {
+                continue;
+            }
+
+            NetworkEdge::SPtr pEdge = NetworkEdge::SPtr(new NetworkEdge(i,
+                                                                        j,
+                                                                        m_matCompactWeights.col(k).cast<double>(),
+                                                                        m_bitsCompactActive.testBit(k),
+                                                                        m_iMinMaxFreqBins.first,
+                                                                        m_iMinMaxFreqBins.second));
+
+            // Keep normalized weights
+            pEdge->setWeight(m_vecCompactWeights(k));
+
+            m_lNodes.at(i)->append(pEdge);
+            m_lNodes.at(j)->append(pEdge);
+
+            m_lFullEdges << pEdge;
+
+            if(pEdge->isActive()) {
+                m_lThresholdedEdges << pEdge;
+            }
+        }
+    }
+}
@@ -46,6 +46,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QBitArray>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -306,6 +307,20 @@ public:
      */
     void append(QSharedPointer<NetworkEdge> newEdge);
 
+    //=========================================================================================================
+    /**
+     * Adds an edge between two nodes. In compact storage the weights are written to the weight tensor, otherwise
+     * a NetworkEdge is created and appended to this network and to both nodes. The nodes must have been appended
+     * already.
+     *
+     * @param[in] iStartNodeID   The start node id of the edge.
+     * @param[in] iEndNodeID     The end node id of the edge.
+     * @param[in] matWeight      The edge weight (frequency bins x 1).
+     */
+    void append(int iStartNodeID,
+                int iEndNodeID,
+                const Eigen::MatrixXd& matWeight);
+
     //=========================================================================================================
     /**
      * Appends a network edge to this network node.
@@ -328,6 +343,26 @@ public:
      */
     void normalize();
 
+    //=========================================================================================================
+    /**
+     * Sets whether to use compact storage. In compact storage the edge weights are kept in a dense upper triangular
+     * (frequency bins x node pairs) float tensor with bitset masks for the existing and the active edges, instead of
+     * one NetworkEdge object per edge. Edge objects are only created once they are requested, e.g. by getFullEdges().
+     * Compact storage is non-directional, edges always go from the lower to the higher node id.
+     * Must be set before the first edge is added.
+     *
+     * @param[in] bCompactStorage    Whether to use compact storage.
+     */
+    void setCompactStorage(bool bCompactStorage);
+
+    //=========================================================================================================
+    /**
+     * Returns whether compact storage is used.
+     *
+     * @return   Whether compact storage is used.
+     */
+    bool isCompactStorage() const;
+
     //=========================================================================================================
     /**
      * Get the current visualization info.
@@ -393,8 +428,37 @@ public:
     int getFFTSize();
 
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network.*/
+    //=========================================================================================================
+    /**
+     * Returns the index of a node pair in the compact weight tensor.
+     *
+     * @param[in] iRow   The lower node id.
+     * @param[in] iCol   The higher node id.
+     *
+     * @return   The node pair index.
+     */
+    inline int getCompactPairIndex(int iRow, int iCol) const;
+
+    //=========================================================================================================
+    /**
+     * Counts the ingoing and outgoing edges of all nodes in compact storage.
+     *
+     * @param[in] bThresholded       Whether to only count the active edges.
+     * @param[out] vecIndegrees      The number of ingoing edges per node.
+     * @param[out] vecOutdegrees     The number of outgoing edges per node.
+     */
+    void computeCompactDegrees(bool bThresholded,
+                               Eigen::VectorXi& vecIndegrees,
+                               Eigen::VectorXi& vecOutdegrees) const;
+
+    //=========================================================================================================
+    /**
+     * Creates the edge objects from the compact weight tensor, if not done already.
+     */
+    void materializeEdges() const;
+
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lFullEdges;               /**< List with all edges of the network. Created on demand in compact storage.*/
+    mutable QList<QSharedPointer<NetworkEdge> >     m_lThresholdedEdges;        /**< List with all the active (thresholded) edges of the network. Created on demand in compact storage.*/
 
     QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
 
@@ -412,11 +476,26 @@ protected:
     int                                     m_iFFTSize;                 /**< The used FFT size (number of total frequency bins for a half spectrum - only positive frequencies).*/
 
     VisualizationInfo                       m_visualizationInfo;        /**< The current visualization info used to plot the network later on.*/
+
+    bool                                    m_bCompactStorage;          /**< Whether the edge weights are kept in the compact weight tensor.*/
+    mutable bool                            m_bEdgesMaterialized;       /**< Whether the edge objects were created from the compact weight tensor.*/
+    QPair<int,int>                          m_iMinMaxFreqBins;          /**< The lower/upper bin indeces used to average the compact weights. Default is -1 which means an average over all weights.*/
+    Eigen::MatrixXf                         m_matCompactWeights;        /**< The compact weight tensor (frequency bins x upper triangular node pairs).*/
+    Eigen::RowVectorXf                      m_vecCompactWeights;        /**< The averaged compact weight of each node pair.*/
+    QBitArray                               m_bitsCompactEdges;         /**< Bitset marking the node pairs connected by an edge.*/
+    QBitArray                               m_bitsCompactActive;        /**< Bitset marking the node pairs connected by an active (thresholded) edge.*/
 };
 
 //=============================================================================================================
 // INLINE DEFINITIONS
 //=============================================================================================================
+
+inline int Network::getCompactPairIndex(int iRow, int iCol) const
+{
+    int iNumNodes = m_lNodes.size();
+
+    return iRow * (2 * iNumNodes - iRow - 1) / 2 + (iCol - iRow - 1);
+}
 } // namespace CONNECTIVITYLIB
 
 #ifndef metatype_networks
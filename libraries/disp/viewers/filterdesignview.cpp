@@ -86,6 +86,10 @@ FilterDesignView::FilterDesignView(const QString& sSettingsPath,
 : AbstractView(parent, f)
 , m_pUi(new Ui::FilterDesignViewWidget)
 , m_iFilterTaps(512)
+, m_iFirFilterTaps(4096)
+, m_iIirFilterOrder(4)
+, m_iMaxFirFilterTaps(4096)
+, m_bIirFilter(false)
 , m_dSFreq(600)
 {
     m_sSettingsPath = sSettingsPath;
@@ -116,8 +120,15 @@ void FilterDesignView::setMaxAllowedFilterTaps(int iMaxNumberFilterTaps)
         iMaxNumberFilterTaps--;
     }
 
-    m_pUi->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
-    m_pUi->m_spinBox_filterTaps->setMinimum(16);
+    m_iMaxFirFilterTaps = iMaxNumberFilterTaps;
+
+    //The spin box range only changes while it holds the FIR filter taps, the IIR filter order is not affected by the window size
+    if(m_bIirFilter) {
+        m_iFirFilterTaps = qMin(m_iFirFilterTaps, m_iMaxFirFilterTaps);
+    } else {
+        m_pUi->m_spinBox_filterTaps->setMaximum(iMaxNumberFilterTaps);
+        m_pUi->m_spinBox_filterTaps->setMinimum(16);
+    }
 
     //Update filter depending on new window size
     filterParametersChanged();
@@ -209,7 +220,8 @@ void FilterDesignView::saveSettings()
 
     settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterFrom"), m_filterKernel.getHighpassFreq());
     settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterTo"), m_filterKernel.getLowpassFreq());
-    settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterOrder"), m_filterKernel.getFilterOrder());
+    settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterOrder"), m_bIirFilter ? m_iFirFilterTaps : m_pUi->m_spinBox_filterTaps->value());
+    settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterIirOrder"), m_bIirFilter ? m_pUi->m_spinBox_filterTaps->value() : m_iIirFilterOrder);
     settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterDesignMethod"), m_filterKernel.m_designMethod);
     settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterTransition"), m_filterKernel.getParksWidth()*(m_filterKernel.getSamplingFrequency()/2));
     settings.setValue(m_sSettingsPath + QString("/FilterDesignView/filterChannelType"), getChannelType());
@@ -229,8 +241,15 @@ void FilterDesignView::loadSettings()
     //Set stored filter settings from last session
     m_pUi->m_doubleSpinBox_to->setValue(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterTo"), 40.0).toDouble());
     m_pUi->m_doubleSpinBox_from->setValue(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterFrom"), 1.0).toDouble());
-    m_pUi->m_spinBox_filterTaps->setValue(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterOrder"), 128).toInt());
-    m_pUi->m_comboBox_designMethod->setCurrentIndex(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterDesignMethod"), FilterKernel::DesignMethod::Cosine).toInt());
+    m_iFirFilterTaps = settings.value(m_sSettingsPath + QString("/FilterDesignView/filterOrder"), 128).toInt();
+    m_iIirFilterOrder = settings.value(m_sSettingsPath + QString("/FilterDesignView/filterIirOrder"), 4).toInt();
+    FilterKernel::DesignMethod designMethod = static_cast<FilterKernel::DesignMethod>(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterDesignMethod"), FilterKernel::DesignMethod::Cosine).toInt());
+    QString sDesignMethod = getStringForDesignMethod(designMethod);
+    if(designMethod == FilterKernel::Butterworth || designMethod == FilterKernel::Chebyshev) {
+        sDesignMethod += " (IIR)";
+    }
+    m_pUi->m_comboBox_designMethod->setCurrentText(sDesignMethod);
+    setFilterFamily(designMethod == FilterKernel::Butterworth || designMethod == FilterKernel::Chebyshev);
     m_pUi->m_doubleSpinBox_transitionband->setValue(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterTransition"), 0.1).toDouble());
     m_pUi->m_comboBox_filterApplyTo->setCurrentText(settings.value(m_sSettingsPath + QString("/FilterDesignView/filterChannelType"), "All").toString());
 
@@ -376,6 +395,13 @@ void FilterDesignView::changeStateSpinBoxes(int currentIndex)
 {
     Q_UNUSED(currentIndex);
 
+    //Remember the value of the current filter family, the range change would clamp it otherwise
+    if(m_bIirFilter) {
+        m_iIirFilterOrder = m_pUi->m_spinBox_filterTaps->value();
+    } else {
+        m_iFirFilterTaps = m_pUi->m_spinBox_filterTaps->value();
+    }
+
     //Change visibility of filter tap spin boxes depending on filter design method
     switch(m_pUi->m_comboBox_designMethod->currentIndex()) {
         case 0: //Cosine
@@ -383,11 +409,21 @@ void FilterDesignView::changeStateSpinBoxes(int currentIndex)
 //            m_pUi->m_label_filterTaps->setVisible(false);
             m_pUi->m_spinBox_filterTaps->setVisible(true);
             m_pUi->m_label_filterTaps->setVisible(true);
+            setFilterFamily(false);
             break;
 
         case 1: //Tschebyscheff
             m_pUi->m_spinBox_filterTaps->setVisible(true);
             m_pUi->m_label_filterTaps->setVisible(true);
+            setFilterFamily(false);
+            break;
+
+        case 2: //Butterworth
+        case 3: //Chebyshev
+            //The spin box holds the IIR prototype order for these
+            m_pUi->m_spinBox_filterTaps->setVisible(true);
+            m_pUi->m_label_filterTaps->setVisible(true);
+            setFilterFamily(true);
             break;
     }
 
@@ -396,6 +432,21 @@ void FilterDesignView::changeStateSpinBoxes(int currentIndex)
 
 //=============================================================================================================
 
+void FilterDesignView::setFilterFamily(bool bIirFilter)
+{
+    m_bIirFilter = bIirFilter;
+
+    if(m_bIirFilter) {
+        m_pUi->m_spinBox_filterTaps->setRange(2, 32);
+        m_pUi->m_spinBox_filterTaps->setValue(m_iIirFilterOrder);
+    } else {
+        m_pUi->m_spinBox_filterTaps->setRange(16, m_iMaxFirFilterTaps);
+        m_pUi->m_spinBox_filterTaps->setValue(m_iFirFilterTaps);
+    }
+}
+
+//=============================================================================================================
+
 void FilterDesignView::filterParametersChanged()
 {
     //User defined filter parameters
@@ -438,6 +489,14 @@ void FilterDesignView::filterParametersChanged()
         dMethod = FilterKernel::Cosine;
     }
 
+    if(m_pUi->m_comboBox_designMethod->currentText() == "Butterworth (IIR)") {
+        dMethod = FilterKernel::Butterworth;
+    }
+
+    if(m_pUi->m_comboBox_designMethod->currentText() == "Chebyshev (IIR)") {
+        dMethod = FilterKernel::Chebyshev;
+    }
+
     //Generate filters
     m_filterKernel = FilterKernel("Designed Filter",
                                   FilterKernel::BPF,
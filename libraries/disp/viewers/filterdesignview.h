@@ -240,6 +240,15 @@ protected:
      */
     void changeStateSpinBoxes(int currentIndex);
 
+    //=========================================================================================================
+    /**
+     * Sets the range of the filter taps spin box to the one of the given filter family and restores the value which was
+     * last used for this family.
+     *
+     * @param bIirFilter     Whether the spin box should hold the IIR filter order instead of the number of FIR filter taps.
+     */
+    void setFilterFamily(bool bIirFilter);
+
     //=========================================================================================================
     /**
      * This function gets called whenever the filter parameters are altered by the user via the gui.
@@ -281,6 +290,10 @@ protected:
     QString                             m_sSettingsPath;            /**< The settings path to store the GUI settings to. */
 
     int                                 m_iFilterTaps;              /**< The current number of filter taps.*/
+    int                                 m_iFirFilterTaps;           /**< The last number of filter taps used by a FIR design method.*/
+    int                                 m_iIirFilterOrder;          /**< The last filter order used by an IIR design method.*/
+    int                                 m_iMaxFirFilterTaps;        /**< The maximum allowed number of FIR filter taps.*/
+    bool                                m_bIirFilter;               /**< Whether the filter taps spin box currently holds an IIR filter order.*/
     double                              m_dSFreq;                   /**< The current sampling frequency.*/
 
 signals:
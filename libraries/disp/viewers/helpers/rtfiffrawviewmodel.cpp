@@ -54,6 +54,7 @@
 
 #include <QBrush>
 #include <QCoreApplication>
+#include <QDebug>
 #include <QtConcurrent>
 #include <QFuture>
 
@@ -505,13 +506,14 @@ void RtFiffRawViewModel::addData(const QList<MatrixXd> &data)
 
             //Perform SPHARA on filtered data after actual filtering - SPHARA should be applied on the best possible data
             if(doSphara) {
-                if(m_iCurrentSample-m_iMaxFilterLength/2 >= 0) {
-                    m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-m_iMaxFilterLength/2, nRow, nCol);
+                int iFilterDelay = getCurrentOverlapAddDelay();
+                if(m_iCurrentSample-iFilterDelay >= 0) {
+                    m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_iCurrentSample-iFilterDelay, nRow, nCol);
                 }
                 else {
-                    if(m_iCurrentSample-m_iMaxFilterLength/2 < 0) {
+                    if(m_iCurrentSample-iFilterDelay < 0) {
                         m_matDataFiltered.block(0, 0, nRow, nCol) = m_matSparseSpharaMult * m_matDataFiltered.block(0, 0, nRow, nCol);
-                        int iResidual = m_iResidual+m_iMaxFilterLength/2;
+                        int iResidual = m_iResidual+iFilterDelay;
                         m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual) = m_matSparseSpharaMult * m_matDataFiltered.block(0, m_matDataFiltered.cols()-iResidual, nRow, iResidual);
                     }
                 }
@@ -883,13 +885,22 @@ void RtFiffRawViewModel::setFilter(QList<FilterKernel> filterData)
 {
     m_filterKernel = filterData;
 
+    //IIR kernels are run causally by biquad cascades. Their FIR approximation is much longer than their order and
+    //not linear phase, so it does not fit the overlap add below.
+    m_lFilterBiquads.clear();
     m_iMaxFilterLength = 1;
     for(int i=0; i<filterData.size(); ++i) {
-        if(m_iMaxFilterLength<filterData.at(i).getFilterOrder()) {
+        if(filterData.at(i).isIir()) {
+            m_lFilterBiquads.append(FilterBiquad(filterData.at(i), m_pFiffInfo->chs.size()));
+        } else if(m_iMaxFilterLength<filterData.at(i).getFilterOrder()) {
             m_iMaxFilterLength = filterData.at(i).getFilterOrder();
         }
     }
 
+    if(!m_lFilterBiquads.isEmpty() && m_lFilterBiquads.size() != filterData.size()) {
+        qWarning() << "[RtFiffRawViewModel::setFilter] FIR and IIR filters can not be combined. Only the IIR filters are applied.";
+    }
+
     m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
     m_matOverlap.setZero();
 
@@ -1110,6 +1121,32 @@ void RtFiffRawViewModel::filterDataBlock()
         return;
     }
 
+    //IIR filters run over the whole buffer in time order, i.e., from the oldest sample at the current position to the newest one before it
+    if(!m_lFilterBiquads.isEmpty()) {
+        MatrixXd matData(m_matDataRaw.rows(), m_matDataRaw.cols());
+        matData << m_matDataRaw.rightCols(m_matDataRaw.cols()-m_iCurrentSample), m_matDataRaw.leftCols(m_iCurrentSample);
+
+        for(int i = 0; i < m_lFilterBiquads.size(); ++i) {
+            m_lFilterBiquads[i].reset();
+            m_lFilterBiquads[i].filter(matData);
+        }
+
+        for(qint32 i = 0; i < m_matDataRaw.rows(); ++i) {
+            if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+                m_matDataFiltered.row(i).tail(m_matDataRaw.cols()-m_iCurrentSample) = matData.row(i).head(m_matDataRaw.cols()-m_iCurrentSample);
+                m_matDataFiltered.row(i).head(m_iCurrentSample) = matData.row(i).tail(m_iCurrentSample);
+            } else {
+                m_matDataFiltered.row(i) = m_matDataRaw.row(i);
+            }
+        }
+
+        if(!m_bIsFreezed) {
+            m_vecLastBlockFirstValuesFiltered = m_matDataFiltered.col(0);
+        }
+
+        return;
+    }
+
     //Create temporary filters with higher fft length because we are going to filter all available data at once for one time
     QList<FilterKernel> tempFilterList;
 
@@ -1176,6 +1213,11 @@ void RtFiffRawViewModel::filterDataBlock(const MatrixXd &data, int iDataIndex)
 {
     //std::cout<<"START RtFiffRawViewModel::filterDataBlock"<<std::endl;
 
+    if(!m_lFilterBiquads.isEmpty()) {
+        filterDataBlockCausal(data, iDataIndex);
+        return;
+    }
+
     if(iDataIndex >= m_matDataFiltered.cols() || data.cols() < m_iMaxFilterLength) {
         return;
     }
@@ -1288,6 +1330,35 @@ void RtFiffRawViewModel::filterDataBlock(const MatrixXd &data, int iDataIndex)
 
 //=============================================================================================================
 
+void RtFiffRawViewModel::filterDataBlockCausal(const MatrixXd &data, int iDataIndex)
+{
+    if(iDataIndex+data.cols() > m_matDataFiltered.cols()) {
+        return;
+    }
+
+    MatrixXd matFiltered = data;
+    for(int i = 0; i < m_lFilterBiquads.size(); ++i) {
+        if(!m_lFilterBiquads[i].filter(matFiltered)) {
+            return;
+        }
+    }
+
+    for(qint32 i = 0; i < data.rows(); ++i) {
+        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
+            m_matDataFiltered.row(i).segment(iDataIndex,data.cols()) = matFiltered.row(i);
+        } else {
+            m_matDataFiltered.row(i).segment(iDataIndex,data.cols()) = data.row(i);
+        }
+    }
+
+    //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
+    if(iDataIndex == 0 && m_iResidual > 0 && m_iResidual <= data.cols()) {
+        m_matDataFiltered.rightCols(m_iResidual) = m_matDataFiltered.leftCols(m_iResidual);
+    }
+}
+
+//=============================================================================================================
+
 void RtFiffRawViewModel::clearModel()
 {
     beginResetModel();
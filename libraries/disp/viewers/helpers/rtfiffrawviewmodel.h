@@ -46,6 +46,7 @@
 #include <fiff/fiff_proj.h>
 
 #include <rtprocessing/helpers/filterkernel.h>
+#include <rtprocessing/filter.h>
 
 //=============================================================================================================
 // QT INCLUDES
@@ -526,6 +527,16 @@ private:
      */
     void filterDataBlock(const Eigen::MatrixXd &data, int iDataIndex);
 
+    //=========================================================================================================
+    /**
+     * Calculates the filtered version of the raw input data with the causal IIR filters in m_lFilterBiquads. The
+     * filters keep their states from block to block, hence no overlap is needed and the result is not delayed.
+     *
+     * @param [in] data          data which is to be filtered
+     * @param [in] iDataIndex    current position in the global data matrix
+     */
+    void filterDataBlockCausal(const Eigen::MatrixXd &data, int iDataIndex);
+
     //=========================================================================================================
     /**
      * Clears the model
@@ -546,7 +557,7 @@ private:
     qint32                              m_iMaxSamples;                              /**< Max samples per window */
     qint32                              m_iCurrentSample;                           /**< Current sample which holds the current position in the data matrix */
     qint32                              m_iCurrentSampleFreeze;                     /**< Current sample which holds the current position in the data matrix when freezing tool is active */
-    qint32                              m_iMaxFilterLength;                         /**< Max order of the current filters */
+    qint32                              m_iMaxFilterLength;                         /**< Max order of the current FIR filters */
     qint32                              m_iCurrentBlockSize;                        /**< Current block size */
     qint32                              m_iResidual;                                /**< Current amount of samples which were to size */
     int                                 m_iCurrentTriggerChIndex;                   /**< The index of the current trigger channel */
@@ -596,6 +607,7 @@ private:
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTriggerOldFreeze;             /**< Old detected trigger for each trigger channel while display is freezed. */
     QMap<qint32,float>                  m_qMapChScaling;                            /**< Channel scaling map. */
     QList<RTPROCESSINGLIB::FilterKernel>m_filterKernel;                             /**< List of currently active filters. */
+    QList<RTPROCESSINGLIB::FilterBiquad>m_lFilterBiquads;                           /**< Causal filters of the active IIR kernels, empty if only FIR kernels are active. */
     QStringList                         m_filterChannelList;                        /**< List of channels which are to be filtered.*/
     QStringList                         m_visibleChannelList;                       /**< List of currently visible channels in the view.*/
     QMap<qint32,qint32>                 m_qMapIdxRowSelection;                      /**< Selection mapping.*/
@@ -644,7 +656,7 @@ inline qint32 RtFiffRawViewModel::getCurrentSampleIndex() const
     }
 
     if(!m_filterKernel.isEmpty() && m_bPerformFiltering) {
-        return m_iCurrentSample-m_iMaxFilterLength/2;
+        return m_iCurrentSample-getCurrentOverlapAddDelay();
     }
 
     return m_iCurrentSample;
@@ -775,7 +787,8 @@ inline bool RtFiffRawViewModel::triggerDetectionActive() const
 
 inline int RtFiffRawViewModel::getCurrentOverlapAddDelay() const
 {
-    if(!m_filterKernel.isEmpty())
+    //IIR filters run causally and are not delayed
+    if(!m_filterKernel.isEmpty() && m_lFilterBiquads.isEmpty())
         return m_iMaxFilterLength/2;
     else
         return 0;
@@ -56,6 +56,7 @@
 #include "fiff_info.h"
 #include "fiff_raw_data.h"
 #include "fiff_raw_dir.h"
+#include "fiff_raw_writer.h"
 #include "fiff_stream.h"
 #include "fiff_evoked_set.h"
 
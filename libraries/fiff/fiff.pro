@@ -40,7 +40,7 @@ TEMPLATE = lib
 
 CONFIG += skip_target_version_ext
 
-QT += network
+QT += network concurrent
 QT -= gui
 
 DESTDIR = $${MNE_LIBRARY_DIR}
@@ -78,6 +78,7 @@ SOURCES += fiff.cpp \
     fiff_proj.cpp \
     fiff_named_matrix.cpp \
     fiff_raw_data.cpp \
+    fiff_raw_writer.cpp \
     fiff_ctf_comp.cpp \
     fiff_id.cpp \
     fiff_info.cpp \
@@ -113,6 +114,7 @@ HEADERS += fiff.h \
     fiff_ctf_comp.h \
     fiff_info.h \
     fiff_raw_data.h \
+    fiff_raw_writer.h \
     fiff_dir_entry.h \
     fiff_raw_dir.h \
     fiff_dig_point.h \
@@ -42,6 +42,20 @@
 #include "fiff_tag.h"
 #include "fiff_stream.h"
 #include "cstdlib"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QDebug>
+#include <QFuture>
+#include <QThread>
+#include <QVector>
+#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -51,125 +65,238 @@ using namespace FIFFLIB;
 using namespace Eigen;
 
 //=============================================================================================================
-// DEFINE MEMBER METHODS
+// STATIC DEFINITIONS
 //=============================================================================================================
 
-FiffRawData::FiffRawData()
-: first_samp(-1)
-, last_samp(-1)
+/**
+ * Reads one sample of type S which is stored in big or little endian byte order.
+ */
+template<typename S>
+struct RawSampleReader
 {
-}
+    template<bool BIG_ENDIAN_DATA>
+    static inline S read(const char* pSrc)
+    {
+        return BIG_ENDIAN_DATA ? qFromBigEndian<S>(pSrc) : qFromLittleEndian<S>(pSrc);
+    }
+};
+
+template<>
+struct RawSampleReader<float>
+{
+    template<bool BIG_ENDIAN_DATA>
+    static inline float read(const char* pSrc)
+    {
+        quint32 iBits = RawSampleReader<quint32>::read<BIG_ENDIAN_DATA>(pSrc);
+        float fValue;
+        std::memcpy(&fValue, &iBits, sizeof(float));
+        return fValue;
+    }
+};
 
 //=============================================================================================================
 
-FiffRawData::FiffRawData(QIODevice &p_IODevice)
-: first_samp(-1)
-, last_samp(-1)
+/**
+ * Gathers the samples iFirstPick ... iFirstPick+iNumPicks-1 of the rows vecRows (all rows if empty) from a
+ * channels x samples raw data buffer, multiplies them by vecScale (no scaling if empty) and writes them to the
+ * column major output pOut.
+ */
+template<typename S, bool BIG_ENDIAN_DATA, typename T>
+static void gatherRawSamples(const char* pPayload,
+                             qint32 iNumChannels,
+                             qint32 iFirstPick,
+                             qint32 iNumPicks,
+                             const RowVectorXi& vecRows,
+                             const VectorXd& vecScale,
+                             T* pOut)
 {
-    //setup FiffRawData object
-    if(!FiffStream::setup_read_raw(p_IODevice, *this))
-    {
-        printf("\tError during fiff setup raw read.\n");
-        //exit(EXIT_FAILURE); //ToDo Throw here, e.g.: throw std::runtime_error("IO Error! File not found");
-        return;
+    const qint32 iNumRows = vecRows.size() > 0 ? vecRows.size() : iNumChannels;
+    const bool bScale = vecScale.size() == iNumRows;
+
+    for(qint32 c = 0; c < iNumPicks; ++c) {
+        const char* pColumn = pPayload + (qint64)(iFirstPick + c) * iNumChannels * sizeof(S);
+        T* pOutColumn = pOut + (qint64)c * iNumRows;
+
+        for(qint32 r = 0; r < iNumRows; ++r) {
+            const qint32 iRow = vecRows.size() > 0 ? vecRows[r] : r;
+            const double dValue = RawSampleReader<S>::template read<BIG_ENDIAN_DATA>(pColumn + (qint64)iRow * sizeof(S));
+            pOutColumn[r] = static_cast<T>(bScale ? vecScale[r] * dValue : dValue);
+        }
     }
 }
 
 //=============================================================================================================
 
-FiffRawData::FiffRawData(QIODevice &p_IODevice, bool b_littleEndian)
-: first_samp(-1)
-, last_samp(-1)
+/**
+ * Decodes a raw data buffer of the given FIFF data type, see gatherRawSamples.
+ *
+ * @return true if succeeded, false if the buffer is missing or its data type is not supported
+ */
+template<typename T>
+static bool decodeRawBuffer(const char* pPayload,
+                            fiff_int_t iType,
+                            bool bBigEndian,
+                            qint32 iNumChannels,
+                            qint32 iFirstPick,
+                            qint32 iNumPicks,
+                            const RowVectorXi& vecRows,
+                            const VectorXd& vecScale,
+                            T* pOut)
 {
-    //setup FiffRawData object
-    if(!FiffStream::setup_read_raw(p_IODevice, *this, false, b_littleEndian))
-    {
-        printf("\tError during fiff setup raw read.\n");
-        //exit(EXIT_FAILURE); //ToDo Throw here, e.g.: throw std::runtime_error("IO Error! File not found");
-        return;
+    if(!pPayload) {
+        return false;
+    }
+
+    switch(iType) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            if(bBigEndian)
+                gatherRawSamples<qint16,true>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            else
+                gatherRawSamples<qint16,false>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            return true;
+        case FIFFT_INT:
+            if(bBigEndian)
+                gatherRawSamples<qint32,true>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            else
+                gatherRawSamples<qint32,false>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            return true;
+        case FIFFT_FLOAT:
+            if(bBigEndian)
+                gatherRawSamples<float,true>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            else
+                gatherRawSamples<float,false>(pPayload, iNumChannels, iFirstPick, iNumPicks, vecRows, vecScale, pOut);
+            return true;
+        default:
+            return false;
     }
 }
 
 //=============================================================================================================
 
-FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
-: file(p_FiffRawData.file)
-, info(p_FiffRawData.info)
-, first_samp(p_FiffRawData.first_samp)
-, last_samp(p_FiffRawData.last_samp)
-, cals(p_FiffRawData.cals)
-, rawdir(p_FiffRawData.rawdir)
-, proj(p_FiffRawData.proj)
-, comp(p_FiffRawData.comp)
+/**
+ * A raw data buffer which contributes to a requested segment.
+ */
+struct RawBufferPick
 {
-}
+    qint32 iRawDir;     /**< Index of the buffer in rawdir */
+    qint32 iFirstPick;  /**< First sample to pick from the buffer */
+    qint32 iNumPicks;   /**< Number of samples to pick */
+    qint32 iDest;       /**< First column of the output to write to */
+};
 
 //=============================================================================================================
 
-FiffRawData::~FiffRawData()
+/**
+ * Decodes the picked samples of the rows vecRows of a raw data buffer payload into their columns of data and applies
+ * the calibration (vecScale) or the multiplication matrix mult, whose columns correspond to vecRows.
+ *
+ * @return true if succeeded, false if the payload could not be decoded
+ */
+template<typename T>
+static bool decodeRawBufferPick(const char* pPayload,
+                                fiff_int_t iType,
+                                bool bBigEndian,
+                                qint32 nchan,
+                                const RawBufferPick& pick,
+                                const RowVectorXi& vecRows,
+                                const VectorXd& vecScale,
+                                const SparseMatrix<T>& mult,
+                                Matrix<T,Dynamic,Dynamic>& data)
 {
+    if (mult.cols() == 0)
+    {
+        return decodeRawBuffer(pPayload, iType, bBigEndian, nchan, pick.iFirstPick, pick.iNumPicks,
+                               vecRows, vecScale, data.data() + (qint64)pick.iDest * data.rows());
+    }
+
+    Matrix<T,Dynamic,Dynamic> matSamples(vecRows.size() > 0 ? vecRows.size() : nchan, pick.iNumPicks);
+    if (!decodeRawBuffer(pPayload, iType, bBigEndian, nchan, pick.iFirstPick, pick.iNumPicks,
+                         vecRows, vecScale, matSamples.data()))
+    {
+        return false;
+    }
+
+    data.middleCols(pick.iDest, pick.iNumPicks).noalias() = mult*matSamples;
+    return true;
 }
 
 //=============================================================================================================
 
-void FiffRawData::clear()
+/**
+ * Reads the payload of a raw data buffer without converting its byte order.
+ *
+ * @return the payload, empty if it could not be read
+ */
+static QByteArray readRawBufferPayload(FiffStream& stream,
+                                       const FiffDirEntry& ent)
 {
-    info.clear();
-    first_samp = -1;
-    last_samp = -1;
-    cals = RowVectorXd();
-    rawdir.clear();
-    proj = MatrixXd();
-    comp.clear();
+    QByteArray baPayload;
+
+    if (ent.size <= 0 || !stream.device()->seek(ent.pos + FIFFC_DATA_OFFSET))
+        return baPayload;
+
+    baPayload.resize(ent.size);
+    if (stream.readRawData(baPayload.data(), ent.size) != ent.size)
+        baPayload.clear();
+
+    return baPayload;
 }
 
 //=============================================================================================================
-#include <QElapsedTimer>
-#include <QDebug>
-bool FiffRawData::read_raw_segment(MatrixXd& data,
-                                   MatrixXd& times,
-                                   fiff_int_t from,
-                                   fiff_int_t to,
-                                   const RowVectorXi& sel,
-                                   bool do_debug) const
+
+/**
+ * Reads a raw data segment, see FiffRawData::read_raw_segment. If bCalibrate is false the samples are returned as
+ * stored in the file, i.e., without calibration, projection and compensation.
+ */
+template<typename Scalar>
+static bool readRawSegment(const FiffRawData& raw,
+                           Matrix<Scalar,Dynamic,Dynamic>& data,
+                           MatrixXd& times,
+                           SparseMatrix<double>& multSegment,
+                           fiff_int_t from,
+                           fiff_int_t to,
+                           const RowVectorXi& sel,
+                           bool do_debug,
+                           bool bCalibrate)
 {
     bool projAvailable = true;
 
-    if (this->proj.size() == 0) {
-        //qDebug() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
+    if (raw.proj.size() == 0) {
+        //qInfo() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
         projAvailable = false;
     }
 
     if(from == -1)
-        from = this->first_samp;
+        from = raw.first_samp;
     if(to == -1)
-        to = this->last_samp;
+        to = raw.last_samp;
     //
     //  Initial checks
     //
-    if(from < this->first_samp)
-        from = this->first_samp;
-    if(to > this->last_samp)
-        to = this->last_samp;
+    if(from < raw.first_samp)
+        from = raw.first_samp;
+    if(to > raw.last_samp)
+        to = raw.last_samp;
     //
     if(from > to)
     {
-        printf("No data in this range %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
+        printf("No data in this range %d ... %d  =  %9.3f ... %9.3f secs...\n", from, to, ((float)from)/raw.info.sfreq, ((float)to)/raw.info.sfreq);
         return false;
     }
-    //printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
+    //printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/raw.info.sfreq, ((float)to)/raw.info.sfreq);
     //
     //  Initialize the data and calibration vector
     //
-    qint32 nchan = this->info.nchan;
+    qint32 nchan = raw.info.nchan;
     qint32 dest  = 0;//1;
-    qint32 i, k, r;
+    qint32 i, k;
 
     typedef Eigen::Triplet<double> T;
     std::vector<T> tripletList;
     tripletList.reserve(nchan);
     for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+        tripletList.push_back(T(i, i, raw.cals[i]));
 
     SparseMatrix<double> cal(nchan, nchan);
     cal.setFromTriplets(tripletList.begin(), tripletList.end());
@@ -179,33 +306,33 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
     //
     if (sel.size() == 0)
     {
-        data = MatrixXd(nchan, to-from+1);
+        data.resize(nchan, to-from+1);
 //            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
+        if (projAvailable || raw.comp.kind != -1)
         {
             if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
+                mult_full = raw.comp.data->data*cal;
+            else if (raw.comp.kind == -1)
+                mult_full = raw.proj*cal;
             else
-                mult_full = this->proj*this->comp.data->data*cal;
+                mult_full = raw.proj*raw.comp.data->data*cal;
         }
     }
     else
     {
-        data = MatrixXd(sel.size(),to-from+1);
+        data.resize(sel.size(),to-from+1);
 //            data->setZero();
 
         MatrixXd selVect(sel.size(), nchan);
 
         selVect.setZero();
 
-        if (!projAvailable && this->comp.kind == -1)
+        if (!projAvailable && raw.comp.kind == -1)
         {
             tripletList.clear();
             tripletList.reserve(sel.size());
             for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
+                tripletList.push_back(T(i, i, raw.cals[sel[i]]));
             cal = SparseMatrix<double>(sel.size(), sel.size());
             cal.setFromTriplets(tripletList.begin(), tripletList.end());
         }
@@ -215,13 +342,13 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
             {
                 qDebug() << "This has to be debugged! #1";
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
+                    selVect.row(i) = raw.comp.data->data.block(sel[i],0,1,nchan);
                 mult_full = selVect*cal;
             }
-            else if (this->comp.kind == -1)
+            else if (raw.comp.kind == -1)
             {
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+                    selVect.row(i) = raw.proj.block(sel[i],0,1,nchan);
 
                 mult_full = selVect*cal;
             }
@@ -229,9 +356,9 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
             {
                 qDebug() << "This has to be debugged! #3";
                 for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+                    selVect.row(i) = raw.proj.block(sel[i],0,1,nchan);
 
-                mult_full = selVect*this->comp.data->data*cal;
+                mult_full = selVect*raw.comp.data->data*cal;
             }
         }
     }
@@ -251,121 +378,83 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
         mult.setFromTriplets(tripletList.begin(), tripletList.end());
 //    mult.makeCompressed();
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
+    //
+    //  Rows to gather and their scaling when the buffers are decoded directly into the output. Without a
+    //  multiplication matrix this is the calibration of the selected channels. Otherwise only the channels
+    //  which the (selected rows of the) projector and compensator actually mix are gathered unscaled and
+    //  handed to the correspondingly reduced multiplication matrix.
+    //
+    RowVectorXi vecRows;
+    VectorXd vecScale;
+    SparseMatrix<double> multPicked;
+    if (!bCalibrate)
     {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
+        vecRows = sel;
+    }
+    else if (mult.cols() == 0)
+    {
+        vecRows = sel;
+        vecScale = cal.diagonal();
+    }
+    else
+    {
+        QVector<qint32> vecUsedChannels;
+        for (k = 0; k < mult.outerSize(); ++k)
+            if (SparseMatrix<double>::InnerIterator(mult, k))
+                vecUsedChannels.append(k);
+
+        if (vecUsedChannels.size() == 0 || vecUsedChannels.size() == nchan)
+        {
+            multPicked = mult;
+        }
+        else
         {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+            vecRows.resize(vecUsedChannels.size());
+            tripletList.clear();
+            for (i = 0; i < vecUsedChannels.size(); ++i)
+            {
+                vecRows[i] = vecUsedChannels[i];
+                for (SparseMatrix<double>::InnerIterator it(mult, vecUsedChannels[i]); it; ++it)
+                    tripletList.push_back(T(it.row(), i, it.value()));
+            }
+
+            multPicked.resize(mult.rows(), vecUsedChannels.size());
+            multPicked.setFromTriplets(tripletList.begin(), tripletList.end());
         }
-        fid = this->file;
     }
-    else
+    SparseMatrix<Scalar> multData = multPicked.template cast<Scalar>();
+
+    //
+    //  Decode straight from the memory mapped file if there is one, see FiffStream::map_file
+    //
+    FiffStream::SPtr fid = raw.file;
+    bool bMapped = fid->is_mapped();
+    bool bBigEndian = fid->byteOrder() == QDataStream::BigEndian;
+
+    if (!bMapped && !fid->device()->isOpen())
     {
-        fid = this->file;
+        if (!fid->device()->open(QIODevice::ReadOnly))
+        {
+            printf("Cannot open file %s",raw.info.filename.toUtf8().constData());
+        }
     }
 
-    MatrixXd one, newData, tmp_data;
-    FiffRawDir thisRawDir;
-    FiffTag::SPtr t_pTag;
+    //
+    //  Collect the buffers which contribute to the segment and the columns of data they fill
+    //
+    QList<RawBufferPick> lPicks;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    //
+    //  Jump straight to the first buffer we need
+    //
+    for(k = raw.find_raw_buffer(from); k < raw.rawdir.size(); ++k)
     {
-        thisRawDir = this->rawdir[k];
+        const FiffRawDir& thisRawDir = raw.rawdir[k];
         //
         //  Do we need this buffer
         //
-        if (thisRawDir.last > from)
+        if (thisRawDir.last >= from)
         {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
-
-                one.setZero();
-            }
-            else
-            {
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known yet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        newData.resize(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known yet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
             //
             //  The picking logic is a bit complicated
             //
@@ -426,10 +515,12 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
 
             if (picksamp > 0)
             {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                RawBufferPick pick;
+                pick.iRawDir    = k;
+                pick.iFirstPick = first_pick;
+                pick.iNumPicks  = picksamp;
+                pick.iDest      = dest;
+                lPicks.append(pick);
 
                 dest += picksamp;
             }
@@ -444,354 +535,257 @@ bool FiffRawData::read_raw_segment(MatrixXd& data,
         }
     }
 
-    if (!this->file->device()->isOpen()) {
-        this->file->device()->close();
-    }
-
-    times = MatrixXd(1, to-from+1);
-
-    for (i = 0; i < times.cols(); ++i)
-        times(0, i) = ((float)(from+i)) / this->info.sfreq;
-
-    return true;
-}
-
-//=============================================================================================================
-
-bool FiffRawData::read_raw_segment(MatrixXd& data,
-                                   MatrixXd& times,
-                                   SparseMatrix<double>& multSegment,
-                                   fiff_int_t from,
-                                   fiff_int_t to,
-                                   const RowVectorXi& sel,
-                                   bool do_debug) const
-{
-    bool projAvailable = true;
-
-    if (this->proj.size() == 0) {
-        //qInfo() << "FiffRawData::read_raw_segment - No projectors setup. Consider calling MNE::setup_compensators.";
-        projAvailable = false;
-    }
-
-    if(from == -1)
-        from = this->first_samp;
-    if(to == -1)
-        to = this->last_samp;
-    //
-    //  Initial checks
-    //
-    if(from < this->first_samp)
-        from = this->first_samp;
-    if(to > this->last_samp)
-        to = this->last_samp;
-    //
-    if(from > to)
-    {
-        printf("No data in this range\n");
-        return false;
-    }
-    //printf("Reading %d ... %d  =  %9.3f ... %9.3f secs...", from, to, ((float)from)/this->info.sfreq, ((float)to)/this->info.sfreq);
     //
-    //  Initialize the data and calibration vector
+    //  Every buffer writes to its own columns of data only. Hence, the buffers can be decoded and calibrated in parallel.
     //
-    qint32 nchan = this->info.nchan;
-    qint32 dest  = 0;//1;
-    qint32 i, k, r;
+    std::function<void(const RawBufferPick&, const QByteArray&)> decodePick = [&](const RawBufferPick& pick, const QByteArray& baPayload) {
+        const FiffRawDir& rawDir = raw.rawdir[pick.iRawDir];
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(nchan);
-    for(i = 0; i < nchan; ++i)
-        tripletList.push_back(T(i, i, this->cals[i]));
+        if (!rawDir.ent || rawDir.ent->kind == -1)
+        {
+            //
+            //  Take the easy route: skip is translated to zeros
+            //
+            if(do_debug)
+                printf("S");
+            data.middleCols(pick.iDest, pick.iNumPicks).setZero();
+            return;
+        }
 
-    SparseMatrix<double> cal(nchan, nchan);
-    cal.setFromTriplets(tripletList.begin(), tripletList.end());
-//    cal.makeCompressed();
+        const char* pPayload = bMapped ? fid->mapped_data(rawDir.ent->pos + FIFFC_DATA_OFFSET, rawDir.ent->size)
+                                       : (baPayload.size() == rawDir.ent->size ? baPayload.constData() : Q_NULLPTR);
 
-    MatrixXd mult_full;
-    //
-    if (sel.size() == 0)
-    {
-        data = MatrixXd(nchan, to-from+1);
-//            data->setZero();
-        if (projAvailable || this->comp.kind != -1)
+        if (!decodeRawBufferPick(pPayload, rawDir.ent->type, bBigEndian, nchan, pick, vecRows, vecScale, multData, data))
         {
-            if (!projAvailable)
-                mult_full = this->comp.data->data*cal;
-            else if (this->comp.kind == -1)
-                mult_full = this->proj*cal;
-            else
-                mult_full = this->proj*this->comp.data->data*cal;
+            printf("Data buffer %d could not be decoded!! Type: %d\n", pick.iRawDir, rawDir.ent->type);
+            data.middleCols(pick.iDest, pick.iNumPicks).setZero();
         }
+    };
+
+    if (bMapped)
+    {
+        std::function<void(const RawBufferPick&)> decodeMappedPick = [&](const RawBufferPick& pick) {
+            decodePick(pick, QByteArray());
+        };
+
+        if (lPicks.size() > 1)
+            QtConcurrent::blockingMap(lPicks, decodeMappedPick);
+        else if (lPicks.size() == 1)
+            decodeMappedPick(lPicks.first());
     }
     else
     {
-        data = MatrixXd(sel.size(),to-from+1);
-//            data->setZero();
+        //
+        //  Read the buffers on this thread and overlap reading with decoding. Bound the number of buffers in flight.
+        //  The payloads are kept in file byte order, the decoding takes care of the swapping.
+        //
+        const int iMaxPending = qMax(1, QThread::idealThreadCount());
+        QList<QFuture<void> > lPending;
 
-        MatrixXd selVect(sel.size(), nchan);
+        for(i = 0; i < lPicks.size(); ++i)
+        {
+            const FiffRawDir& rawDir = raw.rawdir[lPicks[i].iRawDir];
 
-        selVect.setZero();
+            QByteArray baPayload;
+            if (rawDir.ent && rawDir.ent->kind != -1)
+                baPayload = readRawBufferPayload(*fid, *rawDir.ent);
 
-        if (!projAvailable && this->comp.kind == -1)
-        {
-            tripletList.clear();
-            tripletList.reserve(sel.size());
-            for(i = 0; i < sel.size(); ++i)
-                tripletList.push_back(T(i, i, this->cals[sel[i]]));
-            cal = SparseMatrix<double>(sel.size(), sel.size());
-            cal.setFromTriplets(tripletList.begin(), tripletList.end());
-        }
-        else
-        {
-            if (!projAvailable)
+            if (lPicks.size() == 1)
             {
-                qDebug() << "This has to be debugged! #1";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->comp.data->data.block(sel[i],0,1,nchan);
-                mult_full = selVect*cal;
-            }
-            else if (this->comp.kind == -1)
-            {
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
-
-                mult_full = selVect*cal;
+                decodePick(lPicks[i], baPayload);
             }
             else
             {
-                qDebug() << "This has to be debugged! #3";
-                for( i = 0; i  < sel.size(); ++i)
-                    selVect.row(i) = this->proj.block(sel[i],0,1,nchan);
+                if (lPending.size() >= iMaxPending)
+                    lPending.takeFirst().waitForFinished();
 
-                mult_full = selVect*this->comp.data->data*cal;
+                lPending.append(QtConcurrent::run(decodePick, lPicks[i], baPayload));
             }
         }
+
+        for(i = 0; i < lPending.size(); ++i)
+            lPending[i].waitForFinished();
     }
 
-    //
-    // Make mult sparse
-    //
-    tripletList.clear();
-    tripletList.reserve(mult_full.rows()*mult_full.cols());
-    for(i = 0; i < mult_full.rows(); ++i)
-        for(k = 0; k < mult_full.cols(); ++k)
-            if(mult_full(i,k) != 0)
-                tripletList.push_back(T(i, k, mult_full(i,k)));
+    if(mult.cols()==0)
+        multSegment = cal;
+    else
+        multSegment = mult;
 
-    SparseMatrix<double> mult(mult_full.rows(),mult_full.cols());
-    if(tripletList.size() > 0)
-        mult.setFromTriplets(tripletList.begin(), tripletList.end());
-//    mult.makeCompressed();
+    if (!raw.file->device()->isOpen()) {
+        raw.file->device()->close();
+    }
 
-    //
+    times = MatrixXd(1, to-from+1);
+
+    for (i = 0; i < times.cols(); ++i)
+        times(0, i) = ((float)(from+i)) / raw.info.sfreq;
+
+    return true;
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawData::FiffRawData()
+: first_samp(-1)
+, last_samp(-1)
+{
+}
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
+//=============================================================================================================
+
+FiffRawData::FiffRawData(QIODevice &p_IODevice)
+: first_samp(-1)
+, last_samp(-1)
+{
+    //setup FiffRawData object
+    if(!FiffStream::setup_read_raw(p_IODevice, *this))
     {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
-        {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
-        }
-        fid = this->file;
+        printf("\tError during fiff setup raw read.\n");
+        //exit(EXIT_FAILURE); //ToDo Throw here, e.g.: throw std::runtime_error("IO Error! File not found");
+        return;
     }
-    else
+}
+
+//=============================================================================================================
+
+FiffRawData::FiffRawData(QIODevice &p_IODevice, bool b_littleEndian)
+: first_samp(-1)
+, last_samp(-1)
+{
+    //setup FiffRawData object
+    if(!FiffStream::setup_read_raw(p_IODevice, *this, false, b_littleEndian))
     {
-        fid = this->file;
+        printf("\tError during fiff setup raw read.\n");
+        //exit(EXIT_FAILURE); //ToDo Throw here, e.g.: throw std::runtime_error("IO Error! File not found");
+        return;
     }
+}
 
-    MatrixXd one;
-    fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
-    {
-        FiffRawDir thisRawDir = this->rawdir[k];
-        //
-        //  Do we need this buffer
-        //
-        if (thisRawDir.last > from)
-        {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
+//=============================================================================================================
 
-                one.setZero();
-            }
-            else
-            {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_SHORT)
-                            one = cal*(Map< MatrixShort >( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known yet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_SHORT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixShort > ( t_pTag->toShort(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known yet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known yet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
-            //
-            //  The picking logic is a bit complicated
-            //
-            if (to >= thisRawDir.last && from <= thisRawDir.first)
-            {
-                //
-                //  We need the whole buffer
-                //
-                first_pick = 0;//1;
-                last_pick  = thisRawDir.nsamp - 1;
-                if (do_debug)
-                    printf("W");
-            }
-            else if (from > thisRawDir.first)
-            {
-                first_pick = from - thisRawDir.first;// + 1;
-                if(to < thisRawDir.last)
-                {
-                    //
-                    //  Something from the middle
-                    //
-//                    qDebug() << "This needs to be debugged!";
-                    last_pick = thisRawDir.nsamp + to - thisRawDir.last - 1;//is this alright?
-                    if (do_debug)
-                        printf("M");
-                }
-                else
-                {
-                    //
-                    //  From the middle to the end
-                    //
-                    last_pick = thisRawDir.nsamp - 1;
-                    if (do_debug)
-                        printf("E");
-                }
-            }
-            else
-            {
-                //
-                //  From the beginning to the middle
-                //
-                first_pick = 0;//1;
-                last_pick  = to - thisRawDir.first;// + 1;
-                if (do_debug)
-                    printf("B");
-            }
-            //
-            //  Now we are ready to pick
-            //
-            picksamp = last_pick - first_pick + 1;
+FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
+: file(p_FiffRawData.file)
+, info(p_FiffRawData.info)
+, first_samp(p_FiffRawData.first_samp)
+, last_samp(p_FiffRawData.last_samp)
+, cals(p_FiffRawData.cals)
+, rawdir(p_FiffRawData.rawdir)
+, proj(p_FiffRawData.proj)
+, comp(p_FiffRawData.comp)
+{
+}
 
-            if(do_debug)
-            {
-                qDebug() << "first_pick: " << first_pick;
-                qDebug() << "last_pick: " << last_pick;
-                qDebug() << "picksamp: " << picksamp;
-            }
+//=============================================================================================================
 
-            if (picksamp > 0)
-            {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+FiffRawData::~FiffRawData()
+{
+}
 
-                dest += picksamp;
-            }
-        }
-        //
-        //  Done?
-        //
-        if (thisRawDir.last >= to)
+//=============================================================================================================
+
+void FiffRawData::clear()
+{
+    info.clear();
+    first_samp = -1;
+    last_samp = -1;
+    cals = RowVectorXd();
+    rawdir.clear();
+    proj = MatrixXd();
+    comp.clear();
+}
+
+//=============================================================================================================
+
+qint32 FiffRawData::find_raw_buffer(fiff_int_t samp) const
+{
+    QList<FiffRawDir>::const_iterator it = std::lower_bound(this->rawdir.constBegin(),
+                                                            this->rawdir.constEnd(),
+                                                            samp,
+                                                            [](const FiffRawDir& rawDir, fiff_int_t s) {
+                                                                return rawDir.last < s;
+                                                            });
+
+    return static_cast<qint32>(it - this->rawdir.constBegin());
+}
+
+//=============================================================================================================
+
+bool FiffRawData::read_raw_segment(MatrixXd& data,
+                                   MatrixXd& times,
+                                   fiff_int_t from,
+                                   fiff_int_t to,
+                                   const RowVectorXi& sel,
+                                   bool do_debug) const
+{
+    SparseMatrix<double> multSegment;
+    return read_raw_segment(data, times, multSegment, from, to, sel, do_debug);
+}
+
+//=============================================================================================================
+
+bool FiffRawData::read_raw_segment(MatrixXd& data,
+                                   MatrixXd& times,
+                                   SparseMatrix<double>& multSegment,
+                                   fiff_int_t from,
+                                   fiff_int_t to,
+                                   const RowVectorXi& sel,
+                                   bool do_debug) const
+{
+    return readRawSegment(*this, data, times, multSegment, from, to, sel, do_debug, true);
+}
+
+//=============================================================================================================
+
+bool FiffRawData::read_raw_segment(MatrixXf& data,
+                                   MatrixXd& times,
+                                   fiff_int_t from,
+                                   fiff_int_t to,
+                                   const RowVectorXi& sel,
+                                   bool do_debug) const
+{
+    SparseMatrix<double> multSegment;
+    return readRawSegment(*this, data, times, multSegment, from, to, sel, do_debug, true);
+}
+
+//=============================================================================================================
+
+bool FiffRawData::read_raw_segment_uncalibrated(MatrixXi& data,
+                                                RowVectorXd& calsSegment,
+                                                MatrixXd& times,
+                                                fiff_int_t from,
+                                                fiff_int_t to,
+                                                const RowVectorXi& sel) const
+{
+    //
+    //  Float buffers have no integer representation
+    //
+    fiff_int_t last = to == -1 || to > this->last_samp ? this->last_samp : to;
+    for(qint32 k = find_raw_buffer(from == -1 ? this->first_samp : from); k < this->rawdir.size() && this->rawdir[k].first <= last; ++k)
+    {
+        if (this->rawdir[k].ent && this->rawdir[k].ent->type == FIFFT_FLOAT)
         {
-            //printf(" [done]\n");
-            break;
+            qWarning("FiffRawData::read_raw_segment_uncalibrated - The data is stored as float, use read_raw_segment instead.");
+            return false;
         }
     }
 
-    if(mult.cols()==0)
-        multSegment = cal;
-    else
-        multSegment = mult;
+    SparseMatrix<double> multSegment;
+    if (!readRawSegment(*this, data, times, multSegment, from, to, sel, false, false))
+        return false;
 
-    if (!this->file->device()->isOpen()) {
-        this->file->device()->close();
+    if (sel.size() == 0)
+    {
+        calsSegment = this->cals;
+    }
+    else
+    {
+        calsSegment.resize(sel.size());
+        for(qint32 i = 0; i < sel.size(); ++i)
+            calsSegment[i] = this->cals[sel[i]];
     }
-
-    times = MatrixXd(1, to-from+1);
-
-    for (i = 0; i < times.cols(); ++i)
-        times(0, i) = ((float)(from+i)) / this->info.sfreq;
 
     return true;
 }
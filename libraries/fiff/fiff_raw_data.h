@@ -128,11 +128,23 @@ public:
         return first_samp == -1 && info.isEmpty();
     }
 
+    //=========================================================================================================
+    /**
+     * Looks up the raw directory entry which holds the given sample. Since rawdir is sorted by sample numbers this
+     * is a binary search, i.e., the cost does not depend on the position within the recording.
+     *
+     * @param[in] samp       the sample to look for
+     *
+     * @return the index of the first raw directory entry which ends at or after samp, rawdir.size() if there is none
+     */
+    qint32 find_raw_buffer(fiff_int_t samp) const;
+
     //=========================================================================================================
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
      *
-     * Read a specific raw data segment
+     * Read a specific raw data segment. If the file was mapped into memory (see FiffStream::map_file) the samples
+     * are decoded directly from the mapping into data.
      *
      * @param[out] data      returns the data matrix (channels x samples)
      * @param[out] times     returns the time values corresponding to the samples
@@ -153,7 +165,8 @@ public:
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
      *
-     * Read a specific raw data segment
+     * Read a specific raw data segment. If the file was mapped into memory (see FiffStream::map_file) the samples
+     * are decoded directly from the mapping into data.
      *
      * @param[out] data      returns the data matrix (channels x samples)
      * @param[out] times     returns the time values corresponding to the samples
@@ -172,6 +185,50 @@ public:
                           const Eigen::RowVectorXi& sel = defaultRowVectorXi,
                           bool do_debug = false) const;
 
+    //=========================================================================================================
+    /**
+     * Read a specific raw data segment in single precision. Compensation, projection and calibration are applied
+     * exactly as in the double precision version, but the samples are decoded and multiplied in float, which
+     * halves the memory footprint of long segments.
+     *
+     * @param[out] data      returns the data matrix (channels x samples)
+     * @param[out] times     returns the time values corresponding to the samples
+     * @param[in] from       first sample to include. If omitted, defaults to the first sample in data (optional)
+     * @param[in] to         last sample to include. If omitted, defaults to the last sample in data (optional)
+     * @param[in] sel        channel selection vector (optional)
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool read_raw_segment(Eigen::MatrixXf& data,
+                          Eigen::MatrixXd& times,
+                          fiff_int_t from = -1,
+                          fiff_int_t to = -1,
+                          const Eigen::RowVectorXi& sel = defaultRowVectorXi,
+                          bool do_debug = false) const;
+
+    //=========================================================================================================
+    /**
+     * Read a specific raw data segment as stored in the file, i.e. without compensation, projection and
+     * calibration. The calibration factors of the returned rows are handed out separately, so that
+     * data.cast<double>() scaled row-wise by calsSegment equals the uncompensated, unprojected physical data.
+     * Only integer-typed raw buffers (FIFFT_DAU_PACK16, FIFFT_SHORT, FIFFT_INT) can be read this way.
+     *
+     * @param[out] data          returns the integer data matrix (channels x samples)
+     * @param[out] calsSegment   returns the calibration factors of the rows in data
+     * @param[out] times         returns the time values corresponding to the samples
+     * @param[in] from           first sample to include. If omitted, defaults to the first sample in data (optional)
+     * @param[in] to             last sample to include. If omitted, defaults to the last sample in data (optional)
+     * @param[in] sel            channel selection vector (optional)
+     *
+     * @return true if succeeded, false otherwise (e.g. if the segment contains float buffers)
+     */
+    bool read_raw_segment_uncalibrated(Eigen::MatrixXi& data,
+                                       Eigen::RowVectorXd& calsSegment,
+                                       Eigen::MatrixXd& times,
+                                       fiff_int_t from = -1,
+                                       fiff_int_t to = -1,
+                                       const Eigen::RowVectorXi& sel = defaultRowVectorXi) const;
+
     //=========================================================================================================
     /**
      * ### MNE toolbox root function ###: Definition of the fiff_read_raw_segment function
@@ -0,0 +1,395 @@
+//=============================================================================================================
+/**
+ * @file     fiff_raw_writer.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Definition of the FiffRawWriter Class.
+ *
+ */
+
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_writer.h"
+#include "fiff_constants.h"
+#include "fiff_file.h"
+
+#include <climits>
+#include <cstring>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+#include <QDebug>
+#include <QElapsedTimer>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+/**
+ * Stores a 32 bit value in the byte order of the stream.
+ */
+static inline void putRawValue(quint32 iValue, bool bBigEndian, char* pDest)
+{
+    if(bBigEndian) {
+        qToBigEndian<quint32>(iValue, pDest);
+    } else {
+        qToLittleEndian<quint32>(iValue, pDest);
+    }
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawWriter::FiffRawWriter(FiffStream::SPtr pStream,
+                             const RowVectorXd& cals,
+                             qint32 iMaxQueuedBuffers,
+                             QObject *parent)
+: QThread(parent)
+, m_pStream(pStream)
+, m_iMaxQueuedBuffers(qMax(1, iMaxQueuedBuffers))
+, m_iNumDroppedSamples(0)
+, m_iNumInFlight(0)
+, m_bStopRequested(false)
+{
+    if(cals.size() > 0) {
+        m_vecInvCals = cals.cwiseInverse();
+    }
+
+    std::memset(&m_statistics, 0, sizeof(Statistics));
+}
+
+//=============================================================================================================
+
+FiffRawWriter::~FiffRawWriter()
+{
+    stop();
+}
+
+//=============================================================================================================
+
+bool FiffRawWriter::write_raw_buffer(const MatrixXd& buf,
+                                     qint32 iTimeoutMSecs)
+{
+    if(m_vecInvCals.size() > 0 && buf.rows() != m_vecInvCals.size()) {
+        qWarning("[FiffRawWriter::write_raw_buffer] buffer and calibration sizes do not match\n");
+        return false;
+    }
+
+    if(!isRunning()) {
+        // Nobody would ever empty the queue, write on the calling thread instead
+        QList<RawBuffer> lBuffers;
+        m_mutex.lock();
+        lBuffers.append(takePendingSkip(buf));
+        m_mutex.unlock();
+
+        qint64 iNumBytes = writeBuffers(lBuffers);
+
+        QMutexLocker locker(&m_mutex);
+        recordBatch(lBuffers, iNumBytes);
+        return iNumBytes >= 0;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    if(m_queueBuffers.size() >= m_iMaxQueuedBuffers) {
+        if(iTimeoutMSecs == 0) {
+            ++m_statistics.iNumDroppedBuffers;
+            m_iNumDroppedSamples += buf.cols();
+            return false;
+        }
+
+        ++m_statistics.iNumBlockedCalls;
+
+        QElapsedTimer timer;
+        timer.start();
+
+        while(m_queueBuffers.size() >= m_iMaxQueuedBuffers) {
+            unsigned long iWait = ULONG_MAX;
+            if(iTimeoutMSecs > 0) {
+                if(timer.elapsed() >= iTimeoutMSecs) {
+                    break;
+                }
+                iWait = iTimeoutMSecs - timer.elapsed();
+            }
+            m_condNotFull.wait(&m_mutex, iWait);
+        }
+
+        m_statistics.iBlockedMSecs += timer.elapsed();
+
+        if(m_queueBuffers.size() >= m_iMaxQueuedBuffers) {
+            ++m_statistics.iNumDroppedBuffers;
+            m_iNumDroppedSamples += buf.cols();
+            return false;
+        }
+    }
+
+    m_queueBuffers.enqueue(takePendingSkip(buf));
+
+    m_statistics.iQueueSize = m_queueBuffers.size();
+    m_statistics.iMaxQueueSize = qMax(m_statistics.iMaxQueueSize, m_statistics.iQueueSize);
+
+    m_condNotEmpty.wakeOne();
+
+    return true;
+}
+
+//=============================================================================================================
+
+void FiffRawWriter::flush()
+{
+    if(!isRunning()) {
+        m_mutex.lock();
+        QList<RawBuffer> lBuffers;
+        while(!m_queueBuffers.isEmpty()) {
+            lBuffers.append(m_queueBuffers.dequeue());
+        }
+        m_statistics.iQueueSize = 0;
+        m_mutex.unlock();
+
+        if(!lBuffers.isEmpty()) {
+            qint64 iNumBytes = writeBuffers(lBuffers);
+
+            QMutexLocker locker(&m_mutex);
+            recordBatch(lBuffers, iNumBytes);
+            m_condNotFull.wakeAll();
+        }
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    while(!m_queueBuffers.isEmpty() || m_iNumInFlight > 0) {
+        m_condIdle.wait(&m_mutex);
+    }
+}
+
+//=============================================================================================================
+
+bool FiffRawWriter::start()
+{
+    if(!m_pStream) {
+        qWarning("[FiffRawWriter::start] No stream to write to.\n");
+        return false;
+    }
+
+    m_mutex.lock();
+    m_bStopRequested = false;
+    m_mutex.unlock();
+
+    QThread::start();
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FiffRawWriter::stop()
+{
+    m_mutex.lock();
+    m_bStopRequested = true;
+    m_condNotEmpty.wakeAll();
+    m_mutex.unlock();
+
+    wait();
+
+    // Write whatever was queued while the thread was not running
+    flush();
+
+    return !hasError();
+}
+
+//=============================================================================================================
+
+bool FiffRawWriter::hasError() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics.iNumFailedBuffers > 0;
+}
+
+//=============================================================================================================
+
+FiffRawWriter::Statistics FiffRawWriter::getStatistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_statistics;
+}
+
+//=============================================================================================================
+
+void FiffRawWriter::run()
+{
+    QList<RawBuffer> lBuffers;
+
+    while(true) {
+        m_mutex.lock();
+        while(m_queueBuffers.isEmpty() && !m_bStopRequested) {
+            m_condNotEmpty.wait(&m_mutex);
+        }
+
+        if(m_queueBuffers.isEmpty()) {
+            m_mutex.unlock();
+            break;
+        }
+
+        // Take everything which is queued, so a slow device gets larger writes instead of more of them
+        while(!m_queueBuffers.isEmpty()) {
+            lBuffers.append(m_queueBuffers.dequeue());
+        }
+        m_iNumInFlight = lBuffers.size();
+        m_statistics.iQueueSize = 0;
+        m_condNotFull.wakeAll();
+        m_mutex.unlock();
+
+        qint64 iNumBytes = writeBuffers(lBuffers);
+
+        m_mutex.lock();
+        recordBatch(lBuffers, iNumBytes);
+        m_iNumInFlight = 0;
+        m_condIdle.wakeAll();
+        m_mutex.unlock();
+
+        lBuffers.clear();
+    }
+}
+
+//=============================================================================================================
+
+FiffRawWriter::RawBuffer FiffRawWriter::takePendingSkip(const MatrixXd& buf)
+{
+    RawBuffer rawBuffer;
+    rawBuffer.matData = buf;
+    rawBuffer.iSkip = 0;
+
+    if(m_iNumDroppedSamples > 0 && buf.cols() > 0) {
+        // FIFF_DATA_SKIP counts buffers of the size of the buffer which follows it
+        rawBuffer.iSkip = qRound(double(m_iNumDroppedSamples) / double(buf.cols()));
+        if(qint64(rawBuffer.iSkip) * buf.cols() != m_iNumDroppedSamples) {
+            qWarning("[FiffRawWriter::takePendingSkip] %lld dropped samples are not a multiple of the buffer size %d, skipping %d buffers.\n",
+                     m_iNumDroppedSamples, int(buf.cols()), rawBuffer.iSkip);
+        }
+        m_iNumDroppedSamples = 0;
+    }
+
+    return rawBuffer;
+}
+
+//=============================================================================================================
+
+qint64 FiffRawWriter::writeBuffers(const QList<RawBuffer>& lBuffers)
+{
+    if(!m_pStream) {
+        return -1;
+    }
+
+    const bool bBigEndian = m_pStream->byteOrder() == QDataStream::BigEndian;
+    const bool bCalibrate = m_vecInvCals.size() > 0;
+
+    qint64 iTotalSize = 0;
+    for(int i = 0; i < lBuffers.size(); ++i) {
+        if(lBuffers[i].iSkip > 0) {
+            iTotalSize += FIFFC_DATA_OFFSET + 4;
+        }
+        iTotalSize += FIFFC_DATA_OFFSET + 4 * lBuffers[i].matData.size();
+    }
+
+    QByteArray baBatch;
+    baBatch.resize(iTotalSize);
+    char* pDest = baBatch.data();
+
+    for(int i = 0; i < lBuffers.size(); ++i) {
+        const MatrixXd& buf = lBuffers[i].matData;
+        const qint32 iDataSize = 4 * buf.size();
+
+        if(lBuffers[i].iSkip > 0) {
+            putRawValue(FIFF_DATA_SKIP, bBigEndian, pDest);
+            putRawValue(FIFFT_INT, bBigEndian, pDest + 4);
+            putRawValue(4, bBigEndian, pDest + 8);
+            putRawValue(FIFFV_NEXT_SEQ, bBigEndian, pDest + 12);
+            putRawValue(lBuffers[i].iSkip, bBigEndian, pDest + FIFFC_DATA_OFFSET);
+            pDest += FIFFC_DATA_OFFSET + 4;
+        }
+
+        putRawValue(FIFF_DATA_BUFFER, bBigEndian, pDest);
+        putRawValue(FIFFT_FLOAT, bBigEndian, pDest + 4);
+        putRawValue(iDataSize, bBigEndian, pDest + 8);
+        putRawValue(FIFFV_NEXT_SEQ, bBigEndian, pDest + 12);
+        pDest += FIFFC_DATA_OFFSET;
+
+        // Column major, i.e., all channels of one sample after each other
+        for(Eigen::Index c = 0; c < buf.cols(); ++c) {
+            for(Eigen::Index r = 0; r < buf.rows(); ++r) {
+                float fValue = bCalibrate ? float(buf(r,c) * m_vecInvCals[r]) : float(buf(r,c));
+                quint32 iValue;
+                std::memcpy(&iValue, &fValue, sizeof(float));
+                putRawValue(iValue, bBigEndian, pDest);
+                pDest += 4;
+            }
+        }
+    }
+
+    if(m_pStream->device()->write(baBatch) != baBatch.size()) {
+        qWarning("[FiffRawWriter::writeBuffers] Could not write %d raw buffers to the device.\n", lBuffers.size());
+        return -1;
+    }
+
+    return baBatch.size();
+}
+
+//=============================================================================================================
+
+void FiffRawWriter::recordBatch(const QList<RawBuffer>& lBuffers,
+                                qint64 iNumBytes)
+{
+    if(iNumBytes < 0) {
+        m_statistics.iNumFailedBuffers += lBuffers.size();
+        return;
+    }
+
+    for(int i = 0; i < lBuffers.size(); ++i) {
+        if(lBuffers[i].iSkip > 0) {
+            ++m_statistics.iNumSkipTags;
+        }
+    }
+
+    m_statistics.iNumWrittenBuffers += lBuffers.size();
+    m_statistics.iNumBatches += 1;
+    m_statistics.iNumBytes += iNumBytes;
+}
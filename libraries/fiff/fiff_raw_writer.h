@@ -0,0 +1,253 @@
+//=============================================================================================================
+/**
+ * @file     fiff_raw_writer.h
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    FiffRawWriter class declaration.
+ *
+ */
+
+#ifndef FIFF_RAW_WRITER_H
+#define FIFF_RAW_WRITER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_stream.h"
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QQueue>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+//=============================================================================================================
+/**
+ * Writes FIFF_DATA_BUFFER tags of a raw file started with FiffStream::start_writing_raw in a background thread.
+ * Buffers are queued by the caller and the writer thread does the calibration division, the float encoding and
+ * writes all queued buffers with a single device write. The queue is bounded; whether a full queue blocks the
+ * caller or drops the buffer is decided per call, and both cases are recorded in the statistics. Dropped buffers
+ * are recorded with a FIFF_DATA_SKIP tag in front of the next written buffer, so the samples after a drop keep
+ * their time in the file.
+ *
+ * The stream must not be written to by anyone else while the writer is running. Call flush() or stop() before
+ * writing other tags, e.g. FiffStream::finish_writing_raw.
+ *
+ * @brief Asynchronous raw buffer writer.
+ */
+class FIFFSHARED_EXPORT FiffRawWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    typedef QSharedPointer<FiffRawWriter> SPtr;             /**< Shared pointer type for FiffRawWriter. */
+    typedef QSharedPointer<const FiffRawWriter> ConstSPtr;  /**< Const shared pointer type for FiffRawWriter. */
+
+    //=========================================================================================================
+    /**
+     * Backpressure and throughput statistics of the writer.
+     */
+    struct Statistics {
+        qint64  iNumWrittenBuffers;     /**< Number of buffers written to the stream. */
+        qint64  iNumFailedBuffers;      /**< Number of buffers lost because the device write failed. */
+        qint64  iNumDroppedBuffers;     /**< Number of buffers dropped because the queue was full. */
+        qint64  iNumSkipTags;           /**< Number of FIFF_DATA_SKIP tags written for dropped buffers. */
+        qint64  iNumBlockedCalls;       /**< Number of write_raw_buffer calls which had to wait for free space. */
+        qint64  iBlockedMSecs;          /**< Accumulated time write_raw_buffer calls waited for free space. */
+        qint64  iNumBatches;            /**< Number of device writes, each holding one or more buffers. */
+        qint64  iNumBytes;              /**< Number of bytes written to the stream. */
+        qint32  iQueueSize;             /**< Current number of queued buffers. */
+        qint32  iMaxQueueSize;          /**< Highest number of queued buffers seen so far. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Constructs a raw writer for a stream started with FiffStream::start_writing_raw.
+     *
+     * @param[in] pStream            The stream to write the buffers to.
+     * @param[in] cals               Calibration factors the buffers are divided by. If empty, the buffers are
+     *                               written as they are (see FiffStream::write_raw_buffer(const Eigen::MatrixXd&)).
+     * @param[in] iMaxQueuedBuffers  Maximum number of buffers waiting to be written.
+     * @param[in] parent             Parent QObject (optional).
+     */
+    explicit FiffRawWriter(FiffStream::SPtr pStream,
+                           const Eigen::RowVectorXd& cals = Eigen::RowVectorXd(),
+                           qint32 iMaxQueuedBuffers = 40,
+                           QObject *parent = Q_NULLPTR);
+
+    //=========================================================================================================
+    /**
+     * Stops the writer thread after all queued buffers were written.
+     */
+    ~FiffRawWriter();
+
+    //=========================================================================================================
+    /**
+     * Queues a raw buffer for writing. The buffer is copied, the caller can reuse it right away. If the writer
+     * thread is not running, the buffer is written on the calling thread.
+     *
+     * @param[in] buf            The buffer to write (channels x samples).
+     * @param[in] iTimeoutMSecs  How long to wait for free space if the queue is full. -1 waits until space is
+     *                           available, 0 drops the buffer right away. Default is -1. The samples of dropped
+     *                           buffers are skipped with a FIFF_DATA_SKIP tag before the next queued buffer,
+     *                           counted in buffers of the size of that next buffer.
+     *
+     * @return true if the buffer was queued, false if it was dropped or does not match the calibration size.
+     */
+    bool write_raw_buffer(const Eigen::MatrixXd& buf,
+                          qint32 iTimeoutMSecs = -1);
+
+    //=========================================================================================================
+    /**
+     * Blocks until all queued buffers were written to the stream. If the writer thread is not running, the queued
+     * buffers are written on the calling thread.
+     */
+    void flush();
+
+    //=========================================================================================================
+    /**
+     * Starts the writer thread.
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool start();
+
+    //=========================================================================================================
+    /**
+     * Writes all queued buffers and stops the writer thread.
+     *
+     * @return true if all buffers were written, false if a device write failed
+     */
+    bool stop();
+
+    //=========================================================================================================
+    /**
+     * Returns whether a device write failed. The buffers of a failed write are counted in
+     * Statistics::iNumFailedBuffers and not in Statistics::iNumWrittenBuffers.
+     *
+     * @return true if at least one device write failed.
+     */
+    bool hasError() const;
+
+    //=========================================================================================================
+    /**
+     * Returns a snapshot of the writer statistics.
+     *
+     * @return the current statistics.
+     */
+    Statistics getStatistics() const;
+
+protected:
+    //=========================================================================================================
+    /**
+     * The writer loop. Takes all queued buffers at once, encodes them and writes them to the stream.
+     */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+     * A queued buffer together with the dropped buffers which have to be skipped in front of it.
+     */
+    struct RawBuffer {
+        Eigen::MatrixXd matData;        /**< The buffer (channels x samples). */
+        qint32          iSkip;          /**< Number of buffers to skip with a FIFF_DATA_SKIP tag, 0 for none. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Wraps a buffer for writing and takes the pending dropped samples into its skip count. The mutex has to be
+     * held by the caller.
+     *
+     * @param[in] buf    The buffer to write.
+     *
+     * @return the buffer with its skip count.
+     */
+    RawBuffer takePendingSkip(const Eigen::MatrixXd& buf);
+
+    //=========================================================================================================
+    /**
+     * Encodes the buffers to FIFF_DATA_BUFFER tags, preceded by a FIFF_DATA_SKIP tag where buffers were dropped,
+     * and writes them with a single device write.
+     *
+     * @param[in] lBuffers   The buffers to write.
+     *
+     * @return the number of written bytes, -1 if the device write failed.
+     */
+    qint64 writeBuffers(const QList<RawBuffer>& lBuffers);
+
+    //=========================================================================================================
+    /**
+     * Adds the outcome of a device write to the statistics. The mutex has to be held by the caller.
+     *
+     * @param[in] lBuffers       The buffers of the write.
+     * @param[in] iNumBytes      The return value of writeBuffers.
+     */
+    void recordBatch(const QList<RawBuffer>& lBuffers,
+                     qint64 iNumBytes);
+
+    FiffStream::SPtr            m_pStream;          /**< The stream to write to. */
+    Eigen::RowVectorXd          m_vecInvCals;       /**< Inverse calibration factors, empty if not calibrated. */
+    qint32                      m_iMaxQueuedBuffers;/**< Maximum number of queued buffers. */
+
+    mutable QMutex              m_mutex;            /**< Guards the queue, the flags and the statistics. */
+    QWaitCondition              m_condNotEmpty;     /**< Signaled when buffers were queued or a stop was requested. */
+    QWaitCondition              m_condNotFull;      /**< Signaled when the writer took buffers from the queue. */
+    QWaitCondition              m_condIdle;         /**< Signaled when the writer finished a batch. */
+    QQueue<RawBuffer>           m_queueBuffers;     /**< Buffers waiting to be written. */
+    qint64                      m_iNumDroppedSamples;/**< Samples dropped since the last queued buffer. */
+    qint32                      m_iNumInFlight;     /**< Buffers taken from the queue but not yet written. */
+    bool                        m_bStopRequested;   /**< Whether the writer thread should exit once the queue is empty. */
+
+    Statistics                  m_statistics;       /**< Backpressure and throughput statistics. */
+};
+} // NAMESPACE
+
+#endif // FIFF_RAW_WRITER_H
@@ -82,7 +82,14 @@
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <QTcpSocket>
 
 //=============================================================================================================
@@ -93,12 +100,120 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+bool FiffStream::m_bDirCacheEnabled = false;
+
+#define FIFF_DIR_CACHE_MAGIC    0x46444331  /**< "FDC1" */
+#define FIFF_DIR_CACHE_VERSION  1
+
+/**
+ * Writes a FiffId to the directory cache.
+ */
+static void writeCachedId(QDataStream& out, const FiffId& id)
+{
+    out << id.version << id.machid[0] << id.machid[1] << id.time.secs << id.time.usecs;
+}
+
+/**
+ * Reads a FiffId from the directory cache.
+ */
+static void readCachedId(QDataStream& in, FiffId& id)
+{
+    in >> id.version >> id.machid[0] >> id.machid[1] >> id.time.secs >> id.time.usecs;
+}
+
+/**
+ * Compares two file ids field by field.
+ */
+static bool isSameId(const FiffId& a, const FiffId& b)
+{
+    return a.version == b.version &&
+           a.machid[0] == b.machid[0] &&
+           a.machid[1] == b.machid[1] &&
+           a.time.secs == b.time.secs &&
+           a.time.usecs == b.time.usecs;
+}
+
+/**
+ * Writes a directory tree node and its children to the directory cache. Directory entries are stored as indices into
+ * the directory, which are looked up by their file position.
+ */
+static void writeCachedNode(QDataStream& out, const FiffDirNode& node, const QHash<fiff_int_t, qint32>& hashIndices)
+{
+    out << node.type;
+    writeCachedId(out, node.id);
+    writeCachedId(out, node.parent_id);
+    out << node.nent_tree;
+    out << (node.dir_tree.isEmpty() ? qint32(-1) : hashIndices.value(node.dir_tree.first()->pos, -1));
+
+    out << qint32(node.dir.size());
+    for(int i = 0; i < node.dir.size(); ++i) {
+        out << hashIndices.value(node.dir[i]->pos, -1);
+    }
+
+    out << qint32(node.children.size());
+    for(int i = 0; i < node.children.size(); ++i) {
+        writeCachedNode(out, *node.children[i], hashIndices);
+    }
+}
+
+/**
+ * Reads a directory tree node and its children from the directory cache.
+ */
+static FiffDirNode::SPtr readCachedNode(QDataStream& in, const QList<FiffDirEntry::SPtr>& dir, int iDepth = 0)
+{
+    FiffDirNode::SPtr node = FiffDirNode::SPtr(new FiffDirNode);
+    qint32 iDirTreeStart, iNumEntries, iIndex, iNumChildren;
+
+    in >> node->type;
+    readCachedId(in, node->id);
+    readCachedId(in, node->parent_id);
+    in >> node->nent_tree;
+    in >> iDirTreeStart;
+    if(in.status() != QDataStream::Ok || iDirTreeStart < 0 || iDirTreeStart >= dir.size()) {
+        return FiffDirNode::SPtr();
+    }
+    node->dir_tree = dir.mid(iDirTreeStart);
+
+    in >> iNumEntries;
+    if(in.status() != QDataStream::Ok || iNumEntries < 0 || iNumEntries > dir.size()) {
+        return FiffDirNode::SPtr();
+    }
+    for(qint32 i = 0; i < iNumEntries; ++i) {
+        in >> iIndex;
+        if(in.status() != QDataStream::Ok || iIndex < 0 || iIndex >= dir.size()) {
+            return FiffDirNode::SPtr();
+        }
+        node->dir.append(FiffDirEntry::SPtr(new FiffDirEntry(*dir[iIndex])));
+    }
+
+    in >> iNumChildren;
+    if(in.status() != QDataStream::Ok || iNumChildren < 0 || iNumChildren > dir.size() || iDepth > dir.size()) {
+        return FiffDirNode::SPtr();
+    }
+    for(qint32 i = 0; i < iNumChildren; ++i) {
+        FiffDirNode::SPtr child = readCachedNode(in, dir, iDepth + 1);
+        if(!child) {
+            return FiffDirNode::SPtr();
+        }
+        child->parent = node;
+        node->children.append(child);
+    }
+
+    return node;
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -110,6 +225,8 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 FiffStream::FiffStream(QByteArray * a,
                        QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_pMappedData(Q_NULLPTR)
+, m_iMappedSize(0)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -287,12 +404,23 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
         return false;
     }
 
+    qint32 dirpos = *t_pTag->toInt();
+
+    //
+    //   Use the cached directory tree if there is a matching one. Files with a directory pointer are cheap to
+    //   open anyway and never get a cache.
+    //
+    if (dirpos <= 0 && m_bDirCacheEnabled && this->read_dir_cache()) {
+        qInfo("Loaded tag directory for %s from cache.", t_sFileName.toUtf8().constData());
+        this->device()->seek(SEEK_SET);
+        return true;
+    }
+
     //
     //   Read or create the directory tree
     //
     qInfo("Creating tag directory for %s...", t_sFileName.toUtf8().constData());
     m_dir.clear();
-    qint32 dirpos = *t_pTag->toInt();
     /*
      * Do we have a directory or not?
      */
@@ -331,6 +459,12 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
     else
         this->m_dirtree->parent.clear();
 
+    //
+    //   Only a full scan is worth caching
+    //
+    if (dirpos <= 0 && m_bDirCacheEnabled)
+        this->write_dir_cache();
+
     //
     //   Back to the beginning
     //
@@ -350,6 +484,213 @@ bool FiffStream::close()
 
 //=============================================================================================================
 
+void FiffStream::setDirCacheEnabled(bool bEnabled)
+{
+    m_bDirCacheEnabled = bEnabled;
+}
+
+//=============================================================================================================
+
+bool FiffStream::isDirCacheEnabled()
+{
+    return m_bDirCacheEnabled;
+}
+
+//=============================================================================================================
+
+QString FiffStream::dirCacheFileName(const QString& sFileName)
+{
+    QString sCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if(sCacheDir.isEmpty()) {
+        return QString();
+    }
+
+    QByteArray baHash = QCryptographicHash::hash(QFileInfo(sFileName).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1);
+    return sCacheDir + "/fiff_dircache/" + QString::fromLatin1(baHash.toHex()) + ".dircache";
+}
+
+//=============================================================================================================
+
+bool FiffStream::read_dir_cache()
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile) {
+        return false;
+    }
+
+    QFileInfo t_fileInfo(*t_pFile);
+    QString t_sCacheName = dirCacheFileName(t_fileInfo.absoluteFilePath());
+    if(t_sCacheName.isEmpty()) {
+        return false;
+    }
+
+    QFile t_fileCache(t_sCacheName);
+    if(!t_fileCache.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&t_fileCache);
+    in.setByteOrder(QDataStream::BigEndian);
+
+    quint32 iMagic;
+    qint32 iVersion;
+    qint64 iSize, iModified;
+    FiffId t_id;
+    in >> iMagic >> iVersion >> iSize >> iModified;
+    readCachedId(in, t_id);
+
+    if(in.status() != QDataStream::Ok ||
+       iMagic != FIFF_DIR_CACHE_MAGIC ||
+       iVersion != FIFF_DIR_CACHE_VERSION ||
+       iSize != t_fileInfo.size() ||
+       iModified != t_fileInfo.lastModified().toMSecsSinceEpoch() ||
+       !isSameId(t_id, m_id)) {
+        return false;
+    }
+
+    qint32 iNumEntries;
+    in >> iNumEntries;
+    if(in.status() != QDataStream::Ok || iNumEntries <= 0 || qint64(iNumEntries) * FiffDirEntry::storageSize() > iSize) {
+        return false;
+    }
+
+    QList<FiffDirEntry::SPtr> t_dir;
+    t_dir.reserve(iNumEntries);
+    for(qint32 i = 0; i < iNumEntries; ++i) {
+        FiffDirEntry::SPtr t_pEntry(new FiffDirEntry);
+        in >> t_pEntry->kind >> t_pEntry->type >> t_pEntry->size >> t_pEntry->pos;
+        t_dir.append(t_pEntry);
+    }
+
+    if(in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    FiffDirNode::SPtr t_pDirTree = readCachedNode(in, t_dir);
+    if(!t_pDirTree || in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    m_dir = t_dir;
+    m_dirtree = t_pDirTree;
+    m_dirtree->parent.clear();
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FiffStream::write_dir_cache() const
+{
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile || !m_dirtree) {
+        return false;
+    }
+
+    QFileInfo t_fileInfo(*t_pFile);
+    QString t_sCacheName = dirCacheFileName(t_fileInfo.absoluteFilePath());
+    if(t_sCacheName.isEmpty() || !QDir().mkpath(QFileInfo(t_sCacheName).absolutePath())) {
+        return false;
+    }
+
+    QSaveFile t_fileCache(t_sCacheName);
+    if(!t_fileCache.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&t_fileCache);
+    out.setByteOrder(QDataStream::BigEndian);
+
+    out << quint32(FIFF_DIR_CACHE_MAGIC) << qint32(FIFF_DIR_CACHE_VERSION);
+    out << qint64(t_fileInfo.size()) << qint64(t_fileInfo.lastModified().toMSecsSinceEpoch());
+    writeCachedId(out, m_id);
+
+    QHash<fiff_int_t, qint32> hashIndices;
+    out << qint32(m_dir.size());
+    for(int i = 0; i < m_dir.size(); ++i) {
+        out << m_dir[i]->kind << m_dir[i]->type << m_dir[i]->size << m_dir[i]->pos;
+        if(!hashIndices.contains(m_dir[i]->pos)) {
+            hashIndices.insert(m_dir[i]->pos, i);
+        }
+    }
+
+    writeCachedNode(out, *m_dirtree, hashIndices);
+
+    if(out.status() != QDataStream::Ok) {
+        t_fileCache.cancelWriting();
+        return false;
+    }
+
+    return t_fileCache.commit();
+}
+
+//=============================================================================================================
+
+bool FiffStream::map_file()
+{
+    if(m_pMappedData) {
+        return true;
+    }
+
+    QFile* t_pFile = qobject_cast<QFile*>(this->device());
+    if(!t_pFile) {
+        qWarning("FiffStream::map_file - Only files can be mapped into memory.");
+        return false;
+    }
+
+    QSharedPointer<QFile> t_pMappedFile = QSharedPointer<QFile>::create(t_pFile->fileName());
+    if(!t_pMappedFile->open(QIODevice::ReadOnly)) {
+        qWarning("FiffStream::map_file - Cannot open %s", t_pFile->fileName().toUtf8().constData());
+        return false;
+    }
+
+    uchar* t_pData = t_pMappedFile->map(0, t_pMappedFile->size());
+    if(!t_pData) {
+        qWarning("FiffStream::map_file - Cannot map %s: %s", t_pFile->fileName().toUtf8().constData(), t_pMappedFile->errorString().toUtf8().constData());
+        return false;
+    }
+
+    m_pMappedFile = t_pMappedFile;
+    m_pMappedData = reinterpret_cast<const char*>(t_pData);
+    m_iMappedSize = t_pMappedFile->size();
+
+    return true;
+}
+
+//=============================================================================================================
+
+void FiffStream::unmap_file()
+{
+    if(m_pMappedFile) {
+        m_pMappedFile->unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_pMappedData)));
+        m_pMappedFile->close();
+    }
+
+    m_pMappedFile.clear();
+    m_pMappedData = Q_NULLPTR;
+    m_iMappedSize = 0;
+}
+
+//=============================================================================================================
+
+bool FiffStream::is_mapped() const
+{
+    return m_pMappedData != Q_NULLPTR;
+}
+
+//=============================================================================================================
+
+const char* FiffStream::mapped_data(fiff_long_t pos, fiff_long_t size) const
+{
+    if(!m_pMappedData || pos < 0 || size < 0 || pos + size > m_iMappedSize) {
+        return Q_NULLPTR;
+    }
+
+    return m_pMappedData + pos;
+}
+
+//=============================================================================================================
+
 FiffDirNode::SPtr FiffStream::make_subtree(QList<FiffDirEntry::SPtr> &dentry)
 {
     FiffDirNode::SPtr defaultNode;
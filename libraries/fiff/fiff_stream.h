@@ -67,6 +67,12 @@
 #include <QString>
 #include <QStringList>
 
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+class QFile;
+
 //=============================================================================================================
 // DEFINE NAMESPACE FIFFLIB
 //=============================================================================================================
@@ -248,6 +254,72 @@ public:
      */
     bool close();
 
+    //=========================================================================================================
+    /**
+     * Enables or disables the on-disk cache of the tag directory and the directory tree. If enabled, open() stores
+     * the directory of files without a directory pointer in the user's cache location, see dirCacheFileName, and
+     * loads it on the next open instead of scanning the tag headers. The cache is only used if the file size,
+     * modification time and file id still match. Disabled by default.
+     *
+     * @param[in] bEnabled   Whether to use the directory cache.
+     */
+    static void setDirCacheEnabled(bool bEnabled);
+
+    //=========================================================================================================
+    /**
+     * Returns whether the on-disk directory cache is enabled, see setDirCacheEnabled.
+     *
+     * @return true if the directory cache is used, false otherwise
+     */
+    static bool isDirCacheEnabled();
+
+    //=========================================================================================================
+    /**
+     * Returns the name of the directory cache of a file. The cache lives in the fiff_dircache folder of
+     * QStandardPaths::CacheLocation, named after a hash of the absolute file path, so read-only and shared data
+     * directories are never written to.
+     *
+     * @param[in] sFileName  The FIFF file.
+     *
+     * @return the cache file name, empty if there is no writable cache location.
+     */
+    static QString dirCacheFileName(const QString& sFileName);
+
+    //=========================================================================================================
+    /**
+     * Maps the file behind this stream into memory. The mapping uses its own read-only file handle, i.e., it stays
+     * valid when the stream device is closed and reopened. Only possible when the stream device is a QFile.
+     * Readers such as FiffRawData::read_raw_segment decode directly from the mapping once it is set up.
+     *
+     * @return true if the file is mapped, false otherwise
+     */
+    bool map_file();
+
+    //=========================================================================================================
+    /**
+     * Releases the memory mapping set up by map_file.
+     */
+    void unmap_file();
+
+    //=========================================================================================================
+    /**
+     * Returns whether the file behind this stream is mapped into memory.
+     *
+     * @return true if the file is mapped, false otherwise
+     */
+    bool is_mapped() const;
+
+    //=========================================================================================================
+    /**
+     * Returns a pointer into the memory mapped file. The data is in the byte order of the file, see byteOrder().
+     *
+     * @param[in] pos    The file position to point to
+     * @param[in] size   The number of bytes which have to be available starting at pos
+     *
+     * @return the pointer to the mapped data, NULL if the file is not mapped or the range is out of bounds
+     */
+    const char* mapped_data(fiff_long_t pos, fiff_long_t size) const;
+
     //=========================================================================================================
     /**
      * Create the directory tree structure
@@ -880,7 +952,26 @@ private:
      */
     QList<FiffDirEntry::SPtr> make_dir(bool *ok=Q_NULLPTR);
 
+    //=========================================================================================================
+    /**
+     * Loads the directory and the directory tree from the cache file, see setDirCacheEnabled. m_id has to be read
+     * from the file beforehand.
+     *
+     * @return true if a matching cache was found and loaded, false otherwise
+     */
+    bool read_dir_cache();
+
+    //=========================================================================================================
+    /**
+     * Stores the directory and the directory tree in the cache file, see setDirCacheEnabled.
+     *
+     * @return true if the cache was written, false otherwise
+     */
+    bool write_dir_cache() const;
+
 private:
+    static bool                 m_bDirCacheEnabled; /**< Whether open() uses the on-disk directory cache */
+
 
 //    char         *file_name;    /**< Name of the file */ -> Use streamName() instead
 //    FILE         *fd;           /**< The normal file descriptor */ -> file descitpion is part of the stream: stream->device()
@@ -888,6 +979,9 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries? */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree */
+    QSharedPointer<QFile>       m_pMappedFile;  /**< Separate file handle holding the memory mapping */
+    const char*                 m_pMappedData;  /**< The memory mapped file, NULL if not mapped */
+    fiff_long_t                 m_iMappedSize;  /**< Number of mapped bytes */
 //    char        *ext_file_name; /**< Name of the file holding the external data */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open  */
 
@@ -5,7 +5,11 @@
 #include "guess_data.h"
 
 #include <string.h>
+#include <functional>
 #include <QScopedPointer>
+#include <QAtomicInt>
+#include <QVector>
+#include <QtConcurrent>
 
 using namespace INVERSELIB;
 using namespace MNELIB;
@@ -181,6 +185,22 @@ static mneChSelection new_ch_selection()
     return newsel;
 }
 
+static void mne_ch_selection_free(mneChSelection s)
+
+{
+    if (!s)
+        return;
+    FREE(s->pick);
+    FREE(s->pick_deriv);
+    FREE(s->ch_kind);
+    s->name.clear();
+    s->chdef.clear();
+    s->chspick.clear();
+    s->chspick_nospace.clear();
+    FREE(s);
+    return;
+}
+
 mneChSelection mne_ch_selection_these(const QString& selname, const QStringList& names, int nch)
 /*
  * Give an explicit list of interesting channels
@@ -546,6 +566,110 @@ int mne_get_values_from_data_ch (float time,      /* Interesting time point */
     return (0);
 }
 
+//============================= fit_dipoles.c =============================
+
+static int count_fit_times(float tmin, float tmax, float tstep)
+/*
+ * How many time points does the loop over tmin + s*tstep < tmax visit?
+ */
+{
+    int s;
+    for (s = 0; tmin + s*tstep < tmax; s++)
+        ;
+    return s;
+}
+
+static int fit_dipoles_raw_steps(MneRawData*    raw,      /* The raw data description */
+                                 mneChSelection sel,      /* Channel selection to use */
+                                 DipoleFitData* fit,      /* Precomputed fitting data, used by this call only */
+                                 GuessData*     guess,    /* The initial guesses */
+                                 float          tmin,     /* Time of step zero */
+                                 float          tstep,    /* Time step to use */
+                                 float          integ,    /* Integration time */
+                                 int            first,    /* First step to fit */
+                                 int            last,     /* One past the last step to fit */
+                                 int            verbose,
+                                 int            report,   /* Print the dipoles and the progress as we go? */
+                                 ECDSet&        set)      /* Append the fitted dipoles here */
+/*
+ * Fit the time points tmin + s*tstep, first <= s < last, reading the raw data segment by segment
+ */
+{
+    float *one    = MALLOC(sel->nchan,float);
+    float sfreq   = raw->info->sfreq;
+    float myinteg = integ > 0.0 ? 2*integ : 0.1;
+    int   overlap = ceil(myinteg*sfreq);
+    int   length  = SEG_LEN*sfreq;
+    int   step    = length - overlap;
+    int   stepo   = step + overlap/2;
+    int   start   = raw->first_samp;
+    int   s,picks;
+    float time,stime;
+    float **data  = ALLOC_CMATRIX(sel->nchan,length);
+    ECD    dip;
+    int    report_interval = 10;
+
+    /*
+   * Load the data segment containing the first time point
+   */
+    if (first < last) {
+        time  = tmin + first*tstep;
+        picks = time*sfreq - start;
+        while (picks > stepo) {
+            start = start + step;
+            picks = time*sfreq - start;
+        }
+    }
+    stime = start/sfreq;
+    if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
+        goto bad;
+    for (s = first; s < last; s++) {
+        time  = tmin + s*tstep;
+        picks = time*sfreq - start;
+        if (picks > stepo) {		/* Need a new data segment? */
+            while (picks > stepo) {
+                start = start + step;
+                picks = time*sfreq - start;
+            }
+            if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
+                goto bad;
+            stime = start/sfreq;
+        }
+        /*
+     * Get the values
+     */
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+            fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
+            continue;
+        }
+        /*
+     * Fit
+     */
+        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
+            qWarning() << "Error";
+        else {
+            set.addEcd(dip);
+            if (report) {
+                if (verbose)
+                    dip.print(stdout);
+                else {
+                    if (set.size() % report_interval == 0)
+                        fprintf(stderr,"%d..",set.size());
+                }
+            }
+        }
+    }
+    FREE_CMATRIX(data);
+    FREE(one);
+    return OK;
+
+bad : {
+        FREE_CMATRIX(data);
+        FREE(one);
+        return FAIL;
+    }
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS
 //=============================================================================================================
@@ -561,39 +685,20 @@ ECDSet DipoleFit::calculateFit() const
 {
     QScopedPointer<GuessData>guess (Q_NULLPTR);
     ECDSet              set;
-    FwdEegSphereModel*  eeg_model = NULL;
     DipoleFitData*      fit_data = NULL;
     MneMeasData*        data     = NULL;
     MneRawData*         raw      = NULL;
     mneChSelection      sel      = NULL;
+    QList<DipoleFitData*> fits;
+    QList<MneRawData*>    raws;
+    QList<mneChSelection> sels;
+    int                 k;
 
     printf("---- Setting up...\n\n");
-    if (settings->include_eeg) {
-        if ((eeg_model = FwdEegSphereModel::setup_eeg_sphere_model(settings->eeg_model_file,settings->eeg_model_name,settings->eeg_sphere_rad)) == NULL)
-            goto out;
-    }
-
-    if ((fit_data = DipoleFitData::setup_dipole_fit_data(   settings->mriname,
-                                                            settings->measname,
-                                                            settings->bemname.isEmpty() ? NULL : settings->bemname.toUtf8().data(),
-                                                            &settings->r0,
-                                                            eeg_model,
-                                                            settings->accurate,
-                                                            settings->badname,
-                                                            settings->noisename,
-                                                            settings->grad_std,
-                                                            settings->mag_std,
-                                                            settings->eeg_std,
-                                                            settings->mag_reg,
-                                                            settings->grad_reg,
-                                                            settings->eeg_reg,
-                                                            settings->diagnoise,
-                                                            settings->projnames,
-                                                            settings->include_meg,
-                                                            settings->include_eeg)) == NULL)
+    if ((fit_data = setupFitData()) == NULL)
         goto out;
+    fits.append(fit_data);
 
-    fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
     if (settings->is_raw) {
         int c;
         float t1,t2;
@@ -612,6 +717,8 @@ ECDSet DipoleFit::calculateFit() const
                 goto out;
             }
         printf("\tChannel selection created.\n");
+        raws.append(raw);
+        sels.append(sel);
         /*
         * Let's be a little generous here
         */
@@ -666,26 +773,101 @@ ECDSet DipoleFit::calculateFit() const
     if (guess.isNull())
         goto out;
 
+    /*
+     * The forward clients keep scratch buffers and the raw data reader its file position,
+     * so every additional thread gets its own fitting data and raw data file
+     */
+    if (settings->nthreads > 1) {
+        printf("\n---- Setting up %d fitting threads...\n\n",settings->nthreads);
+        for (k = 1; k < settings->nthreads; k++) {
+            DipoleFitData* thread_fit;
+
+            if ((thread_fit = setupFitData()) == NULL)
+                goto out;
+            fits.append(thread_fit);
+            if (raw) {
+                MneRawData*    thread_raw;
+                mneChSelection thread_sel;
+
+                if ((thread_raw = MneRawData::mne_raw_open_file(settings->measname.isEmpty() ? NULL : settings->measname.toUtf8().data(),TRUE,FALSE,&(settings->filter))) == NULL)
+                    goto out;
+                raws.append(thread_raw);
+                thread_sel = mne_ch_selection_these("fit",thread_fit->ch_names,thread_fit->nmeg+thread_fit->neeg);
+                mne_ch_selection_assign_chs(thread_sel,thread_raw);
+                sels.append(thread_sel);
+            }
+            else if (!settings->noisename.isEmpty()) {
+                if (DipoleFitData::scale_noise_cov(thread_fit,data->current->nave) == FAIL)
+                    goto out;
+            }
+        }
+    }
+
     fprintf (stderr,"\n---- Fitting : %7.1f ... %7.1f ms (step: %6.1f ms integ: %6.1f ms)\n\n",
              1000*settings->tmin,1000*settings->tmax,1000*settings->tstep,1000*settings->integ);
 
     if (raw) {
-        if (fit_dipoles_raw(settings->measname,raw,sel,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose) == FAIL)
+        if (fit_dipoles_raw(settings->measname,raws,sels,fits,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
             goto out;
     }
     else {
-        if (fit_dipoles(settings->measname,data,fit_data,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
+        if (fit_dipoles(settings->measname,data,fits,guess.take(),settings->tmin,settings->tmax,settings->tstep,settings->integ,settings->verbose,set) == FAIL)
             goto out;
     }
     printf("%d dipoles fitted\n",set.size());
 
 out : {
+        /*
+         * Release what was set up for the additional threads
+         */
+        for (k = 1; k < fits.size(); k++)
+            delete fits[k];
+        for (k = 1; k < raws.size(); k++)
+            delete raws[k];
+        for (k = 1; k < sels.size(); k++)
+            mne_ch_selection_free(sels[k]);
         return set;
     }
 }
 
 //=============================================================================================================
 
+DipoleFitData* DipoleFit::setupFitData() const
+{
+    FwdEegSphereModel*  eeg_model = NULL;
+    DipoleFitData*      fit_data = NULL;
+
+    if (settings->include_eeg) {
+        if ((eeg_model = FwdEegSphereModel::setup_eeg_sphere_model(settings->eeg_model_file,settings->eeg_model_name,settings->eeg_sphere_rad)) == NULL)
+            return NULL;
+    }
+
+    if ((fit_data = DipoleFitData::setup_dipole_fit_data(   settings->mriname,
+                                                            settings->measname,
+                                                            settings->bemname.isEmpty() ? NULL : settings->bemname.toUtf8().data(),
+                                                            &settings->r0,
+                                                            eeg_model,
+                                                            settings->accurate,
+                                                            settings->badname,
+                                                            settings->noisename,
+                                                            settings->grad_std,
+                                                            settings->mag_std,
+                                                            settings->eeg_std,
+                                                            settings->mag_reg,
+                                                            settings->grad_reg,
+                                                            settings->eeg_reg,
+                                                            settings->diagnoise,
+                                                            settings->projnames,
+                                                            settings->include_meg,
+                                                            settings->include_eeg)) == NULL)
+        return NULL;
+
+    fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    return fit_data;
+}
+
+//=============================================================================================================
+
 int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
 {
     float *one = MALLOC(data->nchan,float);
@@ -729,75 +911,80 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 //=============================================================================================================
 
-int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, const QList<DipoleFitData*>& fits, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
 {
-    float *one    = MALLOC(sel->nchan,float);
-    float sfreq   = raw->info->sfreq;
-    float myinteg = integ > 0.0 ? 2*integ : 0.1;
-    int   overlap = ceil(myinteg*sfreq);
-    int   length  = SEG_LEN*sfreq;
-    int   step    = length - overlap;
-    int   stepo   = step + overlap/2;
-    int   start   = raw->first_samp;
-    int   s,picks;
-    float time,stime;
-    float **data  = ALLOC_CMATRIX(sel->nchan,length);
-    ECD    dip;
-    ECDSet set;
-    int    report_interval = 10;
+    if (fits.isEmpty())
+        return FAIL;
+    if (fits.size() == 1)
+        return fit_dipoles(dataname,data,fits.first(),guess,tmin,tmax,tstep,integ,verbose,p_set);
 
-    set.dataname = dataname;
+    int          nstep = count_fit_times(tmin,tmax,tstep);
+    QVector<ECD> dips(nstep);
+    QVector<int> fitted(nstep,FALSE);
+    QAtomicInt   next_step(0);
+    QList<int>   threads;
+    ECDSet       set;
+    int          s;
+
+    for (s = 0; s < fits.size(); s++)
+        threads.append(s);
 
     /*
-   * Load the initial data segment
+   * Each thread fits with its own data and takes the next unfitted time point when done,
+   * the results go to their slot so that the set stays in time order
    */
-    stime = start/sfreq;
-    if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
-        goto bad;
-    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
-    for (s = 0, time = tmin; time < tmax; s++, time = tmin  + s*tstep) {
-        picks = time*sfreq - start;
-        if (picks > stepo) {		/* Need a new data segment? */
-            start = start + step;
-            if (MneRawData::mne_raw_pick_data_filt(raw,sel,start,length,data) == FAIL)
-                goto bad;
-            picks = time*sfreq - start;
-            stime = start/sfreq;
-        }
-        /*
-     * Get the values
-     */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
-            fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
-            continue;
+    std::function<void(int&)> fitTimes = [&](int& thread) {
+        float *one = MALLOC(data->nchan,float);
+        float time;
+        int   step;
+
+        for (step = next_step.fetchAndAddRelaxed(1); step < nstep; step = next_step.fetchAndAddRelaxed(1)) {
+            time = tmin + step*tstep;
+            if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
+                                         1.0/data->current->tstep,FALSE,one) == FAIL) {
+                fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
+                continue;
+            }
+            if (!DipoleFitData::fit_one(fits[thread],guess,time,one,verbose,dips[step]))
+                printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
+            else
+                fitted[step] = TRUE;
         }
-        /*
-     * Fit
-     */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            qWarning() << "Error";
-        else {
-            set.addEcd(dip);
+        FREE(one);
+    };
+
+    fprintf(stderr,"Fitting with %d threads...%c",fits.size(),verbose ? '\n' : '\0');
+    QtConcurrent::blockingMap(threads, fitTimes);
+
+    set.dataname = dataname;
+    for (s = 0; s < nstep; s++) {
+        if (fitted[s]) {
+            set.addEcd(dips[s]);
             if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
+                dips[s].print(stdout);
         }
     }
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE_CMATRIX(data);
-    FREE(one);
     p_set = set;
     return OK;
+}
 
-bad : {
-        FREE_CMATRIX(data);
-        FREE(one);
+//=============================================================================================================
+
+int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+{
+    ECDSet set;
+
+    set.dataname = dataname;
+
+    fprintf(stderr,"Fitting...%c",verbose ? '\n' : '\0');
+    if (fit_dipoles_raw_steps(raw,sel,fit,guess,tmin,tstep,integ,0,count_fit_times(tmin,tmax,tstep),verbose,TRUE,set) == FAIL)
         return FAIL;
-    }
+    if (!verbose)
+        fprintf(stderr,"[done]\n");
+    p_set = set;
+    return OK;
 }
 
 //=============================================================================================================
@@ -807,3 +994,52 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     ECDSet set;
     return fit_dipoles_raw(dataname, raw, sel, fit, guess, tmin, tmax, tstep, integ, verbose, set);
 }
+
+//=============================================================================================================
+
+int DipoleFit::fit_dipoles_raw(const QString& dataname, const QList<MneRawData*>& raws, const QList<mneChSelection>& sels, const QList<DipoleFitData*>& fits, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
+{
+    if (fits.isEmpty() || raws.size() != fits.size() || sels.size() != fits.size())
+        return FAIL;
+    if (fits.size() == 1)
+        return fit_dipoles_raw(dataname,raws.first(),sels.first(),fits.first(),guess,tmin,tmax,tstep,integ,verbose,p_set);
+
+    int             nstep = count_fit_times(tmin,tmax,tstep);
+    int             nseg  = fits.size();
+    QVector<ECDSet> seg_sets(nseg);
+    QVector<int>    seg_status(nseg,OK);
+    QList<int>      segments;
+    ECDSet          set;
+    int             k,p;
+
+    for (k = 0; k < nseg; k++)
+        segments.append(k);
+
+    /*
+   * The raw data are read sequentially, so each thread fits one contiguous run of time points
+   */
+    std::function<void(int&)> fitSegment = [&](int& seg) {
+        int first = (qint64)seg*nstep/nseg;
+        int last  = (qint64)(seg+1)*nstep/nseg;
+
+        seg_status[seg] = fit_dipoles_raw_steps(raws[seg],sels[seg],fits[seg],guess,tmin,tstep,integ,first,last,verbose,FALSE,seg_sets[seg]);
+    };
+
+    fprintf(stderr,"Fitting %d segments in parallel...%c",nseg,verbose ? '\n' : '\0');
+    QtConcurrent::blockingMap(segments, fitSegment);
+
+    set.dataname = dataname;
+    for (k = 0; k < nseg; k++) {
+        if (seg_status[k] == FAIL)
+            return FAIL;
+        for (p = 0; p < seg_sets[k].size(); p++) {
+            set.addEcd(seg_sets[k][p]);
+            if (verbose)
+                seg_sets[k][p].print(stdout);
+        }
+    }
+    if (!verbose)
+        fprintf(stderr,"[done]\n");
+    p_set = set;
+    return OK;
+}
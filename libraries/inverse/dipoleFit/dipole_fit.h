@@ -54,6 +54,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
 
 //=============================================================================================================
 // DEFINE NAMESPACE INVERSELIB
@@ -117,6 +118,27 @@ public:
      */
     static int fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
 
+    //=========================================================================================================
+    /**
+     *
+     * Fit a single dipole to each time point of the data, using one thread per fitting data instance.
+     * The threads take the next unfitted time point when they are done, the set is returned in time order.
+     *
+     * @param[in] dataname
+     * @param[in] data       The measured data
+     * @param[in] fits       Precomputed fitting data, one independent instance per thread
+     * @param[in] guess      The initial guesses
+     * @param[in] tmin       Time range
+     * @param[in] tmax
+     * @param[in] tstep      Time step to use
+     * @param[in] integ      Integration time
+     * @param[in] verbose    Verbose output?
+     * @param[out] p_set     the fitted ECD Set
+     *
+     * @return true when successful
+     */
+    static int fit_dipoles( const QString& dataname, MneMeasData* data, const QList<DipoleFitData*>& fits, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+
     //=========================================================================================================
     /**
      *
@@ -160,7 +182,37 @@ public:
      */
     static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, MNELIB::mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
 
+    //=========================================================================================================
+    /**
+     *
+     * Fit a single dipole to each time point of the data, splitting the time range into one contiguous
+     * segment per thread. Every thread needs its own raw data file, channel selection and fitting data.
+     *
+     * @param[in] dataname
+     * @param[in] raws       The raw data descriptions, one per thread
+     * @param[in] sels       Channel selections to use, one per thread
+     * @param[in] fits       Precomputed fitting data, one per thread
+     * @param[in] guess      The initial guesses
+     * @param[in] tmin       Time range
+     * @param[in] tmax
+     * @param[in] tstep      Time step to use
+     * @param[in] integ      Integration time
+     * @param[in] verbose    Verbose output?
+     * @param[out] p_set     Return all results here in time order
+     *
+     * @return true when successful
+     */
+    static int fit_dipoles_raw(const QString& dataname, const QList<MNELIB::MneRawData*>& raws, const QList<MNELIB::mneChSelection>& sels, const QList<DipoleFitData*>& fits, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set);
+
 private:
+    //=========================================================================================================
+    /**
+     * Sets up an independent fitting data instance from the settings
+     *
+     * @return the fitting data, NULL on failure
+     */
+    DipoleFitData* setupFitData() const;
+
     DipoleFitSettings* settings;
 };
 
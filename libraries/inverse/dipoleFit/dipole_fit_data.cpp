@@ -4370,38 +4370,20 @@ static int find_best_guess(float     *B,         /* The whitened data */
                            int       *bestp,	 /* Which is the best */
                            float     *goodp)	 /* Best goodness of fit */
 /*
- * Thanks to the precomputed SVD everything is really simple
+ * Thanks to the precomputed SVD everything is really simple: the guesses are scored
+ * all at once against their singular vectors stored in one matrix
  */
 {
-    int    k,c;
-    double B2,Bm2,this_good,one;
-    int    best = -1;
-    float  good = 0.0;
-    DipoleForward* fwd;
-    int    ncomp;
-
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
-            }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
-            }
-        }
-    }
-    if (best < 0) {
+    MatrixXf matB = Map<MatrixXf>(B,nch,1);
+    VectorXi vecBest;
+    VectorXf vecGood;
+
+    if (!guess->findBestGuesses(matB,limit,vecBest,vecGood) || vecBest[0] < 0) {
         printf("No reasonable initial guess found.");
         return FAIL;
     }
-     *bestp = best;
-     *goodp = good;
+     *bestp = vecBest[0];
+     *goodp = vecGood[0];
     return OK;
 }
 
@@ -110,6 +110,7 @@ void DipoleFitSettings::initMembers()
     scale_eeg_pos  = false;     
     mag_reg      = 0.1f;         
     fit_mag_dipoles = false;
+    nthreads     = 1;
 
     grad_reg     = 0.1f;         
     eeg_reg      = 0.1f;                  
@@ -263,6 +264,7 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--threads no      Number of parallel fitting threads (default: 1)\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -732,6 +734,21 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
                 return false;
             }
         }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&nthreads) != 1) {
+                qCritical() << "Incomprehensible number of threads:" << argv[k+1];
+                return false;
+            }
+            if (nthreads <= 0) {
+                qCritical ("Number of threads must be > 0");
+                return false;
+            }
+        }
         else if (strcmp(argv[k],"--filteroff") == 0) {
             found = 1;
             filter.filter_on = false;
@@ -154,6 +154,7 @@ float guess_rad;       			/**< Radius of spherical guess surface */
     bool    scale_eeg_pos;     		/**< Scale the electrode locations to scalp in the sphere model */
     float  mag_reg;         		/**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles;
+    int    nthreads;         		/**< Number of time points or raw data segments fitted in parallel (1 = serial fitting) */
 
     float  grad_reg;         		/**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg;         		/**< Noise-covariance matrix regularization for EEG  */
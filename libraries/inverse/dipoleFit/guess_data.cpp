@@ -264,6 +264,8 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
 #endif
     }
     f->funcs = orig;
+    if (!this->makeGuessBasis())
+        goto bad;
 
     fprintf(stderr,"[done %d sources]\n",p);
 
@@ -429,5 +431,82 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
     f->funcs = orig;
     printf("[done %d sources]\n",this->nguess);
 
+    return this->makeGuessBasis();
+}
+
+//=============================================================================================================
+
+bool GuessData::makeGuessBasis()
+{
+    if (nguess <= 0 || !guess_fwd || !guess_fwd[0]) {
+        qCritical("Guess fields missing in makeGuessBasis");
+        return false;
+    }
+
+    int nch = guess_fwd[0]->nch;
+    guess_uu.resize(nch,3*nguess);
+    guess_sing_ratio.resize(nguess);
+
+    for (int k = 0; k < nguess; k++) {
+        DipoleForward* fwd = guess_fwd[k];
+        if (!fwd || fwd->nch != nch || fwd->ndip != 1) {
+            qCritical("Inconsistent guess fields in makeGuessBasis");
+            return false;
+        }
+        for (int c = 0; c < 3; c++)
+            guess_uu.col(3*k+c) = Map<VectorXf>(fwd->uu[c],nch);
+        guess_sing_ratio[k] = fwd->sing[2]/fwd->sing[0];
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool GuessData::findBestGuesses(const MatrixXf& matB, float limit, VectorXi& vecBest, VectorXf& vecGood) const
+{
+    if (matB.rows() != guess_uu.rows()) {
+        qCritical("Data and guess fields have a different number of channels in findBestGuesses");
+        return false;
+    }
+
+    const int ntime = matB.cols();
+
+    //
+    // Projections of the data on the singular vectors of all guesses, three rows per guess
+    //
+    MatrixXf matProj = guess_uu.transpose() * matB;
+
+    //
+    // Omit the pseudoradial component of the guesses where it is weak
+    //
+    VectorXf vecKeep = VectorXf::Ones(3*nguess);
+    for (int k = 0; k < nguess; k++)
+        if (!(guess_sing_ratio[k] > limit))
+            vecKeep[3*k+2] = 0.0f;
+    matProj.array().colwise() *= vecKeep.array();
+
+    //
+    // Explained power of each guess (nguess x ntime) and the best one per time point
+    //
+    MatrixXf matBm2 = Map<MatrixXf>(matProj.data(),3,nguess*ntime).colwise().squaredNorm();
+    Map<MatrixXf> matGuessPower(matBm2.data(),nguess,ntime);
+    RowVectorXf vecB2 = matB.colwise().squaredNorm();
+
+    vecBest.resize(ntime);
+    vecGood.resize(ntime);
+    for (int t = 0; t < ntime; t++) {
+        int best;
+        float Bm2 = matGuessPower.col(t).maxCoeff(&best);
+        if (Bm2 > 0.0f && vecB2[t] > 0.0f) {
+            vecBest[t] = best;
+            vecGood[t] = Bm2/vecB2[t];
+        }
+        else {
+            vecBest[t] = -1;
+            vecGood[t] = 0.0f;
+        }
+    }
+
     return true;
 }
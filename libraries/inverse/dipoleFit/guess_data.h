@@ -134,11 +134,38 @@ public:
      */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+     * Copies the left singular vectors of all guess forward solutions into guess_uu, so that the guesses can
+     * be scored with one matrix product. Called once the guess fields have been computed.
+     *
+     * @return true when successful
+     */
+    bool makeGuessBasis();
+
+    //=========================================================================================================
+    /**
+     * Finds the best guess for each column of matB. The goodness of fit of a guess is the fraction of the
+     * data power explained by its two or three (if the pseudoradial component is not omitted) left singular
+     * vectors, which for all guesses and time points is one product guess_uu' * matB.
+     *
+     * @param[in] matB       The projected and whitened data, channels x time points.
+     * @param[in] limit      Pseudoradial component omission limit.
+     * @param[out] vecBest   The best guess for each time point, -1 if no reasonable guess was found.
+     * @param[out] vecGood   The goodness of fit of the best guesses.
+     *
+     * @return true when successful
+     */
+    bool findBestGuesses(const Eigen::MatrixXf& matB, float limit, Eigen::VectorXi& vecBest, Eigen::VectorXf& vecGood) const;
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
     int            nguess;          /**< How many sources */
 
+    Eigen::MatrixXf guess_uu;       /**< The left singular vectors of all guesses (channels x 3*nguess), one contiguous matrix */
+    Eigen::VectorXf guess_sing_ratio; /**< The ratio of the smallest to the largest singular value of each guess */
+
 // ### OLD STRUCT ###
 //    typedef struct {
 //        float          **rr;                    /**< These are the guess dipole locations */
@@ -68,6 +68,9 @@ using namespace FIFFLIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_iNumKernelChannels(0)
+, m_bFactorizedKernel(false)
+, m_bSinglePrecisionKernel(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -78,6 +81,9 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_iNumKernelChannels(0)
+, m_bFactorizedKernel(false)
+, m_bSinglePrecisionKernel(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -188,39 +194,18 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
         return MNESourceEstimate();
     }
 
-    if(K.cols() != data.rows()) {
-        qWarning() << "MinimumNorm::calculateInverse - Dimension mismatch between K.cols() and data.rows() -" << K.cols() << "and" << data.rows();
+    if(m_iNumKernelChannels != data.rows()) {
+        qWarning() << "MinimumNorm::calculateInverse - Dimension mismatch between K.cols() and data.rows() -" << m_iNumKernelChannels << "and" << data.rows();
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
-
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false)
-    {
-        printf("combining the current components...\n");
-
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.col(i));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
-        }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
-    }
-
-    if (m_bdSPM)
-    {
-        printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
-    }
-    else if (m_bsLORETA)
-    {
-        printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
-    }
-    printf("[done]\n");
+    //apply imaging kernel, pool the orientations and apply the noise normalization
+    MatrixXd sol;
+    KernelWorkspace workspace;
+    applyKernel(data,
+                inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false,
+                sol,
+                workspace);
 
     //Results
     VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
@@ -235,6 +220,47 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
 
 //=============================================================================================================
 
+QList<MNESourceEstimate> MinimumNorm::calculateInverse(const QList<MatrixXd> &lData, float tmin, float tstep, bool pick_normal) const
+{
+    QList<MNESourceEstimate> lSourceEstimates;
+
+    if(!inverseSetup)
+    {
+        qWarning("MinimumNorm::calculateInverse - Inverse not setup -> call doInverseSetup first!");
+        return lSourceEstimates;
+    }
+
+    VectorXi p_vecVertices(inv.src[0].vertno.size() + inv.src[1].vertno.size());
+    p_vecVertices << inv.src[0].vertno, inv.src[1].vertno;
+
+    bool bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && pick_normal == false;
+
+    // The workspace is shared by all epochs
+    MatrixXd sol;
+    KernelWorkspace workspace;
+
+    lSourceEstimates.reserve(lData.size());
+
+    for(int i = 0; i < lData.size(); ++i) {
+        if(m_iNumKernelChannels != lData.at(i).rows()) {
+            qWarning() << "MinimumNorm::calculateInverse - Dimension mismatch between K.cols() and data.rows() for epoch" << i << "-" << m_iNumKernelChannels << "and" << lData.at(i).rows();
+            lSourceEstimates.append(MNESourceEstimate());
+            continue;
+        }
+
+        applyKernel(lData.at(i),
+                    bCombineXyz,
+                    sol,
+                    workspace);
+
+        lSourceEstimates.append(MNESourceEstimate(sol, p_vecVertices, tmin, tstep));
+    }
+
+    return lSourceEstimates;
+}
+
+//=============================================================================================================
+
 void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
 {
     //
@@ -243,9 +269,49 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
     inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
 
     printf("Computing inverse...\n");
-    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
 
-    std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+    K.resize(0,0);
+    m_matKernelLeft.resize(0,0);
+    m_matKernelTrans.resize(0,0);
+    m_matKernelF.resize(0,0);
+    m_matKernelTransF.resize(0,0);
+
+    //
+    //   Fold the noise normalization into the kernel in place. The factors are positive, so scaling the three
+    //   components of a source before taking their norm is the same as scaling the norm.
+    //
+    bool bNoiseNorm = (m_bdSPM || m_bsLORETA) && inv.noisenorm.rows() > 0;
+
+    if(m_bFactorizedKernel) {
+        inv.assemble_kernel_factors(label, m_sMethod, pick_normal, m_matKernelLeft, m_matKernelTrans, noise_norm, vertno);
+
+        std::cout << "K " << m_matKernelLeft.rows() << " x " << m_matKernelLeft.cols() << " x " << m_matKernelTrans.cols() << " (factorized)" << std::endl;
+
+        if(bNoiseNorm) {
+            applyNoiseNorm(m_matKernelLeft);
+        }
+
+        m_iNumKernelChannels = m_matKernelTrans.cols();
+    } else {
+        inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
+
+        std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+
+        if(bNoiseNorm) {
+            applyNoiseNorm(K);
+        }
+
+        m_iNumKernelChannels = K.cols();
+    }
+
+    if(m_bSinglePrecisionKernel) {
+        m_matKernelF = m_bFactorizedKernel ? m_matKernelLeft.cast<float>() : K.cast<float>();
+        m_matKernelTransF = m_matKernelTrans.cast<float>();
+
+        K.resize(0,0);
+        m_matKernelLeft.resize(0,0);
+        m_matKernelTrans.resize(0,0);
+    }
 
     inverseSetup = true;
 }
@@ -314,3 +380,116 @@ void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
 }
+
+//=============================================================================================================
+
+void MinimumNorm::setFactorizedKernel(bool bFactorizedKernel)
+{
+    if(m_bFactorizedKernel != bFactorizedKernel) {
+        m_bFactorizedKernel = bFactorizedKernel;
+        inverseSetup = false;
+    }
+}
+
+//=============================================================================================================
+
+void MinimumNorm::setSinglePrecisionKernel(bool bSinglePrecisionKernel)
+{
+    if(m_bSinglePrecisionKernel != bSinglePrecisionKernel) {
+        m_bSinglePrecisionKernel = bSinglePrecisionKernel;
+        inverseSetup = false;
+    }
+}
+
+//=============================================================================================================
+
+void MinimumNorm::applyKernel(const MatrixXd &data, bool bCombineXyz, MatrixXd &sol, KernelWorkspace &workspace) const
+{
+    if(m_bSinglePrecisionKernel) {
+        applyKernelBlocks<float>(m_matKernelF,
+                                 m_matKernelTransF,
+                                 data,
+                                 bCombineXyz,
+                                 sol,
+                                 workspace.matRankF,
+                                 workspace.matBlockF);
+    } else {
+        applyKernelBlocks<double>(m_bFactorizedKernel ? m_matKernelLeft : K,
+                                  m_matKernelTrans,
+                                  data,
+                                  bCombineXyz,
+                                  sol,
+                                  workspace.matRank,
+                                  workspace.matBlock);
+    }
+}
+
+//=============================================================================================================
+
+template<typename T>
+void MinimumNorm::applyKernelBlocks(const Matrix<T, Dynamic, Dynamic> &matKernel,
+                                    const Matrix<T, Dynamic, Dynamic> &matTrans,
+                                    const MatrixXd &data,
+                                    bool bCombineXyz,
+                                    MatrixXd &sol,
+                                    Matrix<T, Dynamic, Dynamic> &matRank,
+                                    Matrix<T, Dynamic, Dynamic> &matBlock) const
+{
+    bool bFactorized = matTrans.size() > 0;
+    qint32 iNRows = matKernel.rows();
+    qint32 iNSources = bCombineXyz ? iNRows / 3 : iNRows;
+    qint32 iNSamples = data.cols();
+
+    // Keep the block at about 8 MB, but wide enough for an efficient product
+    qint32 iBlockSize = qMin(iNSamples, qMax(16, qint32((1 << 20) / qMax(iNRows, 1))));
+
+    sol.resize(iNSources, iNSamples);
+
+    if(matBlock.rows() != iNRows || matBlock.cols() < iBlockSize) {
+        matBlock.resize(iNRows, iBlockSize);
+    }
+
+    if(bFactorized && (matRank.rows() != matTrans.rows() || matRank.cols() < iBlockSize)) {
+        matRank.resize(matTrans.rows(), iBlockSize);
+    }
+
+    for(qint32 iStart = 0; iStart < iNSamples; iStart += iBlockSize) {
+        qint32 iNCols = qMin(iBlockSize, iNSamples - iStart);
+
+        if(bFactorized) {
+            matRank.leftCols(iNCols).noalias() = matTrans * data.middleCols(iStart, iNCols).template cast<T>();
+            matBlock.leftCols(iNCols).noalias() = matKernel * matRank.leftCols(iNCols);
+        } else {
+            matBlock.leftCols(iNCols).noalias() = matKernel * data.middleCols(iStart, iNCols).template cast<T>();
+        }
+
+        if(bCombineXyz) {
+            // The three components of a source are consecutive in each column
+            for(qint32 i = 0; i < iNCols; ++i) {
+                sol.col(iStart + i) = Map<const Matrix<T, Dynamic, Dynamic> >(matBlock.col(i).data(), 3, iNSources).colwise().norm().transpose().template cast<double>();
+            }
+        } else {
+            sol.middleCols(iStart, iNCols) = matBlock.leftCols(iNCols).template cast<double>();
+        }
+    }
+}
+
+//=============================================================================================================
+
+bool MinimumNorm::applyNoiseNorm(MatrixXd &matKernel) const
+{
+    VectorXd vecNoiseNorm = inv.noisenorm.diagonal();
+
+    if(matKernel.rows() == vecNoiseNorm.size()) {
+        matKernel.array().colwise() *= vecNoiseNorm.array();
+    } else if(matKernel.rows() == 3 * vecNoiseNorm.size()) {
+        for(qint32 i = 0; i < vecNoiseNorm.size(); ++i) {
+            matKernel.middleRows(3*i, 3) *= vecNoiseNorm(i);
+        }
+    } else {
+        qWarning() << "MinimumNorm::applyNoiseNorm - Dimension mismatch between the kernel rows and the noise normalization -" << matKernel.rows() << "and" << vecNoiseNorm.size();
+        return false;
+    }
+
+    return true;
+}
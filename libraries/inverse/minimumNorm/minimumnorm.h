@@ -114,6 +114,22 @@ public:
 
     virtual MNELIB::MNESourceEstimate calculateInverse(const Eigen::MatrixXd &data, float tmin, float tstep, bool pick_normal = false) const;
 
+    //=========================================================================================================
+    /**
+     * Applies the assembled kernel to many epochs or evoked responses at once. The kernel product, the pooling of
+     * the three orientations and the noise normalization are done in one blocked pass per epoch, reusing the same
+     * workspace for all epochs. doInverseSetup has to be called first.
+     *
+     * @param[in] lData          The epochs (channels x samples), all picked to the channels of the inverse operator.
+     * @param[in] tmin           The time of the first sample of each epoch.
+     * @param[in] tstep          The time between two samples.
+     * @param[in] pick_normal    If True, rather than pooling the orientations by taking the norm, only the
+     *                           radial component is kept. This is only applied when working with loose orientations.
+     *
+     * @return the calculated source estimates, one per epoch. Empty if the inverse was not set up.
+     */
+    QList<MNELIB::MNESourceEstimate> calculateInverse(const QList<Eigen::MatrixXd> &lData, float tmin, float tstep, bool pick_normal = false) const;
+
     //=========================================================================================================
     /**
      * Perform the inverse setup: Prepares this inverse operator and assembles the kernel.
@@ -175,13 +191,85 @@ public:
 
     //=========================================================================================================
     /**
-     * Get the assembled kernel
+     * Keep the kernel in factorized low-rank form, see MNEInverseOperator::assemble_kernel_factors, and apply it
+     * as two thin products. Takes effect with the next doInverseSetup.
+     *
+     * @param[in] bFactorizedKernel   Whether to keep the kernel factorized.
+     */
+    void setFactorizedKernel(bool bFactorizedKernel);
+
+    //=========================================================================================================
+    /**
+     * Keep the kernel in single precision. The data is converted block by block and the solution is returned in
+     * double precision. Takes effect with the next doInverseSetup.
+     *
+     * @param[in] bSinglePrecisionKernel   Whether to keep the kernel in single precision.
+     */
+    void setSinglePrecisionKernel(bool bSinglePrecisionKernel);
+
+    //=========================================================================================================
+    /**
+     * Get the assembled kernel. For dSPM and sLORETA the noise normalization is folded in. The kernel is empty if
+     * it is kept factorized or in single precision.
      *
      * @return the assembled kernel
      */
     inline Eigen::MatrixXd& getKernel();
 
 private:
+    /**
+     * Workspace reused when applying the kernel to many blocks and epochs.
+     */
+    struct KernelWorkspace {
+        Eigen::MatrixXd matBlock;       /**< Solution of a block of samples, before pooling the orientations. */
+        Eigen::MatrixXd matRank;        /**< Right kernel factor applied to a block of samples. */
+        Eigen::MatrixXf matBlockF;      /**< Single precision version of matBlock. */
+        Eigen::MatrixXf matRankF;       /**< Single precision version of matRank. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Applies the kernel, with the noise normalization folded in, to the data. The orientations are pooled block
+     * by block right after the product, so no full size three-component solution is formed.
+     *
+     * @param[in] data           The data (channels x samples).
+     * @param[in] bCombineXyz    Whether to pool the three orientations of each source by taking the norm.
+     * @param[out] sol           The solution (sources x samples).
+     * @param[in, out] workspace The workspace.
+     */
+    void applyKernel(const Eigen::MatrixXd &data, bool bCombineXyz, Eigen::MatrixXd &sol, KernelWorkspace &workspace) const;
+
+    //=========================================================================================================
+    /**
+     * Applies a dense or factorized kernel of the given precision block by block.
+     *
+     * @param[in] matKernel      The kernel, or its left factor if matTrans is not empty.
+     * @param[in] matTrans       The right factor of the kernel, empty for a dense kernel.
+     * @param[in] data           The data (channels x samples).
+     * @param[in] bCombineXyz    Whether to pool the three orientations of each source by taking the norm.
+     * @param[out] sol           The solution (sources x samples).
+     * @param[in, out] matRank   Workspace for the right factor applied to a block of samples.
+     * @param[in, out] matBlock  Workspace for the solution of a block of samples.
+     */
+    template<typename T>
+    void applyKernelBlocks(const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &matKernel,
+                           const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &matTrans,
+                           const Eigen::MatrixXd &data,
+                           bool bCombineXyz,
+                           Eigen::MatrixXd &sol,
+                           Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &matRank,
+                           Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> &matBlock) const;
+
+    //=========================================================================================================
+    /**
+     * Scales the rows of the kernel, or its left factor, with the dSPM/sLORETA noise normalization.
+     *
+     * @param[in, out] matKernel     The kernel or its left factor.
+     *
+     * @return true if the dimensions matched, false if the kernel was left unchanged.
+     */
+    bool applyNoiseNorm(Eigen::MatrixXd &matKernel) const;
+
     MNELIB::MNEInverseOperator m_inverseOperator;   /**< The inverse operator */
     float m_fLambda;                                /**< Regularization parameter */
     QString m_sMethod;                              /**< Selected method */
@@ -193,7 +281,14 @@ private:
     Eigen::SparseMatrix<double> noise_norm;         /**< The noise normalization */
     QList<Eigen::VectorXi> vertno;                  /**< The vertices numbers */
     FSLIB::Label label;                             /**< The corresponding labels */
-    Eigen::MatrixXd K;                              /**< Imaging kernel */
+    Eigen::MatrixXd K;                              /**< Imaging kernel with the dSPM/sLORETA noise normalization folded in, empty if the kernel is factorized */
+    Eigen::MatrixXd m_matKernelLeft;                /**< Left factor of the imaging kernel with the noise normalization folded in, empty if the kernel is not factorized */
+    Eigen::MatrixXd m_matKernelTrans;               /**< Right factor of the imaging kernel, empty if the kernel is not factorized */
+    Eigen::MatrixXf m_matKernelF;                   /**< Single precision version of K or m_matKernelLeft */
+    Eigen::MatrixXf m_matKernelTransF;              /**< Single precision version of m_matKernelTrans */
+    qint32 m_iNumKernelChannels;                    /**< Number of channels the kernel is applied to */
+    bool m_bFactorizedKernel;                       /**< Keep the kernel factorized */
+    bool m_bSinglePrecisionKernel;                  /**< Keep the kernel in single precision */
 };
 
 //=============================================================================================================
@@ -169,16 +169,13 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
     std::cout << "##### Calculation of PWL RAP MUSIC started ######\n\n";
 
     MatrixXT t_matProj_Phi_s(t_matOrthProj.rows(), t_pMatPhi_s->cols());
-    //new Version: Calculate projection before
-    MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
+
+    SubcorrTerms t_terms;
 
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
-        //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
-
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
         Eigen::JacobiSVD< MatrixXT > t_svdProj_Phi_S(t_matProj_Phi_s, Eigen::ComputeThinU);
@@ -194,6 +191,9 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
+        //Project the cached gain bases instead of the whole gain matrix
+        calcSubcorrTerms(t_matU_B, t_matA_k_1, r, t_terms);
+
         double t_val_roh_k;
 
         //Powell
@@ -226,16 +226,11 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                 for(int i = 0; i < t_iNumVecElements; i++)
                 {
                     int k = t_pVecIdxElements(i);
-                    //new Version: calculate matrix multiplication before
-                    //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                    MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
 
                     int idx1 = m_ppPairIdxCombinations[k]->x1;
                     int idx2 = m_ppPairIdxCombinations[k]->x2;
 
-                    RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
-
-                    t_vecRoh(k) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                    t_vecRoh(k) = RapMusic::subcorr(idx1, idx2, t_terms);//t_vecRoh holds the correlations roh_k
                 }
             }
 
@@ -160,6 +160,14 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     std::cout << "Gain matrix combinations calculated. \n\n";
 
+    //##### Calc gain bases #####
+
+    std::cout << "Calculate gain matrix bases. \n";
+
+    calcGainBases();
+
+    std::cout << "Gain matrix bases calculated. \n\n";
+
     //##### Calc lead field combination end #####
 
     std::cout << "Number of grid points: " << m_iNumGridPoints << "\n\n";
@@ -443,69 +451,88 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
     std::cout << "##### Calculation of RAP MUSIC started ######\n\n";
 
     MatrixXT t_matProj_Phi_s(t_matOrthProj.rows(), t_pMatPhi_s->cols());
-    //new Version: Calculate projection before
-    MatrixXT t_matProj_LeadField(m_ForwardSolution.sol->data.rows(), m_ForwardSolution.sol->data.cols());
+
+    SubcorrTerms t_terms;
 
     for(int r = 0; r < t_iMaxSearch ; ++r)
     {
         t_matProj_Phi_s = t_matOrthProj*(*t_pMatPhi_s);
 
-        //new Version: Calculating Projection before
-        t_matProj_LeadField = t_matOrthProj * m_ForwardSolution.sol->data;//Subtract the found sources from the current found source
-
         //###First Option###
         //Step 1: lt. Mosher 1998 -> Maybe tmp_Proj_Phi_S is already orthogonal -> so no SVD needed -> U_B = tmp_Proj_Phi_S;
         Eigen::JacobiSVD< MatrixXT > t_svdProj_Phi_S(t_matProj_Phi_s, Eigen::ComputeThinU);
         MatrixXT t_matU_B;
         useFullRank(t_svdProj_Phi_S.matrixU(), t_svdProj_Phi_S.singularValues().asDiagonal(), t_matU_B);
 
-        //Inits
-        VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
-        t_vecRoh.setZero();
-
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
+        //Project the cached gain bases instead of the whole gain matrix
+        calcSubcorrTerms(t_matU_B, t_matA_k_1, r, t_terms);
+
+        //Seed the search with the pairs of the best correlated single grid point
+        VectorXT::Index t_iMaxPoint;
+        t_terms.vecCor.maxCoeff(&t_iMaxPoint);
+
+        VectorXT t_vecRohSeed(m_iNumGridPoints);
+
+        #ifdef _OPENMP
+        #pragma omp parallel for num_threads(m_iMaxNumThreads)
+        #endif
+        for(int i = 0; i < m_iNumGridPoints; ++i)
+        {
+            t_vecRohSeed(i) = RapMusic::subcorr(qMin((int)t_iMaxPoint, i), qMax((int)t_iMaxPoint, i), t_terms);
+        }
+
+        VectorXT::Index t_iSeedPoint;
+        double t_dRohSeed = t_vecRohSeed.maxCoeff(&t_iSeedPoint);
+
+        //Find the maximum of correlation, skipping the pairs which can not beat the best one found so far
+        //Start with the seed pair, its combination index follows the ordering of getPointPair
+        int t_iSeedIdx1 = qMin((int)t_iMaxPoint, (int)t_iSeedPoint);
+        int t_iSeedIdx2 = qMax((int)t_iMaxPoint, (int)t_iSeedPoint);
+
+        double t_val_roh_k = t_dRohSeed;
+        int t_iMaxIdx = t_iSeedIdx1*m_iNumGridPoints - t_iSeedIdx1*(t_iSeedIdx1-1)/2 + (t_iSeedIdx2-t_iSeedIdx1);
+
         //Multithreading correlation calculation
         #ifdef _OPENMP
         #pragma omp parallel num_threads(m_iMaxNumThreads)
         #endif
         {
+            double t_dLocalRoh = -1;
+            int t_iLocalIdx = -1;
+
         #ifdef _OPENMP
         #pragma omp for
         #endif
             for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
             {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
                 int idx1 = m_ppPairIdxCombinations[i]->x1;
                 int idx2 = m_ppPairIdxCombinations[i]->x2;
 
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+                double t_dRoh = RapMusic::subcorr(idx1, idx2, t_terms, qMax(t_dRohSeed, t_dLocalRoh));//t_dRoh holds the correlation roh_k
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                if(t_dRoh > t_dLocalRoh)
+                {
+                    t_dLocalRoh = t_dRoh;
+                    t_iLocalIdx = i;
+                }
             }
-        }
 
-//         if(r==0)
-//         {
-//             std::fstream filestr;
-//             std::stringstream filename;
-//             filename << "Roh_gold.txt";
-//
-//             filestr.open ( filename.str().c_str(), std::fstream::out);
-//             for(int i = 0; i < m_iNumLeadFieldCombinations; ++i)
-//             {
-//               filestr << t_vecRoh(i) << "\n";
-//             }
-//             filestr.close();
-//
-//             //exit(0);
-//         }
+        #ifdef _OPENMP
+        #pragma omp critical
+        #endif
+            {
+                if(t_dLocalRoh > t_val_roh_k || (t_dLocalRoh == t_val_roh_k && t_iLocalIdx < t_iMaxIdx))
+                {
+                    t_val_roh_k = t_dLocalRoh;//p_vecCor = ^roh_k
+                    t_iMaxIdx = t_iLocalIdx;
+                }
+            }
+        }
 
         //subcorr benchmark
         end_subcorr = clock();
@@ -513,13 +540,6 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         float t_fSubcorrElapsedTime = ( (float)(end_subcorr-start_subcorr) / (float)CLOCKS_PER_SEC ) * 1000.0f;
         std::cout << "Time Elapsed: " << t_fSubcorrElapsedTime << " ms" << std::endl;
 
-        //Find the maximum of correlation - can't put this in the for loop because it's running in different threads.
-        double t_val_roh_k;
-
-        VectorXT::Index t_iMaxIdx;
-
-        t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
-
         //get positions in sparsed leadfield from index combinations;
         int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
         int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
@@ -607,6 +627,117 @@ int RapMusic::calcPhi_s(const MatrixXT& p_matMeasurement, MatrixXT* &p_pMatPhi_s
 
 //=============================================================================================================
 
+void RapMusic::calcGainBases()
+{
+    const MatrixXT& t_matGain = m_ForwardSolution.sol->data;
+
+    m_matGainBases = MatrixXT::Zero(m_iNumChannels, 3*m_iNumGridPoints);
+    m_vecGainBasesMask = VectorXT::Zero(3*m_iNumGridPoints);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        Eigen::JacobiSVD<MatrixXT> t_svdG(t_matGain.block(0, i*3, m_iNumChannels, 3), Eigen::ComputeThinU);
+
+        //lt. Mosher 1998: Only Retain those Components of U_A that correspond to nonzero singular values
+        int t_iRank = getRank(t_svdG.singularValues().asDiagonal());
+
+        m_matGainBases.block(0, i*3, m_iNumChannels, t_iRank) = t_svdG.matrixU().leftCols(t_iRank);
+        m_vecGainBasesMask.segment(i*3, t_iRank).setOnes();
+    }
+}
+
+//=============================================================================================================
+
+void RapMusic::calcSubcorrTerms(const MatrixXT& p_matU_B,
+                                const MatrixXT& p_matA_k_1,
+                                int p_iNumFound,
+                                SubcorrTerms& p_terms) const
+{
+    //Orthonormal basis of the found topographies
+    MatrixXT t_matV(m_iNumChannels, 0);
+
+    if(p_iNumFound > 0)
+    {
+        Eigen::JacobiSVD<MatrixXT> t_svdA(p_matA_k_1.leftCols(p_iNumFound), Eigen::ComputeThinU);
+        useFullRank(t_svdA.matrixU(), t_svdA.singularValues().asDiagonal(), t_matV);
+    }
+
+    p_terms.matM = m_matGainBases.transpose()*p_matU_B;
+    p_terms.matW = m_matGainBases.transpose()*t_matV;
+    p_terms.matT.resize(3, 3*m_iNumGridPoints);
+    p_terms.vecCor.resize(m_iNumGridPoints);
+
+    //Whitening and correlation of each single grid point
+    #ifdef _OPENMP
+    #pragma omp parallel for num_threads(m_iMaxNumThreads)
+    #endif
+    for(int i = 0; i < m_iNumGridPoints; ++i)
+    {
+        Matrix3T t_matB = m_vecGainBasesMask.segment(i*3, 3).asDiagonal();
+        t_matB -= p_terms.matW.middleRows(i*3, 3)*p_terms.matW.middleRows(i*3, 3).transpose();
+
+        Matrix3T t_matT = calcWhitening<3>(t_matB);
+        Matrix3T t_matA = p_terms.matM.middleRows(i*3, 3)*p_terms.matM.middleRows(i*3, 3).transpose();
+        Matrix3T t_matH = t_matT.transpose()*t_matA*t_matT;
+
+        p_terms.matT.block(0, i*3, 3, 3) = t_matT;
+        p_terms.vecCor(i) = sqrt(qMax(maxEigenvalue<3>(t_matH), 0.0));
+    }
+}
+
+//=============================================================================================================
+
+double RapMusic::subcorr(int p_iIdx1,
+                         int p_iIdx2,
+                         const SubcorrTerms& p_terms,
+                         double p_dMinCor) const
+{
+    //Z'*P*Z off diagonal block
+    Matrix3T t_matB_12 = m_matGainBases.block(0, p_iIdx1*3, m_iNumChannels, 3).transpose()*m_matGainBases.block(0, p_iIdx2*3, m_iNumChannels, 3);
+    t_matB_12 -= p_terms.matW.middleRows(p_iIdx1*3, 3)*p_terms.matW.middleRows(p_iIdx2*3, 3).transpose();
+
+    //Skip the pair if it can not reach the minimal correlation. The Frobenius norm bounds the cosine between the
+    //projected subspaces of the two points from above.
+    if(p_dMinCor > 0 && p_iIdx1 != p_iIdx2)
+    {
+        double t_dCos = (p_terms.matT.block(0, p_iIdx1*3, 3, 3).transpose()*t_matB_12*p_terms.matT.block(0, p_iIdx2*3, 3, 3)).norm();
+
+        if(t_dCos < 1)
+        {
+            double t_dCor1 = p_terms.vecCor(p_iIdx1);
+            double t_dCor2 = p_terms.vecCor(p_iIdx2);
+
+            if(sqrt((t_dCor1*t_dCor1 + t_dCor2*t_dCor2)/(1 - t_dCos)) < p_dMinCor)
+                return -1;
+        }
+    }
+
+    //Z'*P*Z and Z'*U_B*U_B'*Z
+    Matrix6T t_matB;
+    t_matB.block<3,3>(0,0) = m_vecGainBasesMask.segment(p_iIdx1*3, 3).asDiagonal();
+    t_matB.block<3,3>(0,0) -= p_terms.matW.middleRows(p_iIdx1*3, 3)*p_terms.matW.middleRows(p_iIdx1*3, 3).transpose();
+    t_matB.block<3,3>(3,3) = m_vecGainBasesMask.segment(p_iIdx2*3, 3).asDiagonal();
+    t_matB.block<3,3>(3,3) -= p_terms.matW.middleRows(p_iIdx2*3, 3)*p_terms.matW.middleRows(p_iIdx2*3, 3).transpose();
+    t_matB.block<3,3>(0,3) = t_matB_12;
+    t_matB.block<3,3>(3,0) = t_matB_12.transpose();
+
+    Matrix6T t_matA;
+    t_matA.block<3,3>(0,0) = p_terms.matM.middleRows(p_iIdx1*3, 3)*p_terms.matM.middleRows(p_iIdx1*3, 3).transpose();
+    t_matA.block<3,3>(3,3) = p_terms.matM.middleRows(p_iIdx2*3, 3)*p_terms.matM.middleRows(p_iIdx2*3, 3).transpose();
+    t_matA.block<3,3>(0,3) = p_terms.matM.middleRows(p_iIdx1*3, 3)*p_terms.matM.middleRows(p_iIdx2*3, 3).transpose();
+    t_matA.block<3,3>(3,0) = t_matA.block<3,3>(0,3).transpose();
+
+    Matrix6T t_matT = calcWhitening<6>(t_matB);
+    Matrix6T t_matH = t_matT.transpose()*t_matA*t_matT;
+
+    return sqrt(qMax(maxEigenvalue<6>(t_matH), 0.0));
+}
+
+//=============================================================================================================
+
 double RapMusic::subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B)
 {
     //Orthogonalisierungstest wegen performance weggelassen -> ohne is es viel schneller
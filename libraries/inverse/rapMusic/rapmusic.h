@@ -58,6 +58,7 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/Eigenvalues>
 
 //=============================================================================================================
 // DEFINE NAMESPACE INVERSELIB
@@ -112,6 +113,8 @@ public:
                                                                              1> as VectorXT type. */
     typedef Eigen::Matrix<double, 6, 1> Vector6T;                            /**< Defines Eigen::Matrix<T, 6, 1>
                                                                              as Vector6T type. */
+    typedef Eigen::Matrix<double, 3, 3> Matrix3T;                            /**< Defines Eigen::Matrix<T, 3, 3>
+                                                                             as Matrix3T type. */
 
     //=========================================================================================================
     /**
@@ -166,6 +169,64 @@ public:
     void setStcAttr(int p_iSampStcWin, float p_fStcOverlap);
 
 protected:
+    //=========================================================================================================
+    /**
+     * The per iteration terms of the subspace correlation with the cached gain bases, see calcSubcorrTerms.
+     */
+    struct SubcorrTerms {
+        MatrixXT matM;      /**< The gain bases projected onto U_B (3 * grid points x rank of U_B). */
+        MatrixXT matW;      /**< The gain bases projected onto the found topographies (3 * grid points x found sources). */
+        MatrixXT matT;      /**< The whitening of the projected gain basis of each grid point (3 x 3 * grid points). */
+        VectorXT vecCor;    /**< The subspace correlation of each single grid point. */
+    };
+
+    //=========================================================================================================
+    /**
+     * Computes an orthonormal basis of the gain matrix of each grid point. Directions belonging to zero singular
+     * values (e.g. the radial direction for MEG) are set to zero. The bases only depend on the gain matrix, so they
+     * are computed once during initialization and reused for all iterations and measurement windows.
+     */
+    void calcGainBases();
+
+    //=========================================================================================================
+    /**
+     * Computes the terms needed by subcorr(int, int, const SubcorrTerms&, double) for the current iteration.
+     * With the orthogonal projector P = I - V*V' of the found topographies V, the projected gain of a pair spans
+     * the same space as P*Q with the cached bases Q. Since U_B lies in the range of P, U_B'*P*Q = U_B'*Q, so only
+     * Q'*U_B and Q'*V are needed, computed with two products for all grid points at once.
+     *
+     * @param[in] p_matU_B       The matrix U is the subspace projection of the orthogonal projected Phi_s.
+     * @param[in] p_matA_k_1     The array of the manifold vectors.
+     * @param[in] p_iNumFound    The number of sources found so far, i.e. the number of valid columns of p_matA_k_1.
+     * @param[out] p_terms       The terms of the current iteration.
+     */
+    void calcSubcorrTerms(const MatrixXT& p_matU_B,
+                          const MatrixXT& p_matA_k_1,
+                          int p_iNumFound,
+                          SubcorrTerms& p_terms) const;
+
+    //=========================================================================================================
+    /**
+     * Computes the subspace correlation of the projected gain of a grid point pair and the projected signal
+     * subspace with the cached gain bases. Equal to subcorr(MatrixX6T&, const MatrixXT&) with the projected gain
+     * pair, but only works on 6 x 6 matrices. The correlation is the square root of the largest generalized
+     * eigenvalue of (Z'*U_B*U_B'*Z, Z'*P*Z) with Z = [Q_1 Q_2], found by whitening the second matrix.
+     *
+     * If p_dMinCor is positive, the pair is skipped when the upper bound
+     * sqrt((c_1^2 + c_2^2) / (1 - c_12)) is below it. c_1 and c_2 are the correlations of the single points and
+     * c_12 is the cosine between their projected subspaces.
+     *
+     * @param[in] p_iIdx1    First grid point index.
+     * @param[in] p_iIdx2    Second grid point index.
+     * @param[in] p_terms    The terms of the current iteration, see calcSubcorrTerms.
+     * @param[in] p_dMinCor  The correlation the pair has to reach to be computed, 0 computes every pair.
+     * @return   The maximal correlation c_1 of the subspace correlation, or -1 if the pair was skipped.
+     */
+    double subcorr(int p_iIdx1,
+                   int p_iIdx2,
+                   const SubcorrTerms& p_terms,
+                   double p_dMinCor = 0.0) const;
+
     //=========================================================================================================
     /**
      * Computes the signal subspace Phi_s out of the measurement F.
@@ -308,6 +369,9 @@ protected:
 
     Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
 
+    MatrixXT m_matGainBases;        /**< Orthonormal basis of the gain matrix of each grid point (channels x 3 * grid points), see calcGainBases. */
+    VectorXT m_vecGainBasesMask;    /**< 1 for the valid columns of m_matGainBases, 0 for the zeroed null directions. */
+
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
     bool m_bIsInit; /**< Whether the algorithm is initialized. */
@@ -349,6 +413,27 @@ protected:
      * @return F * F^Transposed (we call it FFT ;))
      */
     static inline MatrixXT makeSquareMat(const MatrixXT& p_matF);
+
+    //=========================================================================================================
+    /**
+     * Computes the whitening of a symmetric positive semi-definite matrix B, i.e. W with W'*B*W being the identity
+     * on the range of B. Directions with eigenvalues below epsilon = 10^-10 are dropped (zero columns).
+     *
+     * @param[in] p_matB The symmetric positive semi-definite matrix.
+     * @return The whitening matrix.
+     */
+    template<int N>
+    static inline Eigen::Matrix<double, N, N> calcWhitening(const Eigen::Matrix<double, N, N>& p_matB);
+
+    //=========================================================================================================
+    /**
+     * Returns the largest eigenvalue of a symmetric matrix.
+     *
+     * @param[in] p_matH The symmetric matrix.
+     * @return The largest eigenvalue.
+     */
+    template<int N>
+    static inline double maxEigenvalue(const Eigen::Matrix<double, N, N>& p_matH);
 };
 
 //=============================================================================================================
@@ -397,6 +482,31 @@ inline RapMusic::MatrixXT RapMusic::makeSquareMat(const MatrixXT& p_matF)
 
     return p_matF*mat;
 }
+
+//=============================================================================================================
+
+template<int N>
+inline Eigen::Matrix<double, N, N> RapMusic::calcWhitening(const Eigen::Matrix<double, N, N>& p_matB)
+{
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, N, N> > t_eigB(p_matB);
+
+    Eigen::Matrix<double, N, 1> t_vecScale;
+    for(int i = 0; i < N; ++i)
+        t_vecScale(i) = t_eigB.eigenvalues()(i) > 1e-10 ? 1.0/sqrt(t_eigB.eigenvalues()(i)) : 0.0;
+
+    return t_eigB.eigenvectors()*t_vecScale.asDiagonal();
+}
+
+//=============================================================================================================
+
+template<int N>
+inline double RapMusic::maxEigenvalue(const Eigen::Matrix<double, N, N>& p_matH)
+{
+    //Eigenvalues are sorted in increasing order
+    Eigen::SelfAdjointEigenSolver< Eigen::Matrix<double, N, N> > t_eigH(p_matH, Eigen::EigenvaluesOnly);
+
+    return t_eigH.eigenvalues()(N-1);
+}
 } //NAMESPACE
 
 #endif // RAPMUSIC_H
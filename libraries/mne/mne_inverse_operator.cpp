@@ -161,6 +161,30 @@ bool MNEInverseOperator::assemble_kernel(const Label &label,
                                          MatrixXd &K,
                                          SparseMatrix<double> &noise_norm,
                                          QList<VectorXi> &vertno)
+{
+    MatrixXd matLeads;
+    MatrixXd matTrans;
+
+    if(!assemble_kernel_factors(label, method, pick_normal, matLeads, matTrans, noise_norm, vertno))
+        return false;
+
+    K = matLeads*matTrans;
+
+    //store assembled kernel
+    m_K = K;
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool MNEInverseOperator::assemble_kernel_factors(const Label &label,
+                                                 QString method,
+                                                 bool pick_normal,
+                                                 MatrixXd &matLeads,
+                                                 MatrixXd &matTrans,
+                                                 SparseMatrix<double> &noise_norm,
+                                                 QList<VectorXi> &vertno)
 {
     MatrixXd t_eigen_leads = this->eigen_leads->data;
     MatrixXd t_source_cov = this->source_cov->data;
@@ -274,7 +298,7 @@ bool MNEInverseOperator::assemble_kernel(const Label &label,
         //     R^0.5 has been already factored in
         //
         printf("(eigenleads already weighted)...\n");
-        K = t_eigen_leads*trans;
+        matLeads = t_eigen_leads;
     }
     else
     {
@@ -290,15 +314,43 @@ bool MNEInverseOperator::assemble_kernel(const Label &label,
        SparseMatrix<double> t_sourceCov(t_source_cov.rows(),t_source_cov.rows());
        t_sourceCov.setFromTriplets(tripletList2.begin(), tripletList2.end());
 
-       K = t_sourceCov*t_eigen_leads*trans;
+       matLeads = t_sourceCov*t_eigen_leads;
+    }
+
+    //
+    //   Drop the components which were regularized away, e.g. by projections or a rank deficient noise covariance.
+    //   Their rows of trans are zero, so they do not contribute to the kernel.
+    //
+    qint32 nzero = 0;
+    for(qint32 i = 0; i < reginv.rows(); ++i)
+        if(reginv(i,0) != 0)
+            ++nzero;
+
+    if(nzero < reginv.rows())
+    {
+        MatrixXd t_leads(matLeads.rows(), nzero);
+        matTrans.resize(nzero, trans.cols());
+
+        qint32 count = 0;
+        for(qint32 i = 0; i < reginv.rows(); ++i)
+        {
+            if(reginv(i,0) != 0)
+            {
+                t_leads.col(count) = matLeads.col(i);
+                matTrans.row(count) = trans.row(i);
+                ++count;
+            }
+        }
+        matLeads = t_leads;
+    }
+    else
+    {
+        matTrans = trans;
     }
 
     if(method.compare("MNE") == 0)
         noise_norm = SparseMatrix<double>();
 
-    //store assembled kernel
-    m_K = K;
-
     return true;
 }
 
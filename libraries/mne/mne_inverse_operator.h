@@ -216,6 +216,31 @@ public:
                          Eigen::SparseMatrix<double> &noise_norm,
                          QList<Eigen::VectorXi> &vertno);
 
+    //=========================================================================================================
+    /**
+     * Assembles the kernel in factorized low-rank form K = matLeads * matTrans without forming the dense kernel.
+     * Components which were regularized away are dropped, so the rank is the number of non-zero entries of
+     * reginv. Applying the factors as two thin products, matLeads * (matTrans * data), needs less memory and
+     * fewer flops than the dense kernel whenever the rank is small compared to the number of channels.
+     *
+     * @param[in] label          labels.
+     * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+     * @param[in] pick_normal    Pick normals.
+     * @param[out] matLeads      The weighted eigenleads (sources x rank).
+     * @param[out] matTrans      The regularized, whitened and projected eigenfields (rank x channels).
+     * @param[out] noise_norm    Noise normals.
+     * @param[out] vertno        Vertices of the hemispheres.
+     *
+     * @return true when successful, false otherwise
+     */
+    bool assemble_kernel_factors(const FSLIB::Label &label,
+                                 QString method,
+                                 bool pick_normal,
+                                 Eigen::MatrixXd &matLeads,
+                                 Eigen::MatrixXd &matTrans,
+                                 Eigen::SparseMatrix<double> &noise_norm,
+                                 QList<Eigen::VectorXi> &vertno);
+
     //=========================================================================================================
     /**
      * Check that channels in inverse operator are measurements.
@@ -148,7 +148,14 @@ FiffEvoked RTPROCESSINGLIB::computeFilteredAverage(const FiffRawData& raw,
     MatrixXd times;
 
     QScopedPointer<MNEEpochData> epoch(Q_NULLPTR);
+    // FIR filters are applied zero phase and need half their order on both sides. IIR filters are applied causally,
+    // they need a lead-in covering their impulse response and nothing after the epoch.
     int iFilterDelay = filterKernel.getFilterOrder()/2;
+    int iFilterTail = iFilterDelay;
+    if(filterKernel.isIir()) {
+        iFilterDelay = filterKernel.getCoefficients().cols();
+        iFilterTail = 0;
+    }
 
     for (p = 0; p < count; ++p) {
         // Read a data segment
@@ -158,7 +165,7 @@ FiffEvoked RTPROCESSINGLIB::computeFilteredAverage(const FiffRawData& raw,
 
         epoch.reset(new MNEEpochData());
 
-        if(raw.read_raw_segment(epoch->epoch, timesDummy, from - iFilterDelay, to + iFilterDelay, picksNew)) {
+        if(raw.read_raw_segment(epoch->epoch, timesDummy, from - iFilterDelay, to + iFilterTail, picksNew)) {
             // Filter the data
             epoch->epoch = RTPROCESSINGLIB::filterData(epoch->epoch,filterKernel).block(0, iFilterDelay, epoch->epoch.rows(), to-from);
 
@@ -41,12 +41,16 @@
 
 #include <utils/mnemath.h>
 #include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_raw_writer.h>
+
+#include <functional>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
+#include <QThread>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -64,6 +68,117 @@ using namespace Eigen;
 using namespace FIFFLIB;
 using namespace UTILSLIB;
 
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+/**
+ * A contiguous range of picked channels which is filtered with one FFT plan by filterDataBlock.
+ */
+struct FilterBatch {
+    FilterKernel    filterKernel;   /**< Own copy of the prepared kernel, so batches can run concurrently. */
+    int             iFirst;         /**< First index into the picks. */
+    MatrixXd        matData;        /**< The picked rows, replaced by their filtered result. */
+};
+
+//=============================================================================================================
+
+/**
+ * Slices the data into blocks of at least the filter order, filters them and overlap-adds the results. Only the
+ * block which is currently filtered is converted to double precision, the output is kept in the input precision.
+ */
+template<typename Scalar>
+static Matrix<Scalar,Dynamic,Dynamic> filterDataSliced(const Matrix<Scalar,Dynamic,Dynamic>& mataData,
+                                                      const FilterKernel& filterKernel,
+                                                      const RowVectorXi& vecPicks,
+                                                      bool bUseThreads,
+                                                      bool bKeepOverhead)
+{
+    int iOrder = filterKernel.getFilterOrder();
+
+    // IIR filters run causally over the whole data, there is nothing to slice. With bKeepOverhead the result is
+    // framed like the FIR result, i.e. with iOrder/2 zeros in front and back.
+    if(filterKernel.isIir()) {
+        MatrixXd matFiltered = mataData.template cast<double>();
+        FilterBiquad filter(filterKernel,
+                            mataData.rows(),
+                            vecPicks);
+        filter.filter(matFiltered);
+
+        if(!bKeepOverhead) {
+            return matFiltered.template cast<Scalar>();
+        }
+
+        Matrix<Scalar,Dynamic,Dynamic> matDataOut = Matrix<Scalar,Dynamic,Dynamic>::Zero(mataData.rows(), mataData.cols()+iOrder);
+        matDataOut.block(0, iOrder/2, mataData.rows(), mataData.cols()) = matFiltered.template cast<Scalar>();
+        return matDataOut;
+    }
+
+    // Check for size of data
+    if(mataData.cols() < iOrder){
+        qWarning() << "[Filter::filterData] Filter length/order is bigger than data length. Returning.";
+        return mataData;
+    }
+
+    // Create output matrix with size of input matrix
+    Matrix<Scalar,Dynamic,Dynamic> matDataOut(mataData.rows(), mataData.cols()+iOrder);
+    matDataOut.setZero();
+    MatrixXd sliceFiltered;
+
+    // slice input data into data junks with proper length so that the slices are always >= the filter order
+    float fFactor = 2.0f;
+    int iSize = fFactor * iOrder;
+    int residual = mataData.cols() % iSize;
+    while(residual < iOrder) {
+        fFactor = fFactor - 0.1f;
+        iSize = fFactor * iOrder;
+        residual = mataData.cols() % iSize;
+
+        if(iSize < iOrder) {
+            iSize = mataData.cols();
+            break;
+        }
+    }
+
+    if(mataData.cols() > iSize) {
+        int from = 0;
+        int numSlices = ceil(float(mataData.cols())/float(iSize)); //calculate number of data slices
+
+        for (int i = 0; i < numSlices; i++) {
+            if(i == numSlices-1) {
+                //catch the last one that might be shorter than the other blocks
+                iSize = mataData.cols() - (iSize * (numSlices -1));
+            }
+
+            // Filter the data block. This will return data with a fitler delay of iOrder/2 in front and back
+            sliceFiltered = filterDataBlock(mataData.block(0,from,mataData.rows(),iSize).template cast<double>(),
+                                            vecPicks,
+                                            filterKernel,
+                                            bUseThreads);
+
+            // Perform overlap add
+            if(i == 0) {
+                matDataOut.block(0,0,mataData.rows(),sliceFiltered.cols()) += sliceFiltered.template cast<Scalar>();
+            } else {
+                matDataOut.block(0,from,mataData.rows(),sliceFiltered.cols()) += sliceFiltered.template cast<Scalar>();
+            }
+
+            from += iSize;
+        }
+    } else {
+        matDataOut = filterDataBlock(mataData.template cast<double>(),
+                                     vecPicks,
+                                     filterKernel,
+                                     bUseThreads).template cast<Scalar>();
+    }
+
+    if(bKeepOverhead) {
+        return matDataOut;
+    } else {
+        return matDataOut.block(0,iOrder/2,matDataOut.rows(),mataData.cols());
+    }
+}
+
 //=============================================================================================================
 // DEFINE GLOBAL RTPROCESSINGLIB METHODS
 //=============================================================================================================
@@ -117,6 +232,9 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
     RowVectorXi sel;
     FiffStream::SPtr outfid = FiffStream::start_writing_raw(pIODevice, pFiffRawData->info, cals);
 
+    // Encoding and writing the filtered blocks runs in the background while the next block is read and filtered
+    FiffRawWriter writer(outfid, cals);
+
     //Setup reading parameters
     fiff_int_t from = pFiffRawData->first_samp;
     fiff_int_t to = pFiffRawData->last_samp;
@@ -125,7 +243,7 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
     float fFactor = 2.0f;
     int iSize = fFactor * iOrder;
     int residual = (to - from) % iSize;
-    while(residual < iOrder) {
+    while(residual < iOrder && !filterKernel.isIir()) {
         fFactor = fFactor - 0.1f;
         iSize = fFactor * iOrder;
         residual = (to - from) % iSize;
@@ -137,6 +255,11 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
         }
     }
 
+    // IIR filters do not overlap the blocks, so the block size only needs to be large enough for efficient I/O
+    if(filterKernel.isIir()) {
+        iSize = qMax(int(pFiffRawData->info.sfreq), 1);
+    }
+
     float quantum_sec = iSize/pFiffRawData->info.sfreq;
     fiff_int_t quantum = ceil(quantum_sec*pFiffRawData->info.sfreq);
 
@@ -146,6 +269,7 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
     fiff_int_t first, last;
     MatrixXd matData, matDataOverlap;
     MatrixXd times;
+    FilterBiquad iirFilter;
 
     for(first = from; first < to; first+=quantum) {
         last = first+quantum-1;
@@ -155,6 +279,7 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
 
         if (!pFiffRawData->read_raw_segment(matData, times, mult, first, last, sel)) {
             qWarning("[Filter::filterData] Error during read_raw_segment\n");
+            writer.stop();
             return false;
         }
 
@@ -165,6 +290,19 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
                outfid->write_int(FIFF_FIRST_SAMPLE,&first);
            }
            first_buffer = false;
+           writer.start();
+        }
+
+        // IIR filters keep their states from block to block, so the filtered blocks can be written as they are
+        if(filterKernel.isIir()) {
+            if(!iirFilter.isInitialized()) {
+                iirFilter.init(filterKernel,
+                               matData.rows(),
+                               vecPicks);
+            }
+            iirFilter.filter(matData);
+            writer.write_raw_buffer(matData);
+            continue;
         }
 
         matData = filterDataBlock(matData,
@@ -173,18 +311,23 @@ bool RTPROCESSINGLIB::filterFile(QIODevice &pIODevice,
                                   bUseThreads);
 
         if(first == from) {
-            outfid->write_raw_buffer(matData.block(0,iOrder/2,matData.rows(),matData.cols()-iOrder), cals);
+            writer.write_raw_buffer(matData.block(0,iOrder/2,matData.rows(),matData.cols()-iOrder));
         } else if(first + quantum >= to) {
             matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
+            writer.write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder));
         } else {
             matData.block(0,0,matData.rows(),iOrder) += matDataOverlap;
-            outfid->write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder), cals);
+            writer.write_raw_buffer(matData.block(0,0,matData.rows(),matData.cols()-iOrder));
         }
 
         matDataOverlap = matData.block(0,matData.cols()-iOrder,matData.rows(),iOrder);
     }
 
+    if(!writer.stop()) {
+        qWarning("[Filter::filterData] Error while writing the filtered data\n");
+        outfid->finish_writing_raw();
+        return false;
+    }
     outfid->finish_writing_raw();
 
     return true;
@@ -240,71 +383,26 @@ MatrixXd RTPROCESSINGLIB::filterData(const MatrixXd& mataData,
                                      bool bUseThreads,
                                      bool bKeepOverhead)
 {
-    int iOrder = filterKernel.getFilterOrder();
-
-    // Check for size of data
-    if(mataData.cols() < iOrder){
-        qWarning() << "[Filter::filterData] Filter length/order is bigger than data length. Returning.";
-        return mataData;
-    }
-
-    // Create output matrix with size of input matrix
-    MatrixXd matDataOut(mataData.rows(), mataData.cols()+iOrder);
-    matDataOut.setZero();
-    MatrixXd sliceFiltered;
-
-    // slice input data into data junks with proper length so that the slices are always >= the filter order
-    float fFactor = 2.0f;
-    int iSize = fFactor * iOrder;
-    int residual = mataData.cols() % iSize;
-    while(residual < iOrder) {
-        fFactor = fFactor - 0.1f;
-        iSize = fFactor * iOrder;
-        residual = mataData.cols() % iSize;
-
-        if(iSize < iOrder) {
-            iSize = mataData.cols();
-            break;
-        }
-    }
-
-    if(mataData.cols() > iSize) {
-        int from = 0;
-        int numSlices = ceil(float(mataData.cols())/float(iSize)); //calculate number of data slices
-
-        for (int i = 0; i < numSlices; i++) {
-            if(i == numSlices-1) {
-                //catch the last one that might be shorter than the other blocks
-                iSize = mataData.cols() - (iSize * (numSlices -1));
-            }
-
-            // Filter the data block. This will return data with a fitler delay of iOrder/2 in front and back
-            sliceFiltered = filterDataBlock(mataData.block(0,from,mataData.rows(),iSize),
-                                            vecPicks,
-                                            filterKernel,
-                                            bUseThreads);
-
-            // Perform overlap add
-            if(i == 0) {
-                matDataOut.block(0,0,mataData.rows(),sliceFiltered.cols()) += sliceFiltered;
-            } else {
-                matDataOut.block(0,from,mataData.rows(),sliceFiltered.cols()) += sliceFiltered;
-            }
+    return filterDataSliced(mataData,
+                            filterKernel,
+                            vecPicks,
+                            bUseThreads,
+                            bKeepOverhead);
+}
 
-            from += iSize;
-        }
-    } else {
-        matDataOut = filterDataBlock(mataData,
-                                     vecPicks,
-                                     filterKernel,
-                                     bUseThreads);
-    }
+//=============================================================================================================
 
-    if(bKeepOverhead) {
-        return matDataOut;
-    } else {
-        return matDataOut.block(0,iOrder/2,matDataOut.rows(),mataData.cols());
-    }
+MatrixXf RTPROCESSINGLIB::filterData(const MatrixXf& mataData,
+                                     const FilterKernel& filterKernel,
+                                     const RowVectorXi& vecPicks,
+                                     bool bUseThreads,
+                                     bool bKeepOverhead)
+{
+    return filterDataSliced(mataData,
+                            filterKernel,
+                            vecPicks,
+                            bUseThreads,
+                            bKeepOverhead);
 }
 
 //=============================================================================================================
@@ -316,6 +414,18 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& mataData,
 {
     int iOrder = filterKernel.getFilterOrder();
 
+    // IIR filters are applied causally to the block, starting from zero states
+    if(filterKernel.isIir()) {
+        MatrixXd matDataOut = MatrixXd::Zero(mataData.rows(), mataData.cols()+iOrder);
+        MatrixXd matFiltered = mataData;
+        FilterBiquad filter(filterKernel,
+                            mataData.rows(),
+                            vecPicks);
+        filter.filter(matFiltered);
+        matDataOut.block(0, iOrder/2, mataData.rows(), mataData.cols()) = matFiltered;
+        return matDataOut;
+    }
+
     // Check for size of data
     if(mataData.cols() < iOrder){
         qWarning() << QString("[Filter::filterDataBlock] Filter length/order is bigger than data length. Returning.");
@@ -329,19 +439,7 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& mataData,
     // Do the concurrent filtering
     RowVectorXi vecPicksNew = vecPicks;
     if(vecPicksNew.cols() == 0) {
-        vecPicksNew = RowVectorXi::LinSpaced(mataData.rows(), 0, mataData.rows());
-    }
-
-    // Generate QList structure which can be handled by the QConcurrent framework
-    QList<FilterObject> timeData;
-
-    // Only select channels specified in vecPicksNew
-    FilterObject data;
-    for(qint32 i = 0; i < vecPicksNew.cols(); ++i) {
-        data.filterKernel = filterKernelSetup;
-        data.iRow = vecPicksNew[i];
-        data.vecData = mataData.row(vecPicksNew[i]);
-        timeData.append(data);
+        vecPicksNew = RowVectorXi::LinSpaced(mataData.rows(), 0, mataData.rows()-1);
     }
 
     // Copy in data from last data block. This is necessary in order to also delay channels which are not filtered
@@ -349,22 +447,43 @@ MatrixXd RTPROCESSINGLIB::filterDataBlock(const MatrixXd& mataData,
     matDataOut.setZero();
     matDataOut.block(0, iOrder/2, mataData.rows(), mataData.cols()) = mataData;
 
-    if(bUseThreads) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                                 filterChannel);
-        future.waitForFinished();
-    } else {
-        for(int i = 0; i < timeData.size(); ++i) {
-            filterChannel(timeData[i]);
+    if(vecPicksNew.cols() == 0) {
+        return matDataOut;
+    }
+
+    // Split the picked channels into one contiguous batch per thread. Each batch is transformed as a whole with a
+    // single FFT plan instead of one plan lookup and set of temporaries per channel.
+    int iNumBatches = bUseThreads ? qBound(1, QThread::idealThreadCount(), int(vecPicksNew.cols())) : 1;
+    int iBatchSize = (vecPicksNew.cols() + iNumBatches - 1) / iNumBatches;
+
+    QList<FilterBatch> lBatches;
+    for(int iFirst = 0; iFirst < vecPicksNew.cols(); iFirst += iBatchSize) {
+        FilterBatch batch;
+        batch.filterKernel = filterKernelSetup;
+        batch.iFirst = iFirst;
+        batch.matData.resize(qMin(iBatchSize, int(vecPicksNew.cols()) - iFirst), mataData.cols());
+        for(int i = 0; i < batch.matData.rows(); ++i) {
+            batch.matData.row(i) = mataData.row(vecPicksNew[iFirst + i]);
         }
+        lBatches.append(batch);
     }
 
-    // Do the overlap add method and store in matDataOut
-    RowVectorXd tempData;
+    std::function<void(FilterBatch&)> filterBatch = [](FilterBatch& batch) {
+        batch.filterKernel.applyFftFilter(batch.matData, true);
+    };
 
-    for(int r = 0; r < timeData.size(); r++) {
-        // Write the newly calculated filtered data to the filter data matrix. This data has a delay of iOrder/2 in front and back
-        matDataOut.row(timeData.at(r).iRow) = timeData.at(r).vecData;
+    if(lBatches.size() > 1) {
+        QtConcurrent::blockingMap(lBatches, filterBatch);
+    } else {
+        filterBatch(lBatches.first());
+    }
+
+    // Write the newly calculated filtered data to the filter data matrix. This data has a delay of iOrder/2 in front and back
+    for(int b = 0; b < lBatches.size(); ++b) {
+        const FilterBatch& batch = lBatches.at(b);
+        for(int i = 0; i < batch.matData.rows(); ++i) {
+            matDataOut.row(vecPicksNew[batch.iFirst + i]) = batch.matData.row(i);
+        }
     }
 
     return matDataOut;
@@ -382,6 +501,392 @@ void RTPROCESSINGLIB::filterChannel(RTPROCESSINGLIB::FilterObject& channelDataTi
 // DEFINE MEMBER METHODS
 //=============================================================================================================
 
+/**
+ * FFT plans and buffers of one thread, working on a contiguous range of the filtered rows.
+ */
+struct FilterOverlapSave::Worker {
+    int                 iFirst;     /**< First index into m_vecFilterRows. */
+    int                 iNum;       /**< Number of rows. */
+    Eigen::FFT<double>  fft;        /**< The FFT object holding the plans for m_iFftLength. */
+    RowVectorXd         vecTime;    /**< Time domain buffer of m_iFftLength samples. */
+    RowVectorXcd        vecFreq;    /**< Half spectrum buffer. */
+};
+
+//=============================================================================================================
+
+FilterOverlapSave::FilterOverlapSave()
+: m_iNumChannels(0)
+, m_iBlockSize(0)
+, m_iNumTaps(0)
+, m_iFftLength(0)
+, m_bUseThreads(true)
+{
+}
+
+//=============================================================================================================
+
+FilterOverlapSave::FilterOverlapSave(const FilterKernel& filterKernel,
+                                     int iNumChannels,
+                                     int iBlockSize,
+                                     const RowVectorXi& vecPicks,
+                                     bool bUseThreads)
+: m_iNumChannels(0)
+, m_iBlockSize(0)
+, m_iNumTaps(0)
+, m_iFftLength(0)
+, m_bUseThreads(true)
+{
+    init(filterKernel,
+         iNumChannels,
+         iBlockSize,
+         vecPicks,
+         bUseThreads);
+}
+
+//=============================================================================================================
+
+bool FilterOverlapSave::init(const FilterKernel& filterKernel,
+                             int iNumChannels,
+                             int iBlockSize,
+                             const RowVectorXi& vecPicks,
+                             bool bUseThreads)
+{
+    m_lWorkers.clear();
+    m_iNumChannels = 0;
+
+    RowVectorXd vecCoeff = filterKernel.getCoefficients();
+
+    if(iNumChannels <= 0 || iBlockSize <= 0 || vecCoeff.cols() == 0) {
+        qWarning() << "[FilterOverlapSave::init] Number of channels, block size and filter length need to be positive.";
+        return false;
+    }
+
+    // Split the channels into the filtered and the only delayed ones
+    QVector<bool> vecIsPicked(iNumChannels, vecPicks.cols() == 0);
+    for(int i = 0; i < vecPicks.cols(); ++i) {
+        if(vecPicks[i] < 0 || vecPicks[i] >= iNumChannels) {
+            qWarning() << "[FilterOverlapSave::init] Pick" << vecPicks[i] << "is out of range.";
+            return false;
+        }
+        vecIsPicked[vecPicks[i]] = true;
+    }
+
+    int iNumPicked = vecIsPicked.count(true);
+    m_vecFilterRows.resize(iNumPicked);
+    m_vecDelayRows.resize(iNumChannels - iNumPicked);
+    for(int i = 0, iPicked = 0, iDelayed = 0; i < iNumChannels; ++i) {
+        if(vecIsPicked[i]) {
+            m_vecFilterRows[iPicked++] = i;
+        } else {
+            m_vecDelayRows[iDelayed++] = i;
+        }
+    }
+
+    m_filterKernel = filterKernel;
+    m_vecPicks = vecPicks;
+    m_iNumTaps = vecCoeff.cols();
+    m_iBlockSize = iBlockSize;
+    m_bUseThreads = bUseThreads;
+
+    // The FFT has to hold the history of m_iNumTaps-1 samples and one block without wrapping around
+    int exp = ceil(MNEMath::log2(m_iBlockSize + m_iNumTaps - 1));
+    m_iFftLength = pow(2, exp);
+
+    // Transform the kernel once
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+    RowVectorXd vecInputFft = RowVectorXd::Zero(m_iFftLength);
+    vecInputFft.head(m_iNumTaps) = vecCoeff;
+    fft.fwd(m_vecFftCoeff, vecInputFft, m_iFftLength);
+
+    // Create the FFT plans and buffers of each thread once
+    int iNumWorkers = m_bUseThreads ? qMin(QThread::idealThreadCount(), iNumPicked) : 1;
+    iNumWorkers = qMax(iNumWorkers, 1);
+    int iFirst = 0;
+    for(int i = 0; i < iNumWorkers; ++i) {
+        QSharedPointer<Worker> pWorker = QSharedPointer<Worker>::create();
+        pWorker->iFirst = iFirst;
+        pWorker->iNum = (iNumPicked - iFirst) / (iNumWorkers - i);
+        pWorker->fft.SetFlag(pWorker->fft.HalfSpectrum);
+        pWorker->vecTime = RowVectorXd::Zero(m_iFftLength);
+        pWorker->fft.fwd(pWorker->vecFreq, pWorker->vecTime, m_iFftLength);
+        pWorker->fft.inv(pWorker->vecTime, pWorker->vecFreq);
+        iFirst += pWorker->iNum;
+        m_lWorkers.append(pWorker);
+    }
+
+    m_iNumChannels = iNumChannels;
+    reset();
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FilterOverlapSave::filter(MatrixXd& matData)
+{
+    if(!isInitialized()) {
+        qWarning() << "[FilterOverlapSave::filter] Filter was not initialized.";
+        return false;
+    }
+
+    if(matData.rows() != m_iNumChannels) {
+        qWarning() << "[FilterOverlapSave::filter] Expected" << m_iNumChannels << "channels, got" << matData.rows() << ".";
+        return false;
+    }
+
+    const int iHistory = m_iNumTaps - 1;
+    const int iDelay = getDelay();
+
+    for(int iFrom = 0; iFrom < matData.cols(); iFrom += m_iBlockSize) {
+        const int iSize = qMin(m_iBlockSize, int(matData.cols()) - iFrom);
+
+        std::function<void(QSharedPointer<Worker>&)> filterRows = [&](QSharedPointer<Worker>& pWorker) {
+            RowVectorXd& vecTime = pWorker->vecTime;
+
+            for(int k = pWorker->iFirst; k < pWorker->iFirst + pWorker->iNum; ++k) {
+                const int iRow = m_vecFilterRows[k];
+
+                // Overlap save: the last iHistory input samples followed by the new ones
+                vecTime.head(iHistory) = m_matHistory.row(k);
+                vecTime.segment(iHistory, iSize) = matData.row(iRow).segment(iFrom, iSize);
+                vecTime.tail(m_iFftLength - iHistory - iSize).setZero();
+                m_matHistory.row(k) = vecTime.segment(iSize, iHistory);
+
+                pWorker->fft.fwd(pWorker->vecFreq, vecTime, m_iFftLength);
+                pWorker->vecFreq.array() *= m_vecFftCoeff.array();
+                pWorker->fft.inv(vecTime, pWorker->vecFreq);
+
+                // Everything in front of the new samples is corrupted by the circular convolution
+                matData.row(iRow).segment(iFrom, iSize) = vecTime.segment(iHistory, iSize);
+            }
+        };
+
+        if(m_lWorkers.size() > 1) {
+            QtConcurrent::blockingMap(m_lWorkers, filterRows);
+        } else {
+            filterRows(m_lWorkers.first());
+        }
+
+        // Delay the channels which are not filtered by the same amount as the filtered ones
+        if(iDelay > 0) {
+            RowVectorXd vecDelayed(iDelay + iSize);
+            for(int k = 0; k < m_vecDelayRows.cols(); ++k) {
+                const int iRow = m_vecDelayRows[k];
+                vecDelayed.head(iDelay) = m_matDelay.row(k);
+                vecDelayed.tail(iSize) = matData.row(iRow).segment(iFrom, iSize);
+                matData.row(iRow).segment(iFrom, iSize) = vecDelayed.head(iSize);
+                m_matDelay.row(k) = vecDelayed.tail(iDelay);
+            }
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+void FilterOverlapSave::reset()
+{
+    m_matHistory.setZero(m_vecFilterRows.cols(), qMax(m_iNumTaps - 1, 0));
+    m_matDelay.setZero(m_vecDelayRows.cols(), getDelay());
+}
+
+//=============================================================================================================
+
+bool FilterOverlapSave::isInitialized() const
+{
+    return m_iNumChannels > 0;
+}
+
+//=============================================================================================================
+
+int FilterOverlapSave::getDelay() const
+{
+    return m_filterKernel.getFilterOrder()/2;
+}
+
+//=============================================================================================================
+
+int FilterOverlapSave::getNumChannels() const
+{
+    return m_iNumChannels;
+}
+
+//=============================================================================================================
+
+int FilterOverlapSave::getBlockSize() const
+{
+    return m_iBlockSize;
+}
+
+//=============================================================================================================
+
+const RowVectorXi& FilterOverlapSave::getPicks() const
+{
+    return m_vecPicks;
+}
+
+//=============================================================================================================
+
+const FilterKernel& FilterOverlapSave::getFilterKernel() const
+{
+    return m_filterKernel;
+}
+
+//=============================================================================================================
+
+FilterBiquad::FilterBiquad()
+: m_iNumChannels(0)
+{
+}
+
+//=============================================================================================================
+
+FilterBiquad::FilterBiquad(const FilterKernel& filterKernel,
+                           int iNumChannels,
+                           const RowVectorXi& vecPicks)
+: m_iNumChannels(0)
+{
+    init(filterKernel,
+         iNumChannels,
+         vecPicks);
+}
+
+//=============================================================================================================
+
+bool FilterBiquad::init(const FilterKernel& filterKernel,
+                        int iNumChannels,
+                        const RowVectorXi& vecPicks)
+{
+    m_iNumChannels = 0;
+
+    if(!filterKernel.isIir() || iNumChannels <= 0) {
+        qWarning() << "[FilterBiquad::init] Need an IIR filter kernel and a positive number of channels.";
+        return false;
+    }
+
+    QVector<bool> vecIsPicked(iNumChannels, vecPicks.cols() == 0);
+    for(int i = 0; i < vecPicks.cols(); ++i) {
+        if(vecPicks[i] < 0 || vecPicks[i] >= iNumChannels) {
+            qWarning() << "[FilterBiquad::init] Pick" << vecPicks[i] << "is out of range.";
+            return false;
+        }
+        vecIsPicked[vecPicks[i]] = true;
+    }
+
+    m_vecFilterRows.resize(vecIsPicked.count(true));
+    for(int i = 0, iPicked = 0; i < iNumChannels; ++i) {
+        if(vecIsPicked[i]) {
+            m_vecFilterRows[iPicked++] = i;
+        }
+    }
+
+    m_filterKernel = filterKernel;
+    m_vecPicks = vecPicks;
+    m_matSos = filterKernel.getSosCoefficients();
+
+    // Normalize to a0 = 1
+    for(int s = 0; s < m_matSos.rows(); ++s) {
+        m_matSos.row(s) /= m_matSos(s,3);
+    }
+
+    m_iNumChannels = iNumChannels;
+    reset();
+
+    return true;
+}
+
+//=============================================================================================================
+
+bool FilterBiquad::filter(MatrixXd& matData)
+{
+    if(!isInitialized() || matData.rows() != m_iNumChannels) {
+        qWarning() << "[FilterBiquad::filter] Not initialized or number of channels does not match.";
+        return false;
+    }
+
+    int iNumSamples = matData.cols();
+    int iNumRows = m_vecFilterRows.cols();
+    if(iNumSamples == 0 || iNumRows == 0) {
+        return true;
+    }
+
+    // Gather the filtered rows, so that the rows of one sample are contiguous. If all rows are filtered, the data
+    // can be used as it is.
+    bool bAllRows = (iNumRows == m_iNumChannels);
+    if(!bAllRows) {
+        m_matBuffer.resize(iNumRows, iNumSamples);
+        for(int i = 0; i < iNumRows; ++i) {
+            m_matBuffer.row(i) = matData.row(m_vecFilterRows[i]);
+        }
+    }
+    MatrixXd& matX = bAllRows ? matData : m_matBuffer;
+
+    // Direct form II transposed, one section after the other, all rows of a sample at once
+    ArrayXd vecIn(iNumRows);
+    ArrayXd vecOut(iNumRows);
+    for(int t = 0; t < iNumSamples; ++t) {
+        vecIn = matX.col(t).array();
+        for(int s = 0; s < m_matSos.rows(); ++s) {
+            const double b0 = m_matSos(s,0), b1 = m_matSos(s,1), b2 = m_matSos(s,2);
+            const double a1 = m_matSos(s,4), a2 = m_matSos(s,5);
+
+            vecOut = b0 * vecIn + m_matState1.col(s);
+            m_matState1.col(s) = b1 * vecIn - a1 * vecOut + m_matState2.col(s);
+            m_matState2.col(s) = b2 * vecIn - a2 * vecOut;
+            vecIn.swap(vecOut);
+        }
+        matX.col(t) = vecIn.matrix();
+    }
+
+    if(!bAllRows) {
+        for(int i = 0; i < iNumRows; ++i) {
+            matData.row(m_vecFilterRows[i]) = m_matBuffer.row(i);
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+void FilterBiquad::reset()
+{
+    m_matState1.setZero(m_vecFilterRows.cols(), m_matSos.rows());
+    m_matState2.setZero(m_vecFilterRows.cols(), m_matSos.rows());
+}
+
+//=============================================================================================================
+
+bool FilterBiquad::isInitialized() const
+{
+    return m_iNumChannels > 0;
+}
+
+//=============================================================================================================
+
+int FilterBiquad::getNumChannels() const
+{
+    return m_iNumChannels;
+}
+
+//=============================================================================================================
+
+const RowVectorXi& FilterBiquad::getPicks() const
+{
+    return m_vecPicks;
+}
+
+//=============================================================================================================
+
+const FilterKernel& FilterBiquad::getFilterKernel() const
+{
+    return m_filterKernel;
+}
+
+//=============================================================================================================
+
 MatrixXd FilterOverlapAdd::calculate(const MatrixXd& mataData,
                                      FilterKernel::FilterType type,
                                      double dCenterfreq,
@@ -395,11 +900,7 @@ MatrixXd FilterOverlapAdd::calculate(const MatrixXd& mataData,
                                      bool bUseThreads,
                                      bool bKeepOverhead)
 {
-    // Check for size of data
-    if(mataData.cols() < iOrder){
-        qWarning() << QString("[Filter::filterData] Filter length/order is bigger than data length. Returning.");
-        return mataData;
-    }
+    // Blocks shorter than the filter are handled, or rejected, by the kernel based calculate
 
     // Normalize cut off frequencies to nyquist
     dCenterfreq = dCenterfreq/(dSFreq/2.0);
@@ -435,12 +936,71 @@ MatrixXd FilterOverlapAdd::calculate(const MatrixXd& mataData,
 {
     int iOrder = filterKernel.getFilterOrder();
 
+    // IIR filters are applied causally and keep their states between the blocks, no overlap is needed
+    if(filterKernel.isIir()) {
+        const RowVectorXi& vecLastPicks = m_filterBiquad.getPicks();
+        const MatrixXd matLastSos = m_filterBiquad.getFilterKernel().getSosCoefficients();
+        const MatrixXd matSos = filterKernel.getSosCoefficients();
+
+        if(!m_filterBiquad.isInitialized() ||
+           m_filterBiquad.getNumChannels() != mataData.rows() ||
+           vecLastPicks.cols() != vecPicks.cols() || vecLastPicks != vecPicks ||
+           matLastSos.rows() != matSos.rows() || matLastSos != matSos) {
+            m_filterBiquad.init(filterKernel,
+                                mataData.rows(),
+                                vecPicks);
+        }
+
+        MatrixXd matFiltered = mataData;
+        m_filterBiquad.filter(matFiltered);
+
+        if(!bKeepOverhead) {
+            return matFiltered;
+        }
+
+        // Frame the result like the FIR result, i.e. with iOrder/2 zeros in front and back
+        MatrixXd matDataOut = MatrixXd::Zero(mataData.rows(), mataData.cols()+iOrder);
+        matDataOut.block(0, iOrder/2, mataData.rows(), mataData.cols()) = matFiltered;
+
+        return matDataOut;
+    }
+
+    // Continous streams are filtered with the overlap save filter, which keeps its FFT plans and history and
+    // does not need the blocks to be longer than the filter
+    if(bFilterEnd && !bKeepOverhead) {
+        const RowVectorXi& vecLastPicks = m_filterOverlapSave.getPicks();
+        const RowVectorXd vecLastCoeff = m_filterOverlapSave.getFilterKernel().getCoefficients();
+        const RowVectorXd vecCoeff = filterKernel.getCoefficients();
+
+        if(!m_filterOverlapSave.isInitialized() ||
+           m_filterOverlapSave.getNumChannels() != mataData.rows() ||
+           m_filterOverlapSave.getFilterKernel().getFilterOrder() != iOrder ||
+           vecLastPicks.cols() != vecPicks.cols() || vecLastPicks != vecPicks ||
+           vecLastCoeff.cols() != vecCoeff.cols() || vecLastCoeff != vecCoeff) {
+            m_filterOverlapSave.init(filterKernel,
+                                     mataData.rows(),
+                                     mataData.cols(),
+                                     vecPicks,
+                                     bUseThreads);
+        }
+
+        m_matOverlapBack.resize(0,0);
+        m_matOverlapFront.resize(0,0);
+
+        MatrixXd matDataOut = mataData;
+        if(m_filterOverlapSave.filter(matDataOut)) {
+            return matDataOut;
+        }
+    }
+
     // Check for size of data
     if(mataData.cols() < iOrder){
         qWarning() << "[Filter::filterData] Filter length/order is bigger than data length. Returning.";
         return mataData;
     }
 
+    m_filterOverlapSave.reset();
+
     // Init overlaps from last block
     if(m_matOverlapBack.cols() != iOrder || m_matOverlapBack.rows() < mataData.rows()) {
         m_matOverlapBack.resize(mataData.rows(), iOrder);
@@ -532,4 +1092,6 @@ void FilterOverlapAdd::reset()
 {
     m_matOverlapBack.resize(0,0);
     m_matOverlapFront.resize(0,0);
+    m_filterOverlapSave.reset();
+    m_filterBiquad.reset();
 }
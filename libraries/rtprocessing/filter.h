@@ -93,7 +93,7 @@ typedef struct {
  * @param [in] dTransition          The transistion band determines the width of the filter slopes (steepness)
  * @param [in] dSFreq               The input data sampling frequency.
  * @param [in] iOrder               Represents the order of the filter, the higher the higher is the stopband attenuation. Default is 4096 taps.
- * @param [in] designMethod         The design method to use. Choose between Cosine and Tschebyscheff. Defaul is set to Cosine.
+ * @param [in] designMethod         The design method to use. Choose between Cosine and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR). Defaul is set to Cosine.
  * @param [in] vecPicks             Channel indexes to filter. Default is filter all channels.
  * @param [in] bUseThreads          hether to use multiple threads. Default is set to true.
  *
@@ -142,7 +142,7 @@ RTPROCESINGSHARED_EXPORT bool filterFile(QIODevice& pIODevice,
  * @param [in] dTransition      The transistion band determines the width of the filter slopes (steepness)
  * @param [in] dSFreq           The input data sampling frequency.
  * @param [in] iOrder           Represents the order of the filter, the higher the higher is the stopband attenuation. Default is 1024 taps.
- * @param [in] designMethod     The design method to use. Choose between Cosine and Tschebyscheff. Defaul is set to Cosine.
+ * @param [in] designMethod     The design method to use. Choose between Cosine and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR). Defaul is set to Cosine.
  * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
  * @param [in] bUseThreads      Whether to use multiple threads. Default is set to true.
  * @param [in] bKeepOverhead    Whether to keep the delayed part of the data after filtering. Default is set to false .
@@ -180,6 +180,26 @@ RTPROCESINGSHARED_EXPORT Eigen::MatrixXd filterData(const Eigen::MatrixXd& mataD
                                                     bool bUseThreads = true,
                                                     bool bKeepOverhead = false);
 
+//=========================================================================================================
+/**
+ * Calculates the filtered version of single precision raw input data, e.g. as read via
+ * FiffRawData::read_raw_segment(Eigen::MatrixXf&, ...). Only the block currently being filtered is held in double
+ * precision, the input and output stay in single precision.
+ *
+ * @param [in] mataData         The data which is to be filtered.
+ * @param [in] filterKernel     The list of filter kernels to use.
+ * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
+ * @param [in] bUseThreads      Whether to use multiple threads. Default is set to true.
+ * @param [in] bKeepOverhead    Whether to keep the delayed part of the data after filtering. Default is set to false .
+ *
+ * @return The filtered data in form of a matrix.
+ */
+RTPROCESINGSHARED_EXPORT Eigen::MatrixXf filterData(const Eigen::MatrixXf& mataData,
+                                                    const RTPROCESSINGLIB::FilterKernel& filterKernel,
+                                                    const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi(),
+                                                    bool bUseThreads = true,
+                                                    bool bKeepOverhead = false);
+
 //=========================================================================================================
 /**
  * Calculates the filtered version of the raw input data block.
@@ -205,6 +225,254 @@ RTPROCESINGSHARED_EXPORT Eigen::MatrixXd filterDataBlock(const Eigen::MatrixXd&
  */
 RTPROCESINGSHARED_EXPORT void filterChannel(FilterObject &channelDataTime);
 
+//=============================================================================================================
+/**
+ * Streaming multichannel FFT filter based on the overlap save method. The kernel spectrum and the FFT plans are
+ * set up once in init(); afterwards each call of filter() only transforms the new samples together with the last
+ * filter length - 1 input samples of each channel, which are kept in one contiguous history matrix. The output is
+ * the causal convolution of the input stream with the kernel, i.e., it carries the filter delay of getDelay()
+ * samples. Channels which are not picked are delayed by the same amount.
+ *
+ * @brief Streaming multichannel FFT filter based on the overlap save method.
+ */
+class RTPROCESINGSHARED_EXPORT FilterOverlapSave
+{
+public:
+    typedef QSharedPointer<FilterOverlapSave> SPtr;             /**< Shared pointer type for FilterOverlapSave. */
+    typedef QSharedPointer<const FilterOverlapSave> ConstSPtr;  /**< Const shared pointer type for FilterOverlapSave. */
+
+    //=========================================================================================================
+    /**
+     * Constructs an uninitialized FilterOverlapSave. Call init() before filtering.
+     */
+    FilterOverlapSave();
+
+    //=========================================================================================================
+    /**
+     * Constructs a FilterOverlapSave, see init().
+     *
+     * @param [in] filterKernel     The filter kernel to use.
+     * @param [in] iNumChannels     The number of channels (rows) of the data blocks.
+     * @param [in] iBlockSize       The number of samples (columns) the FFT length is set up for. Larger blocks are
+     *                              processed in pieces of this size.
+     * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     * @param [in] bUseThreads      Whether to use multiple threads. Default is set to true.
+     */
+    FilterOverlapSave(const RTPROCESSINGLIB::FilterKernel& filterKernel,
+                      int iNumChannels,
+                      int iBlockSize,
+                      const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi(),
+                      bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Designs the FFT plans and the kernel spectrum and clears the filter history.
+     *
+     * @param [in] filterKernel     The filter kernel to use.
+     * @param [in] iNumChannels     The number of channels (rows) of the data blocks.
+     * @param [in] iBlockSize       The number of samples (columns) the FFT length is set up for. Larger blocks are
+     *                              processed in pieces of this size.
+     * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     * @param [in] bUseThreads      Whether to use multiple threads. Default is set to true.
+     *
+     * @return true if succeeded, false otherwise
+     */
+    bool init(const RTPROCESSINGLIB::FilterKernel& filterKernel,
+              int iNumChannels,
+              int iBlockSize,
+              const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi(),
+              bool bUseThreads = true);
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream in place.
+     *
+     * @param [in/out] matData      The next block of data (channels x samples). Gets overwritten with its filtered result.
+     *
+     * @return true if succeeded, false if not initialized or the number of channels does not match.
+     */
+    bool filter(Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+     * Clears the filter history, i.e., the next block is filtered as if the stream started with it.
+     */
+    void reset();
+
+    //=========================================================================================================
+    /**
+     * Returns whether init() was called successfully.
+     *
+     * @return true if initialized, false otherwise
+     */
+    bool isInitialized() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the filter delay in samples, which is half the filter order.
+     *
+     * @return the filter delay in samples
+     */
+    int getDelay() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of channels the filter was set up for.
+     *
+     * @return the number of channels, 0 if not initialized
+     */
+    int getNumChannels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of samples which are processed at once. Larger blocks are processed in pieces of this size.
+     *
+     * @return the block size in samples
+     */
+    int getBlockSize() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the channel picks as handed to init().
+     *
+     * @return the channel picks, empty if all channels are filtered
+     */
+    const Eigen::RowVectorXi& getPicks() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the filter kernel as handed to init().
+     *
+     * @return the filter kernel
+     */
+    const RTPROCESSINGLIB::FilterKernel& getFilterKernel() const;
+
+private:
+    struct Worker;
+
+    RTPROCESSINGLIB::FilterKernel   m_filterKernel;         /**< The filter kernel. */
+    Eigen::RowVectorXi              m_vecPicks;             /**< The channel picks as handed to init(). */
+    Eigen::RowVectorXi              m_vecFilterRows;        /**< The rows to filter. */
+    Eigen::RowVectorXi              m_vecDelayRows;         /**< The rows which are only delayed. */
+    Eigen::RowVectorXcd             m_vecFftCoeff;          /**< The kernel spectrum for m_iFftLength. */
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> m_matHistory;   /**< Last filter length - 1 input samples of each filtered row. */
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> m_matDelay;     /**< Last getDelay() input samples of each delayed row. */
+    QList<QSharedPointer<Worker> >  m_lWorkers;             /**< Per thread FFT plans and buffers, each working on a contiguous range of m_vecFilterRows. */
+    int                             m_iNumChannels;         /**< The number of channels. */
+    int                             m_iBlockSize;           /**< The maximum number of samples processed at once. */
+    int                             m_iNumTaps;             /**< The number of filter coefficients. */
+    int                             m_iFftLength;           /**< The FFT length. */
+    bool                            m_bUseThreads;          /**< Whether to use multiple threads. */
+};
+
+//=============================================================================================================
+/**
+ * Streaming multichannel IIR filter for kernels designed with the Butterworth or Chebyshev design method. The second
+ * order sections are applied as a cascade of biquads in direct form II transposed. The two state variables per
+ * section and channel are kept between calls, so blocks of any length, down to single samples, can be filtered
+ * without overlap and the output is available with the (frequency dependent) group delay of the IIR filter only.
+ * Each section update works on all filtered channels of one sample at once, which Eigen vectorizes.
+ * Channels which are not picked are passed through unchanged.
+ *
+ * @brief Streaming multichannel IIR filter based on a cascade of biquads.
+ */
+class RTPROCESINGSHARED_EXPORT FilterBiquad
+{
+public:
+    typedef QSharedPointer<FilterBiquad> SPtr;             /**< Shared pointer type for FilterBiquad. */
+    typedef QSharedPointer<const FilterBiquad> ConstSPtr;  /**< Const shared pointer type for FilterBiquad. */
+
+    //=========================================================================================================
+    /**
+     * Constructs an uninitialized FilterBiquad. Call init() before filtering.
+     */
+    FilterBiquad();
+
+    //=========================================================================================================
+    /**
+     * Constructs a FilterBiquad, see init().
+     *
+     * @param [in] filterKernel     The IIR filter kernel to use.
+     * @param [in] iNumChannels     The number of channels (rows) of the data blocks.
+     * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     */
+    FilterBiquad(const RTPROCESSINGLIB::FilterKernel& filterKernel,
+                 int iNumChannels,
+                 const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Takes over the second order sections of the kernel and clears the filter states.
+     *
+     * @param [in] filterKernel     The IIR filter kernel to use.
+     * @param [in] iNumChannels     The number of channels (rows) of the data blocks.
+     * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
+     *
+     * @return true if succeeded, false if the kernel is no IIR filter or the picks are out of range.
+     */
+    bool init(const RTPROCESSINGLIB::FilterKernel& filterKernel,
+              int iNumChannels,
+              const Eigen::RowVectorXi& vecPicks = Eigen::RowVectorXi());
+
+    //=========================================================================================================
+    /**
+     * Filters the next block of the stream in place.
+     *
+     * @param [in/out] matData      The next block of data (channels x samples). Gets overwritten with its filtered result.
+     *
+     * @return true if succeeded, false if not initialized or the number of channels does not match.
+     */
+    bool filter(Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+     * Clears the filter states, i.e., the next block is filtered as if the stream started with it.
+     */
+    void reset();
+
+    //=========================================================================================================
+    /**
+     * Returns whether init() was called successfully.
+     *
+     * @return true if initialized, false otherwise
+     */
+    bool isInitialized() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of channels the filter was set up for.
+     *
+     * @return the number of channels, 0 if not initialized
+     */
+    int getNumChannels() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the channel picks as handed to init().
+     *
+     * @return the channel picks, empty if all channels are filtered
+     */
+    const Eigen::RowVectorXi& getPicks() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the IIR filter kernel as handed to init().
+     *
+     * @return the filter kernel
+     */
+    const RTPROCESSINGLIB::FilterKernel& getFilterKernel() const;
+
+private:
+    RTPROCESSINGLIB::FilterKernel   m_filterKernel;         /**< The filter kernel. */
+    Eigen::RowVectorXi              m_vecPicks;             /**< The channel picks as handed to init(). */
+    Eigen::RowVectorXi              m_vecFilterRows;        /**< The rows to filter. */
+    Eigen::MatrixXd                 m_matSos;               /**< The second order sections, one per row: b0 b1 b2 a0 a1 a2. */
+    Eigen::ArrayXXd                 m_matState1;            /**< First state of each section (columns) for each filtered row (rows). */
+    Eigen::ArrayXXd                 m_matState2;            /**< Second state of each section (columns) for each filtered row (rows). */
+    Eigen::MatrixXd                 m_matBuffer;            /**< Gathered filtered rows, so that the rows of one sample are contiguous. */
+    int                             m_iNumChannels;         /**< The number of channels. */
+};
+
 //=============================================================================================================
 /**
  * Filtering with FFT convolution and the overlap add method for continous data streams. This class will hold
@@ -220,7 +488,8 @@ public:
 
     //=========================================================================================================
     /**
-     * Creates a user designed filter kernel and filters the raw input data
+     * Creates a user designed filter kernel and filters the raw input data. Blocks shorter than the filter are
+     * only supported for bFilterEnd without bKeepOverhead, see the kernel based calculate.
      *
      * @param [in] matData          The data which is to be filtered.
      * @param [in] type             The type of the filter: LPF, HPF, BPF, NOTCH (from enum FilterType).
@@ -229,7 +498,7 @@ public:
      * @param [in] dTransition      The transistion band determines the width of the filter slopes (steepness)
      * @param [in] dSFreq           The input data sampling frequency.
      * @param [in] iOrder           Represents the order of the filter, the higher the higher is the stopband attenuation. Default is 1024 taps.
-     * @param [in] designMethod     The design method to use. Choose between Cosine and Tschebyscheff. Defaul is set to Cosine.
+     * @param [in] designMethod     The design method to use. Choose between Cosine and Tschebyscheff (FIR) or Butterworth and Chebyshev (IIR). Defaul is set to Cosine.
      * @param [in] vecPicks         Channel indexes to filter. Default is filter all channels.
      * @param [in] bFilterEnd       Whether to perform the overlap add in the beginning or end of the data. Default is set to true (end of data).
      * @param [in] bUseThreads      Whether to use multiple threads. Default is set to true.
@@ -252,7 +521,10 @@ public:
 
     //=========================================================================================================
     /**
-     * Calculates the filtered version of the raw input data based on a given list filters
+     * Calculates the filtered version of the raw input data based on a given list filters.
+     * For bFilterEnd without bKeepOverhead, i.e., continous streams, the filtering is done by a FilterOverlapSave
+     * which is only set up anew if the kernel, the number of channels or the picks change. IIR kernels are always
+     * applied causally by a FilterBiquad, bFilterEnd is ignored for them.
      *
      * @param [in] mataData         The data which is to be filtered.
      * @param [in] filterKernel     The list of filter kernels to use.
@@ -279,6 +551,9 @@ public:
 private:
     Eigen::MatrixXd                 m_matOverlapBack;                   /**< Overlap block for the end of the data block */
     Eigen::MatrixXd                 m_matOverlapFront;                  /**< Overlap block for the beginning of the data block */
+
+    FilterOverlapSave               m_filterOverlapSave;                /**< Streaming filter used for bFilterEnd without overhead */
+    FilterBiquad                    m_filterBiquad;                     /**< Streaming filter used for IIR kernels */
 };
 
 //=============================================================================================================
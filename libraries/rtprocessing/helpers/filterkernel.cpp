@@ -44,6 +44,7 @@
 
 #include "parksmcclellan.h"
 #include "cosinefilter.h"
+#include "iirfilter.h"
 
 #include <iostream>
 
@@ -90,6 +91,14 @@ QString RTPROCESSINGLIB::getStringForDesignMethod(FilterKernel::DesignMethod des
             return "Tschebyscheff";
             break;
 
+        case FilterKernel::Butterworth:
+            return "Butterworth";
+            break;
+
+        case FilterKernel::Chebyshev:
+            return "Chebyshev";
+            break;
+
         default:
             return "External";
             break;
@@ -133,6 +142,10 @@ FilterKernel::DesignMethod RTPROCESSINGLIB::getDesignMethodForString(const QStri
         return FilterKernel::Tschebyscheff;
     } else if(designMethodString == "Cosine") {
         return FilterKernel::Cosine;
+    } else if(designMethodString == "Butterworth") {
+        return FilterKernel::Butterworth;
+    } else if(designMethodString == "Chebyshev") {
+        return FilterKernel::Chebyshev;
     } else {
         return FilterKernel::External;
     }
@@ -193,7 +206,7 @@ FilterKernel::FilterKernel(const QString& sFilterName,
 , m_iFilterOrder(iOrder)
 , m_sFilterName(sFilterName)
 {
-    if(iOrder < 9) {
+    if(iOrder < 9 && designMethod != Butterworth && designMethod != Chebyshev) {
        qWarning() << "[FilterKernel::FilterKernel] Less than 9 taps were provided. Setting number of taps to 9.";
     }
 
@@ -211,7 +224,7 @@ void FilterKernel::prepareFilter(int iDataSize)
     iFftLength = pow(2, exp);
 
     // Transform coefficients anew if needed
-    if(m_vecCoeff.cols() != (iFftLength/2+1)) {
+    if(m_vecFftCoeff.cols() != (iFftLength/2+1)) {
         fftTransformCoeffs(iFftLength);
     }
 }
@@ -291,6 +304,60 @@ void FilterKernel::applyFftFilter(RowVectorXd& vecData,
 
 //=============================================================================================================
 
+void FilterKernel::applyFftFilter(MatrixXd& matData,
+                                  bool bKeepOverhead)
+{
+    #ifdef EIGEN_FFTW_DEFAULT
+    fftw_make_planner_thread_safe();
+    #endif
+
+    if(matData.rows() == 0) {
+        return;
+    }
+
+    // Make sure we always have the correct FFT length for the given input data and filter overlap
+    int iFftLength = matData.cols() + m_vecCoeff.cols();
+    int exp = ceil(MNEMath::log2(iFftLength));
+    iFftLength = pow(2, exp);
+
+    // Transform coefficients anew if needed
+    if(m_vecFftCoeff.cols() != (iFftLength/2+1)) {
+        fftTransformCoeffs(iFftLength);
+    }
+
+    //generate fft object, the plans are shared by all channels
+    Eigen::FFT<double> fft;
+    fft.SetFlag(fft.HalfSpectrum);
+
+    // Transpose into a zero padded column-major block, one contiguous column per channel
+    int iOriginalSize = matData.cols();
+    MatrixXd matTime = MatrixXd::Zero(iFftLength, matData.rows());
+    matTime.topRows(iOriginalSize) = matData.transpose();
+
+    //fft-transform all channels
+    MatrixXcd matFreqData(iFftLength/2+1, matTime.cols());
+    for(int i = 0; i < matTime.cols(); ++i) {
+        fft.fwd(matFreqData.col(i).data(), matTime.col(i).data(), iFftLength);
+    }
+
+    //perform frequency-domain filtering of all channels at once
+    matFreqData.array().colwise() *= m_vecFftCoeff.transpose().array();
+
+    //inverse-FFT in place
+    for(int i = 0; i < matTime.cols(); ++i) {
+        fft.inv(matTime.col(i).data(), matFreqData.col(i).data(), iFftLength);
+    }
+
+    //Return filtered data
+    if(!bKeepOverhead) {
+        matData = matTime.middleRows(m_vecCoeff.cols()/2, iOriginalSize).transpose();
+    } else {
+        matData = matTime.topRows(iOriginalSize + m_vecCoeff.cols()).transpose();
+    }
+}
+
+//=============================================================================================================
+
 QString FilterKernel::getName() const
 {
     return m_sFilterName;
@@ -431,6 +498,20 @@ void FilterKernel::setFftCoefficients(const Eigen::RowVectorXcd& vecFftCoeff)
 
 //=============================================================================================================
 
+bool FilterKernel::isIir() const
+{
+    return m_matSos.rows() > 0;
+}
+
+//=============================================================================================================
+
+MatrixXd FilterKernel::getSosCoefficients() const
+{
+    return m_matSos;
+}
+
+//=============================================================================================================
+
 bool FilterKernel::fftTransformCoeffs(int iFftLength)
 {
     #ifdef EIGEN_FFTW_DEFAULT
@@ -536,6 +617,35 @@ void FilterKernel::designFilter()
 
             break;
         }
+
+        case Butterworth:
+        case Chebyshev: {
+            if(m_Type == UNKNOWN) {
+                break;
+            }
+
+            IirFilter filteriir(m_iFilterOrder,
+                                m_dCenterFreq,
+                                m_dBandwidth,
+                                static_cast<IirFilter::TPassType>(m_Type),
+                                m_designMethod == Butterworth ? IirFilter::Butterworth : IirFilter::Chebyshev);
+            m_matSos = filteriir.m_matSos;
+
+            //Keep the impulse response until it decayed, for plots and as the settling length of the filter
+            RowVectorXd vecImpulse = filteriir.impulseResponse(8192);
+            double dThreshold = 1e-6 * vecImpulse.cwiseAbs().maxCoeff();
+            int iLength = vecImpulse.cols();
+            while(iLength > 9 && std::abs(vecImpulse[iLength-1]) < dThreshold) {
+                --iLength;
+            }
+            iLength += iLength % 2;
+            m_vecCoeff = vecImpulse.head(iLength);
+
+            exp = ceil(MNEMath::log2(iLength));
+            fftTransformCoeffs(pow(2, exp));
+
+            break;
+        }
     }
 
     switch(m_Type) {
@@ -75,7 +75,12 @@ namespace RTPROCESSINGLIB
 
 //=============================================================================================================
 /**
- * The FilterKernel class provides methods to create/design a FIR filter kernel
+ * The FilterKernel class provides methods to create/design a FIR filter kernel. The Butterworth and Chebyshev design
+ * methods create causal IIR filters instead, which are stored as second order sections (see getSosCoefficients()).
+ * For those, the filter order is the order of the IIR prototype and the coefficients hold the impulse response
+ * truncated once it decayed. It is meant for plotting and tells how long the filter needs to settle from zero
+ * states. It is causal and not linear phase, so code paths which compensate a FIR delay of half the order have
+ * to run IIR filters through a FilterBiquad instead.
  *
  * @brief The FilterKernel class provides methods to create/design a FIR filter kernel
  */
@@ -86,7 +91,9 @@ public:
     enum DesignMethod {
         Cosine,
         Tschebyscheff,
-        External
+        External,
+        Butterworth,
+        Chebyshev
     } m_designMethod;
 
     enum FilterType {
@@ -114,7 +121,8 @@ public:
      * @param [in] dBandwidth       Ignored if FilterType is set to LPF,HPF. if NOTCH/BPF: bandwidth of stop-/passband - normed to sFreq/2 (nyquist)
      * @param [in] dParkswidth      Determines the width of the filter slopes (steepness) - normed to sFreq/2 (nyquist)
      * @param [in] dSFreq           The sampling frequency
-     * @param [in] designMethod     Specifies the design method to use. Choose between Cosind and Tschebyscheff
+     * @param [in] designMethod     Specifies the design method to use. Choose between Cosine and Tschebyscheff (FIR) or
+     *                              Butterworth and Chebyshev (IIR)
      **/
     FilterKernel(const QString &sFilterName,
                  FilterType type,
@@ -163,6 +171,20 @@ public:
     void applyFftFilter(Eigen::RowVectorXd& vecData,
                         bool bKeepOverhead = false);
 
+    //=========================================================================================================
+    /**
+     * Applies the current filter to all rows of the input data using multiplication in frequency domain. The rows
+     * are transposed into one zero padded column-major block, so that every channel is a contiguous column. All
+     * columns are transformed with the same FFT plan, multiplied with the filter spectrum in one vectorized
+     * operation and transformed back in place. This avoids the per channel setup cost of the RowVectorXd version.
+     *
+     * @param [in/out] matData              Holds the data to be filtered (channels x samples). Gets overwritten with its filtered result.
+     * @param [in] bKeepOverhead            Whether the result should still include the overhead information in front and back of the data.
+     *                                      Default is set to false.
+     */
+    void applyFftFilter(Eigen::MatrixXd& matData,
+                        bool bKeepOverhead = false);
+
     QString getName() const;
     void setName(const QString& sFilterName);
 
@@ -193,6 +215,22 @@ public:
     Eigen::RowVectorXcd getFftCoefficients() const;
     void setFftCoefficients(const Eigen::RowVectorXcd& vecFftCoeff);
 
+    //=========================================================================================================
+    /**
+     * Returns whether this is an IIR filter, i.e. whether it holds second order sections.
+     *
+     * @return true if the filter is an IIR filter, false otherwise
+     */
+    bool isIir() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the second order sections of an IIR filter, one per row: b0 b1 b2 a0 a1 a2. Empty for FIR filters.
+     *
+     * @return the second order sections
+     */
+    Eigen::MatrixXd getSosCoefficients() const;
+
 private:
     //=========================================================================================================
     /**
@@ -221,6 +259,7 @@ private:
 
     Eigen::RowVectorXd     m_vecCoeff;       /**< contains the forward filter coefficient set. */
     Eigen::RowVectorXcd    m_vecFftCoeff;    /**< the FFT-transformed forward filter coefficient set, required for frequency-domain filtering, zero-padded to m_iFftLength. */
+    Eigen::MatrixXd        m_matSos;         /**< the second order sections of IIR filters, empty for FIR filters. */
 };
 
 //=========================================================================================================
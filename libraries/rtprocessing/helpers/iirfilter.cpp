@@ -0,0 +1,337 @@
+//=============================================================================================================
+/**
+ * @file     iirfilter.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Definition of the IirFilter class
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "iirfilter.h"
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+
+#include <algorithm>
+#include <complex>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QDebug>
+#include <QVector>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+// STATIC DEFINITIONS
+//=============================================================================================================
+
+typedef std::complex<double> Complex;
+
+/**
+ * Returns the product of (dValue - root) over all roots.
+ */
+static Complex prodOfDiff(double dValue,
+                          const QVector<Complex>& vecRoots)
+{
+    Complex result(1.0, 0.0);
+    for(int i = 0; i < vecRoots.size(); ++i) {
+        result *= dValue - vecRoots[i];
+    }
+    return result;
+}
+
+//=============================================================================================================
+
+/**
+ * Turns a list of real or complex conjugated roots into polynomials 1 + c1*z^-1 + c2*z^-2. Complex conjugated roots
+ * form one polynomial each, sorted by their distance to the origin. The remaining real roots are paired first with
+ * last after sorting, a single left over root gives a first order polynomial (c2 = 0).
+ */
+static QVector<Vector2d> rootsToPolynomials(const QVector<Complex>& vecRoots)
+{
+    QVector<Complex> vecComplex;
+    QVector<double> vecReal;
+
+    for(int i = 0; i < vecRoots.size(); ++i) {
+        if(std::abs(vecRoots[i].imag()) <= 1e-10 * std::max(1.0, std::abs(vecRoots[i]))) {
+            vecReal.append(vecRoots[i].real());
+        } else if(vecRoots[i].imag() > 0) {
+            vecComplex.append(vecRoots[i]);
+        }
+    }
+
+    std::sort(vecComplex.begin(), vecComplex.end(), [](const Complex& a, const Complex& b) {
+        return std::abs(a) < std::abs(b);
+    });
+    std::sort(vecReal.begin(), vecReal.end());
+
+    QVector<Vector2d> vecPolys;
+
+    for(int i = 0; i < vecComplex.size(); ++i) {
+        vecPolys.append(Vector2d(-2.0 * vecComplex[i].real(), std::norm(vecComplex[i])));
+    }
+
+    int iFirst = 0;
+    int iLast = vecReal.size() - 1;
+    while(iFirst < iLast) {
+        vecPolys.append(Vector2d(-(vecReal[iFirst] + vecReal[iLast]), vecReal[iFirst] * vecReal[iLast]));
+        ++iFirst;
+        --iLast;
+    }
+    if(iFirst == iLast) {
+        vecPolys.append(Vector2d(-vecReal[iFirst], 0.0));
+    }
+
+    return vecPolys;
+}
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+IirFilter::IirFilter()
+{
+}
+
+//=============================================================================================================
+
+IirFilter::IirFilter(int iOrder,
+                     double dCenterFreq,
+                     double dBandwidth,
+                     TPassType type,
+                     TDesignType designType,
+                     double dRipple)
+{
+    if(iOrder < 1 || iOrder > 32) {
+        qWarning() << "[IirFilter::IirFilter] The order must be between 1 and 32. Clamping" << iOrder;
+        iOrder = qBound(1, iOrder, 32);
+    }
+
+    // Band edges normed to nyquist. Band pass and notch filters which touch 0 or nyquist degrade to low/high pass.
+    double dLow = dCenterFreq;
+    double dHigh = dCenterFreq;
+    if(type == BPF || type == NOTCH) {
+        dLow = dCenterFreq - dBandwidth/2;
+        dHigh = dCenterFreq + dBandwidth/2;
+
+        if(dLow <= 0.0) {
+            type = (type == BPF) ? LPF : HPF;
+            dLow = dHigh;
+        } else if(dHigh >= 1.0) {
+            type = (type == BPF) ? HPF : LPF;
+            dHigh = dLow;
+        }
+    }
+
+    if(dLow <= 0.0 || dHigh >= 1.0) {
+        qWarning() << "[IirFilter::IirFilter] Cut off frequencies must be between 0 and nyquist. Clamping.";
+        dLow = qBound(1e-6, dLow, 1.0 - 1e-6);
+        dHigh = qBound(1e-6, dHigh, 1.0 - 1e-6);
+    }
+
+    // Analog low pass prototype with a cut off of 1 rad/s
+    QVector<Complex> z, p;
+    double k = 1.0;
+
+    double dMu = 0.0;
+    double dEps = 0.0;
+    if(designType == Chebyshev) {
+        dEps = sqrt(pow(10.0, 0.1 * dRipple) - 1.0);
+        dMu = asinh(1.0 / dEps) / iOrder;
+    }
+
+    for(int m = -iOrder + 1; m < iOrder; m += 2) {
+        double dTheta = M_PI * m / (2.0 * iOrder);
+        if(designType == Chebyshev) {
+            p.append(-std::sinh(Complex(dMu, dTheta)));
+        } else {
+            p.append(-std::exp(Complex(0.0, dTheta)));
+        }
+    }
+
+    if(designType == Chebyshev) {
+        k = prodOfDiff(0.0, p).real();
+        if(iOrder % 2 == 0) {
+            k /= sqrt(1.0 + dEps * dEps);
+        }
+    }
+
+    // Prewarp the band edges for the bilinear transform (sampling frequency of 2, i.e. normed to nyquist)
+    const double fs = 2.0;
+    double dWarpedLow = 2.0 * fs * tan(M_PI * dLow / fs);
+    double dWarpedHigh = 2.0 * fs * tan(M_PI * dHigh / fs);
+
+    // Transform the prototype to the requested band
+    int iDegree = p.size() - z.size();
+
+    switch(type) {
+        case HPF: {
+            double wo = dWarpedLow;
+            k *= (prodOfDiff(0.0, z) / prodOfDiff(0.0, p)).real();
+            for(int i = 0; i < z.size(); ++i) {
+                z[i] = wo / z[i];
+            }
+            for(int i = 0; i < p.size(); ++i) {
+                p[i] = wo / p[i];
+            }
+            for(int i = 0; i < iDegree; ++i) {
+                z.append(Complex(0.0, 0.0));
+            }
+            break;
+        }
+
+        case BPF: {
+            double wo = sqrt(dWarpedLow * dWarpedHigh);
+            double bw = dWarpedHigh - dWarpedLow;
+            QVector<Complex> zBand, pBand;
+            for(int i = 0; i < z.size(); ++i) {
+                Complex zLp = z[i] * bw / 2.0;
+                Complex root = std::sqrt(zLp * zLp - wo * wo);
+                zBand << zLp + root << zLp - root;
+            }
+            for(int i = 0; i < p.size(); ++i) {
+                Complex pLp = p[i] * bw / 2.0;
+                Complex root = std::sqrt(pLp * pLp - wo * wo);
+                pBand << pLp + root << pLp - root;
+            }
+            for(int i = 0; i < iDegree; ++i) {
+                zBand.append(Complex(0.0, 0.0));
+            }
+            z = zBand;
+            p = pBand;
+            k *= pow(bw, iDegree);
+            break;
+        }
+
+        case NOTCH: {
+            double wo = sqrt(dWarpedLow * dWarpedHigh);
+            double bw = dWarpedHigh - dWarpedLow;
+            k *= (prodOfDiff(0.0, z) / prodOfDiff(0.0, p)).real();
+            QVector<Complex> zBand, pBand;
+            for(int i = 0; i < z.size(); ++i) {
+                Complex zHp = (bw / 2.0) / z[i];
+                Complex root = std::sqrt(zHp * zHp - wo * wo);
+                zBand << zHp + root << zHp - root;
+            }
+            for(int i = 0; i < p.size(); ++i) {
+                Complex pHp = (bw / 2.0) / p[i];
+                Complex root = std::sqrt(pHp * pHp - wo * wo);
+                pBand << pHp + root << pHp - root;
+            }
+            for(int i = 0; i < iDegree; ++i) {
+                zBand << Complex(0.0, wo) << Complex(0.0, -wo);
+            }
+            z = zBand;
+            p = pBand;
+            break;
+        }
+
+        default: {
+            double wo = dWarpedHigh;
+            for(int i = 0; i < z.size(); ++i) {
+                z[i] *= wo;
+            }
+            for(int i = 0; i < p.size(); ++i) {
+                p[i] *= wo;
+            }
+            k *= pow(wo, iDegree);
+            break;
+        }
+    }
+
+    // Bilinear transform to the z-plane
+    const double fs2 = 2.0 * fs;
+    iDegree = p.size() - z.size();
+    k *= (prodOfDiff(fs2, z) / prodOfDiff(fs2, p)).real();
+    for(int i = 0; i < z.size(); ++i) {
+        z[i] = (fs2 + z[i]) / (fs2 - z[i]);
+    }
+    for(int i = 0; i < p.size(); ++i) {
+        p[i] = (fs2 + p[i]) / (fs2 - p[i]);
+    }
+    for(int i = 0; i < iDegree; ++i) {
+        z.append(Complex(-1.0, 0.0));
+    }
+
+    // Group poles and zeros into second order sections. The gain is spread evenly over all sections to keep the
+    // intermediate values in the same range.
+    QVector<Vector2d> vecPoles = rootsToPolynomials(p);
+    QVector<Vector2d> vecZeros = rootsToPolynomials(z);
+
+    int iNumSections = vecPoles.size();
+    double dSectionGain = pow(std::abs(k), 1.0 / iNumSections);
+
+    m_matSos.resize(iNumSections, 6);
+    for(int i = 0; i < iNumSections; ++i) {
+        double dGain = (i == 0 && k < 0) ? -dSectionGain : dSectionGain;
+        m_matSos(i,0) = dGain;
+        m_matSos(i,1) = dGain * vecZeros[i][0];
+        m_matSos(i,2) = dGain * vecZeros[i][1];
+        m_matSos(i,3) = 1.0;
+        m_matSos(i,4) = vecPoles[i][0];
+        m_matSos(i,5) = vecPoles[i][1];
+    }
+}
+
+//=============================================================================================================
+
+RowVectorXd IirFilter::impulseResponse(int iLength) const
+{
+    RowVectorXd vecResponse = RowVectorXd::Zero(iLength);
+    if(iLength == 0) {
+        return vecResponse;
+    }
+    vecResponse[0] = 1.0;
+
+    // Direct form II transposed, one section after the other
+    for(int s = 0; s < m_matSos.rows(); ++s) {
+        double z1 = 0.0;
+        double z2 = 0.0;
+        for(int t = 0; t < iLength; ++t) {
+            double x = vecResponse[t];
+            double y = m_matSos(s,0) * x + z1;
+            z1 = m_matSos(s,1) * x - m_matSos(s,4) * y + z2;
+            z2 = m_matSos(s,2) * x - m_matSos(s,5) * y;
+            vecResponse[t] = y;
+        }
+    }
+
+    return vecResponse;
+}
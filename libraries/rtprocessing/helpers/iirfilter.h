@@ -0,0 +1,115 @@
+//=============================================================================================================
+/**
+ * @file     iirfilter.h
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Declaration of the IirFilter class
+ *
+ */
+
+#ifndef IIRFILTER_H
+#define IIRFILTER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../rtprocessing_global.h"
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE RTPROCESSINGLIB
+//=============================================================================================================
+
+namespace RTPROCESSINGLIB
+{
+
+//=============================================================================================================
+/**
+ * Designs a digital Butterworth or Chebyshev (type I) IIR filter. The analog prototype is transformed to the
+ * requested band with prewarped cut off frequencies and mapped to the z-plane with the bilinear transform. The
+ * result is returned as a cascade of second order sections, which is numerically far more robust than a single
+ * transfer function of the same order.
+ *
+ * @brief Designs Butterworth and Chebyshev IIR filters as second order sections.
+ */
+class RTPROCESINGSHARED_EXPORT IirFilter
+{
+public:
+    enum TPassType {LPF, HPF, BPF, NOTCH };
+
+    enum TDesignType {Butterworth, Chebyshev };
+
+    //=========================================================================================================
+    /**
+     * Constructs an empty IirFilter object.
+     */
+    IirFilter();
+
+    //=========================================================================================================
+    /**
+     * Constructs an IirFilter object.
+     *
+     * @param iOrder         the order of the analog prototype. Band pass and notch filters have twice as many poles.
+     * @param dCenterFreq    cut off frequency (LPF, HPF) or center frequency (BPF, NOTCH) normed to nyquist
+     * @param dBandwidth     width of the pass or stop band normed to nyquist. Ignored for LPF, HPF.
+     * @param type           filter type (lowpass, highpass, etc.)
+     * @param designType     Butterworth or Chebyshev
+     * @param dRipple        the pass band ripple in dB. Only used by the Chebyshev design. Default is 1 dB.
+     */
+    IirFilter(int iOrder,
+              double dCenterFreq,
+              double dBandwidth,
+              TPassType type,
+              TDesignType designType,
+              double dRipple = 1.0);
+
+    //=========================================================================================================
+    /**
+     * Computes the first samples of the impulse response of the section cascade.
+     *
+     * @param[in] iLength    the number of samples
+     *
+     * @return the impulse response
+     */
+    Eigen::RowVectorXd impulseResponse(int iLength) const;
+
+    Eigen::MatrixXd     m_matSos;       /**< the second order sections, one per row: b0 b1 b2 a0 a1 a2 with a0 = 1. */
+};
+} // NAMESPACE RTPROCESSINGLIB
+
+#endif // IIRFILTER_H
@@ -85,6 +85,7 @@ RtAveragingWorker::RtAveragingWorker(quint32 numAverages,
 , m_iTriggerChIndex(-1)
 , m_iNewTriggerIndex(iTriggerIndex)
 , m_bDoBaselineCorrection(false)
+, m_bComputeStdErr(false)
 , m_pairBaselineSec(qMakePair(float(iBaselineFromMSecs),float(iBaselineToMSecs)))
 , m_bActivateThreshold(false)
 {
@@ -137,6 +138,7 @@ void RtAveragingWorker::setAverageNumber(qint32 numAve)
             if(idx.value().size() > iDiff) {
                 //Pop data from buffer
                 for(int i = 0; i < iDiff; ++i) {
+                    updateRunningSums(idx.key(), idx.value().first(), -1.0);
                     idx.value().pop_front();
                 }
             }
@@ -229,6 +231,46 @@ void RtAveragingWorker::setBaselineTo(int toSamp,
 
 //=============================================================================================================
 
+void RtAveragingWorker::setStdErrActive(bool activate)
+{
+    if(activate == m_bComputeStdErr) {
+        return;
+    }
+
+    m_bComputeStdErr = activate;
+
+    if(m_bComputeStdErr) {
+        //Build the sums of squares from the stored epochs
+        QMapIterator<double,QList<Eigen::MatrixXd> > idx(m_mapStimAve);
+
+        while(idx.hasNext()) {
+            idx.next();
+
+            MatrixXd& matSumSq = m_mapStimAveSumSq[idx.key()];
+            matSumSq.resize(0,0);
+
+            for(int i = 0; i < idx.value().size(); ++i) {
+                if(matSumSq.size() == 0) {
+                    matSumSq = idx.value().at(i).cwiseAbs2();
+                } else {
+                    matSumSq += idx.value().at(i).cwiseAbs2();
+                }
+            }
+        }
+    } else {
+        m_mapStimAveSumSq.clear();
+
+        //Remove the standard error evokeds
+        for(int i = m_stimEvokedSet.evoked.size() - 1; i >= 0; --i) {
+            if(m_stimEvokedSet.evoked.at(i).aspect_kind == FIFFV_ASPECT_STD_ERR) {
+                m_stimEvokedSet.evoked.removeAt(i);
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
 void RtAveragingWorker::doAveraging(const MatrixXd& rawSegment)
 {
     //Detect trigger
@@ -441,11 +483,13 @@ void RtAveragingWorker::mergeData(double dTriggerType)
     if(!bArtifactDetected) {
         //Add cut data to average buffer
         m_mapStimAve[dTriggerType].append(mergedData);
+        updateRunningSums(dTriggerType, mergedData, 1.0);
 
         //Pop data from buffer
         int iDiff =  m_mapStimAve[dTriggerType].size() - m_iNumAverages;
         if(iDiff > 0) {
             for(int i = 0; i < iDiff; ++i) {
+                updateRunningSums(dTriggerType, m_mapStimAve[dTriggerType].first(), -1.0);
                 m_mapStimAve[dTriggerType].pop_front();
             }
         }
@@ -463,58 +507,146 @@ void RtAveragingWorker::generateEvoked(double dTriggerType)
 
     //Init evoked
     m_stimEvokedSet.info = *m_pFiffInfo.data();
-    FiffEvoked evoked;
-    evoked.setInfo(*m_pFiffInfo.data());
-    int iEvokedIdx = -1;
 
-    for(int i = 0; i < m_stimEvokedSet.evoked.size(); ++i) {
-        if(m_stimEvokedSet.evoked.at(i).comment == QString::number(dTriggerType)) {
-            evoked = m_stimEvokedSet.evoked.at(i);
-            iEvokedIdx = i;
-            break;
+    RowVectorXf times = RowVectorXf::LinSpaced(m_iPreStimSamples + m_iPostStimSamples,
+                                               -1*m_iPreStimSamples/m_pFiffInfo->sfreq,
+                                               m_iPostStimSamples/m_pFiffInfo->sfreq);
+    times[m_iPreStimSamples] = 0.0;
+
+    // Generate final evoked from the running sum
+    const int iNumAve = m_mapStimAve[dTriggerType].size();
+    const MatrixXd& matSum = m_mapStimAveSum[dTriggerType];
+
+    MatrixXd finalAverage = matSum / iNumAve;
+
+    if(m_bDoBaselineCorrection) {
+        //Same baseline range as MNEMath::rescale in mean mode, subtracted in place
+        qint32 imin = 0;
+        qint32 imax = times.size();
+
+        if(m_pairBaselineSec.second != m_pairBaselineSec.first) {
+            for(qint32 i = 0; i < times.size(); ++i) {
+                if(times[i] >= m_pairBaselineSec.first) {
+                    imin = i;
+                    break;
+                }
+            }
+        }
+
+        float bmax = m_pairBaselineSec.second == m_pairBaselineSec.first ? 0.0f : m_pairBaselineSec.second;
+
+        for(qint32 i = times.size()-1; i >= 0; --i) {
+            if(times[i] <= bmax) {
+                imax = i+1;
+                break;
+            }
+        }
+
+        if(imax > imin) {
+            VectorXd vecBaseline = finalAverage.middleCols(imin, imax - imin).rowwise().mean();
+            finalAverage.colwise() -= vecBaseline;
         }
     }
 
-    //If the evoked is not yet present add it here
-    if(iEvokedIdx == -1) {
-        evoked.baseline = m_pairBaselineSec;
-        evoked.times.resize(m_iPreStimSamples + m_iPostStimSamples);
-        evoked.times = RowVectorXf::LinSpaced(m_iPreStimSamples + m_iPostStimSamples,
-                                              -1*m_iPreStimSamples/m_pFiffInfo->sfreq,
-                                              m_iPostStimSamples/m_pFiffInfo->sfreq);
-        evoked.times[m_iPreStimSamples] = 0.0;
-        evoked.first = 0;
-        evoked.last = m_iPreStimSamples + m_iPostStimSamples;
-        evoked.comment = QString::number(dTriggerType);
+    updateEvoked(QString::number(dTriggerType), FIFFV_ASPECT_AVERAGE, times, finalAverage, iNumAve);
+
+    if(m_bComputeStdErr && m_mapStimAveSumSq.contains(dTriggerType)) {
+        //Standard error of the mean from the running sums, the baseline shift does not change it
+        MatrixXd matStdErr = MatrixXd::Zero(matSum.rows(), matSum.cols());
+
+        if(iNumAve > 1) {
+            matStdErr = ((m_mapStimAveSumSq[dTriggerType] - matSum.cwiseAbs2() / iNumAve) / (iNumAve - 1)).cwiseMax(0.0);
+            matStdErr = (matStdErr / iNumAve).cwiseSqrt();
+        }
+
+        updateEvoked(QString::number(dTriggerType) + "_stderr", FIFFV_ASPECT_STD_ERR, times, matStdErr, iNumAve);
     }
+}
+
+//=============================================================================================================
+
+void RtAveragingWorker::updateRunningSums(double dTriggerType,
+                                          const MatrixXd& matEpoch,
+                                          double dSign)
+{
+    MatrixXd& matSum = m_mapStimAveSum[dTriggerType];
+
+    if(matSum.rows() != matEpoch.rows() || matSum.cols() != matEpoch.cols()) {
+        if(dSign < 0.0) {
+            return;
+        }
+
+        //First epoch or changed epoch size, start over from the stored epochs of the new size
+        matSum = MatrixXd::Zero(matEpoch.rows(), matEpoch.cols());
+        if(m_bComputeStdErr) {
+            m_mapStimAveSumSq[dTriggerType] = MatrixXd::Zero(matEpoch.rows(), matEpoch.cols());
+        }
 
-    // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+        const QList<MatrixXd>& lEpochs = m_mapStimAve[dTriggerType];
 
-    for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-        finalAverage += m_mapStimAve[dTriggerType].at(i);
+        for(int i = 0; i < lEpochs.size() - 1; ++i) {
+            if(lEpochs.at(i).rows() == matEpoch.rows() && lEpochs.at(i).cols() == matEpoch.cols()) {
+                matSum += lEpochs.at(i);
+                if(m_bComputeStdErr) {
+                    m_mapStimAveSumSq[dTriggerType] += lEpochs.at(i).cwiseAbs2();
+                }
+            }
+        }
     }
 
-    if(!m_mapStimAve[dTriggerType].isEmpty()) {
-        finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
+    if(dSign > 0.0) {
+        matSum += matEpoch;
+    } else {
+        matSum -= matEpoch;
     }
 
-    if(m_bDoBaselineCorrection) {
-        finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
+    if(m_bComputeStdErr) {
+        MatrixXd& matSumSq = m_mapStimAveSumSq[dTriggerType];
+
+        if(matSumSq.rows() == matEpoch.rows() && matSumSq.cols() == matEpoch.cols()) {
+            if(dSign > 0.0) {
+                matSumSq += matEpoch.cwiseAbs2();
+            } else {
+                matSumSq -= matEpoch.cwiseAbs2();
+            }
+        }
     }
+}
 
-    evoked.data = finalAverage;
+//=============================================================================================================
 
-    evoked.nave = m_mapStimAve[dTriggerType].size();
+void RtAveragingWorker::updateEvoked(const QString& sComment,
+                                     fiff_int_t iAspectKind,
+                                     const RowVectorXf& times,
+                                     const MatrixXd& matData,
+                                     int iNave)
+{
+    int iEvokedIdx = -1;
+
+    for(int i = 0; i < m_stimEvokedSet.evoked.size(); ++i) {
+        if(m_stimEvokedSet.evoked.at(i).comment == sComment) {
+            iEvokedIdx = i;
+            break;
+        }
+    }
+
+    //If the evoked is not yet present add it here
+    if(iEvokedIdx == -1) {
+        FiffEvoked evoked;
+        evoked.setInfo(*m_pFiffInfo.data());
+        evoked.baseline = m_pairBaselineSec;
+        evoked.times = times;
+        evoked.first = 0;
+        evoked.last = m_iPreStimSamples + m_iPostStimSamples;
+        evoked.comment = sComment;
+        evoked.aspect_kind = iAspectKind;
 
-    //Add new data to evoked data set
-    if(iEvokedIdx != -1) {
-        //Evoked data is already present
-        m_stimEvokedSet.evoked[iEvokedIdx] = evoked;
-    } else {
-        //Evoked data is not present yet
         m_stimEvokedSet.evoked.append(evoked);
+        iEvokedIdx = m_stimEvokedSet.evoked.size() - 1;
     }
+
+    m_stimEvokedSet.evoked[iEvokedIdx].data = matData;
+    m_stimEvokedSet.evoked[iEvokedIdx].nave = iNave;
 }
 
 //=============================================================================================================
@@ -531,6 +663,8 @@ void RtAveragingWorker::reset()
 
     //Clear all maps
     m_mapStimAve.clear();
+    m_mapStimAveSum.clear();
+    m_mapStimAveSumSq.clear();
     m_mapDataPre.clear();
     m_mapDataPre[-1.0] = MatrixXd::Zero(m_pFiffInfo->chs.size(), m_iPreStimSamples);
     m_mapDataPost.clear();
@@ -588,6 +722,8 @@ RtAveraging::RtAveraging(quint32 numAverages,
             worker, &RtAveragingWorker::setBaselineFrom);
     connect(this, &RtAveraging::averageBaselineToChanged,
             worker, &RtAveragingWorker::setBaselineTo);
+    connect(this, &RtAveraging::averageStdErrActiveChanged,
+            worker, &RtAveragingWorker::setStdErrActive);
     connect(this, &RtAveraging::averageResetRequested,
             worker, &RtAveragingWorker::reset);
 
@@ -663,6 +799,8 @@ void RtAveraging::restart(quint32 numAverages,
             worker, &RtAveragingWorker::setBaselineFrom);
     connect(this, &RtAveraging::averageBaselineToChanged,
             worker, &RtAveragingWorker::setBaselineTo);
+    connect(this, &RtAveraging::averageStdErrActiveChanged,
+            worker, &RtAveragingWorker::setStdErrActive);
     connect(this, &RtAveraging::averageResetRequested,
             worker, &RtAveragingWorker::reset);
 
@@ -748,6 +886,13 @@ void RtAveraging::setBaselineTo(int toSamp,
 
 //=============================================================================================================
 
+void RtAveraging::setStdErrActive(bool activate)
+{
+    emit averageStdErrActiveChanged(activate);
+}
+
+//=============================================================================================================
+
 void RtAveraging::reset()
 {
     emit averageResetRequested();
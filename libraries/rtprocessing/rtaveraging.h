@@ -185,6 +185,15 @@ public:
     void setBaselineTo(int toSamp,
                        int toMSec);
 
+    //=========================================================================================================
+    /**
+     * Sets whether a standard error evoked is generated next to each average. Its comment is the trigger
+     * type followed by "_stderr".
+     *
+     * @param[in] activate    activate the standard error computation
+     */
+    void setStdErrActive(bool activate);
+
     //=========================================================================================================
     /**
      * Resets the averaged data stored.
@@ -227,6 +236,34 @@ protected:
      */
     void generateEvoked(double dTriggerType);
 
+    //=========================================================================================================
+    /**
+     * Adds an epoch to or removes it from the running sums of a trigger type.
+     *
+     * @param[in] dTriggerType   The trigger type.
+     * @param[in] matEpoch       The epoch.
+     * @param[in] dSign          1.0 to add the epoch, -1.0 to remove it.
+     */
+    void updateRunningSums(double dTriggerType,
+                           const Eigen::MatrixXd& matEpoch,
+                           double dSign);
+
+    //=========================================================================================================
+    /**
+     * Stores data in the evoked with the given comment, which is created if not present yet.
+     *
+     * @param[in] sComment       The comment identifying the evoked.
+     * @param[in] iAspectKind    The aspect kind, FIFFV_ASPECT_AVERAGE or FIFFV_ASPECT_STD_ERR.
+     * @param[in] times          The time points of the evoked.
+     * @param[in] matData        The evoked data.
+     * @param[in] iNave          The number of averaged epochs.
+     */
+    void updateEvoked(const QString& sComment,
+                      FIFFLIB::fiff_int_t iAspectKind,
+                      const Eigen::RowVectorXf& times,
+                      const Eigen::MatrixXd& matData,
+                      int iNave);
+
     //=========================================================================================================
     /**
      * Check if control values have been changed
@@ -249,6 +286,7 @@ protected:
     bool                                            m_bActivateThreshold;       /**< Whether to do threshold artifact reduction or not. */
 
     bool                                            m_bDoBaselineCorrection;    /**< Whether to perform baseline correction. */
+    bool                                            m_bComputeStdErr;           /**< Whether to generate standard error evokeds. */
 
     QPair<float,float>                              m_pairBaselineSec;          /**< Baseline information in seconds form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
     QPair<float,float>                              m_pairBaselineSamp;         /**< Baseline information in samples form where the seconds are seen relative to the trigger, meaning they can also be negative [from to]*/
@@ -258,6 +296,8 @@ protected:
 
     QMap<QString,double>                            m_mapThresholds;            /**< Holds the current thresholds for artifact rejection. */
     QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    QMap<double,Eigen::MatrixXd>                    m_mapStimAveSum;            /**< Running sum of the epochs in m_mapStimAve. */
+    QMap<double,Eigen::MatrixXd>                    m_mapStimAveSumSq;          /**< Running sum of the squared epochs in m_mapStimAve, only kept if m_bComputeStdErr is set. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding pre stim data. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding post stim data. */
     QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
@@ -423,6 +463,14 @@ public:
     void setBaselineTo(int toSamp,
                        int toMSec);
 
+    //=========================================================================================================
+    /**
+     * Sets whether a standard error evoked is generated next to each average
+     *
+     * @param[in] activate    activate the standard error computation
+     */
+    void setStdErrActive(bool activate);
+
     //=========================================================================================================
     /**
      * Reset the data processing in the real-time worker
@@ -455,6 +503,7 @@ signals:
                                     int fromMSec);
     void averageBaselineToChanged(int toSamp,
                                   int toMSec);
+    void averageStdErrActiveChanged(bool activate);
     void averageResetRequested();
 };
 
@@ -98,6 +98,78 @@ void RtConnectivityWorker::doWork(const ConnectivitySettings &connectivitySettin
     emit resultReady(finalNetworks, connectivitySettingsTemp);
 }
 
+//=============================================================================================================
+
+void RtConnectivityWorker::doWorkIncremental(const ConnectivitySettings &connectivitySettings,
+                                             int iWindowSize)
+{
+    if(this->thread()->isInterruptionRequested()) {
+        return;
+    }
+
+    if(connectivitySettings.getConnectivityMethods().isEmpty()) {
+        qDebug()<<"RtConnectivityWorker::doWorkIncremental() - Network methods are empty";
+        return;
+    }
+
+    // Drop the window if the dimensions of the new trials do not match the stored ones
+    if(!connectivitySettings.isEmpty() && !m_connectivitySettings.isEmpty()) {
+        if(connectivitySettings.at(0).matData.rows() != m_connectivitySettings.at(0).matData.rows() ||
+           connectivitySettings.at(0).matData.cols() != m_connectivitySettings.at(0).matData.cols()) {
+            m_connectivitySettings.clearAllData();
+        }
+    }
+
+    // The setters invalidate all cached intermediate data, so only call them on actual changes
+    if(m_connectivitySettings.getSamplingFrequency() != connectivitySettings.getSamplingFrequency()) {
+        m_connectivitySettings.setSamplingFrequency(connectivitySettings.getSamplingFrequency());
+    }
+
+    if(m_connectivitySettings.getFFTSize() != connectivitySettings.getFFTSize()) {
+        m_connectivitySettings.setFFTSize(connectivitySettings.getFFTSize());
+    }
+
+    if(m_connectivitySettings.getWindowType() != connectivitySettings.getWindowType()) {
+        m_connectivitySettings.setWindowType(connectivitySettings.getWindowType());
+    }
+
+    // Other methods need other intermediate data. The tapered spectra stay valid and are reused.
+    if(m_connectivitySettings.getConnectivityMethods() != connectivitySettings.getConnectivityMethods()) {
+        m_connectivitySettings.clearIntermediateData(true);
+        m_connectivitySettings.setConnectivityMethods(connectivitySettings.getConnectivityMethods());
+    }
+
+    m_connectivitySettings.setCompactNetworkStorage(connectivitySettings.isCompactNetworkStorage());
+    m_connectivitySettings.setNodePositions(connectivitySettings.getNodePositions());
+
+    for(int i = 0; i < connectivitySettings.size(); ++i) {
+        m_connectivitySettings.append(connectivitySettings.at(i).matData);
+    }
+
+    // Subtract the cached contributions of the trials which leave the window
+    if(iWindowSize > 0 && m_connectivitySettings.size() > iWindowSize) {
+        m_connectivitySettings.removeFirst(m_connectivitySettings.size() - iWindowSize);
+    }
+
+    if(m_connectivitySettings.isEmpty()) {
+        return;
+    }
+
+    // The cached intermediate data of the trials is only kept in storage mode. Only the new trials are computed
+    // and added to the sums, followed by the final normalization. The mode is set for this window only, so other
+    // connectivity computations are not affected.
+    m_connectivitySettings.setStorageModeActive(true);
+
+    QList<Network> finalNetworks = Connectivity::calculate(m_connectivitySettings);
+
+    // The window stays with the worker. Hand out the settings without the trials so that the receiver does not
+    // share, and later force a deep copy of, the cached data.
+    ConnectivitySettings connectivitySettingsTemp = m_connectivitySettings;
+    connectivitySettingsTemp.clearAllData();
+
+    emit resultReady(finalNetworks, connectivitySettingsTemp);
+}
+
 //=============================================================================================================
 // DEFINE MEMBER METHODS RtConnectivity
 //=============================================================================================================
@@ -114,6 +186,9 @@ RtConnectivity::RtConnectivity(QObject *parent)
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateIncremental,
+            worker, &RtConnectivityWorker::doWorkIncremental);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
@@ -136,6 +211,14 @@ void RtConnectivity::append(const ConnectivitySettings& connectivitySettings)
 
 //=============================================================================================================
 
+void RtConnectivity::appendIncremental(const ConnectivitySettings& connectivitySettings,
+                                       int iWindowSize)
+{
+    emit operateIncremental(connectivitySettings, iWindowSize);
+}
+
+//=============================================================================================================
+
 void RtConnectivity::restart()
 {
     stop();
@@ -149,6 +232,9 @@ void RtConnectivity::restart()
     connect(this, &RtConnectivity::operate,
             worker, &RtConnectivityWorker::doWork);
 
+    connect(this, &RtConnectivity::operateIncremental,
+            worker, &RtConnectivityWorker::doWorkIncremental);
+
     connect(worker, &RtConnectivityWorker::resultReady,
             this, &RtConnectivity::newConnectivityResultAvailable);
 
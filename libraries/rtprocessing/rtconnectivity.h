@@ -41,6 +41,8 @@
 
 #include "rtprocessing_global.h"
 
+#include <connectivity/connectivitysettings.h>
+
 //=============================================================================================================
 // EIGEN INCLUDES
 //=============================================================================================================
@@ -61,7 +63,6 @@ namespace FIFFLIB {
 }
 
 namespace CONNECTIVITYLIB {
-    class ConnectivitySettings;
     class Network;
 }
 
@@ -95,6 +96,24 @@ public:
      */
     void doWork(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Perform incremental connectivity estimation over a sliding window of trials. The worker keeps the trials
+     * of the window together with their cached intermediate data. Only the contributions of the new trials are
+     * added to the running PSD/CSD sums, trials leaving the window are subtracted via their cached contributions
+     * and the final normalization is recomputed. The cache is invalidated if the trial dimensions or the spectral
+     * parameters change. A change of the connectivity methods only recomputes the intermediate data from the cached
+     * tapered spectra.
+     *
+     * @param[in] connectivitySettings   The connectivity settings holding only the trials which were not sent before.
+     * @param[in] iWindowSize            The number of trials the connectivity is estimated over.
+     */
+    void doWorkIncremental(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                           int iWindowSize);
+
+protected:
+    CONNECTIVITYLIB::ConnectivitySettings     m_connectivitySettings;      /**< The trials of the current window and their cached intermediate data, used by the incremental mode. */
+
 signals:
     void resultReady(const  QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 };
@@ -135,6 +154,17 @@ public:
      */
     void append(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
+    //=========================================================================================================
+    /**
+     * Slot to receive incoming data for the incremental mode, see RtConnectivityWorker::doWorkIncremental. Only
+     * trials which were not sent before must be part of the connectivity settings. Restarting drops the window.
+     *
+     * @param[in] connectivitySettings   The connectivity settings holding the new trials.
+     * @param[in] iWindowSize            The number of trials the connectivity is estimated over.
+     */
+    void appendIncremental(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                           int iWindowSize);
+
     //=========================================================================================================
     /**
      * Restarts the thread by interrupting its computation queue, quitting, waiting and then starting it again.
@@ -154,6 +184,9 @@ signals:
     void newConnectivityResultAvailable(const QList<CONNECTIVITYLIB::Network>& connectivityResults, const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
 
     void operate(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings);
+
+    void operateIncremental(const CONNECTIVITYLIB::ConnectivitySettings& connectivitySettings,
+                            int iWindowSize);
 };
 
 //=============================================================================================================
@@ -40,13 +40,13 @@
 
 #include "rtcov.h"
 
+#include <cmath>
 
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
 #include <QDebug>
-#include <QtConcurrent>
 
 //=============================================================================================================
 // USED NAMESPACES
@@ -61,9 +61,11 @@ using namespace Eigen;
 //=============================================================================================================
 
 RtCov::RtCov(QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo)
-: m_fiffInfo(*pFiffInfo)
-, m_iSamples(0)
+: m_windowMode(Block)
+, m_iUpdateInterval(0)
+, m_fiffInfo(*pFiffInfo)
 {
+    reset();
 }
 
 //=============================================================================================================
@@ -76,72 +78,102 @@ FiffCov RtCov::estimateCovariance(const Eigen::MatrixXd& matData,
         return FiffCov();
     }
 
-    m_lData.append(matData);
-    m_iSamples += matData.cols();
-
-    if(m_iSamples < iNewMaxSamples) {
+    if(matData.cols() == 0) {
         return FiffCov();
     }
 
-    QFuture<RtCovComputeResult> result = QtConcurrent::mappedReduced(m_lData,
-                                                                     compute,
-                                                                     reduce);
+    RtCovComputeResult blockResult = compute(matData);
+    m_iSamples += matData.cols();
+    m_iSamplesSinceUpdate += matData.cols();
 
-    result.waitForFinished();
+    const int iUpdateInterval = m_iUpdateInterval > 0 ? m_iUpdateInterval : iNewMaxSamples;
 
-    RtCovComputeResult finalResult = result.result();
+    switch(m_windowMode) {
+        case Sliding: {
+            reduce(m_chunkResult, blockResult);
 
-    //Final computation
-    FiffCov computedCov;
-    computedCov.data = finalResult.matData;
+            if(m_iSamplesSinceUpdate < iUpdateInterval) {
+                return FiffCov();
+            }
 
-    QStringList exclude;
-    for(int i = 0; i<m_fiffInfo.chs.size(); i++) {
-        if(m_fiffInfo.chs.at(i).kind != FIFFV_MEG_CH &&
-           m_fiffInfo.chs.at(i).kind != FIFFV_EEG_CH) {
-            exclude << m_fiffInfo.chs.at(i).ch_name;
-        }
-    }
-    bool doProj = true;
+            // Close the update interval and drop the oldest ones which are no longer needed to fill the window
+            reduce(m_accResult, m_chunkResult);
+            m_lChunkResults.append(m_chunkResult);
+            m_chunkResult = RtCovComputeResult();
+            m_chunkResult.dN = 0.0;
+            m_iSamplesSinceUpdate = 0;
+
+            while(m_lChunkResults.size() > 1 && m_accResult.dN - m_lChunkResults.first().dN >= iNewMaxSamples) {
+                remove(m_accResult, m_lChunkResults.takeFirst());
+            }
 
-    if(m_iSamples > 0) {
-        finalResult.mu /= (float)m_iSamples;
-        computedCov.data.array() -= m_iSamples * (finalResult.mu * finalResult.mu.transpose()).array();
-        computedCov.data.array() /= (m_iSamples - 1);
+            if(m_accResult.dN < iNewMaxSamples) {
+                return FiffCov();
+            }
 
-        computedCov.kind = FIFFV_MNE_NOISE_COV;
-        computedCov.diag = false;
-        computedCov.dim = computedCov.data.rows();
+            return makeCovariance(m_accResult);
+        }
 
-        //ToDo do picks
-        computedCov.names = m_fiffInfo.ch_names;
-        computedCov.projs = m_fiffInfo.projs;
-        computedCov.bads = m_fiffInfo.bads;
-        computedCov.nfree = m_iSamples;
+        case Exponential: {
+            // Forget with a time constant of one window
+            if(m_accResult.dN > 0.0) {
+                const double dForget = std::exp(-blockResult.dN / qMax(iNewMaxSamples, 1));
+                m_accResult.dN *= dForget;
+                m_accResult.matData *= dForget;
+            }
+            reduce(m_accResult, blockResult);
 
-        // regularize noise covariance
-        computedCov = computedCov.regularize(m_fiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+            if(m_iSamples < iNewMaxSamples || m_iSamplesSinceUpdate < iUpdateInterval) {
+                return FiffCov();
+            }
 
-//            qint32 samples = rawSegment.cols();
-//            VectorXf mu = rawSegment.rowwise().sum().array() / (float)samples;
+            m_iSamplesSinceUpdate = 0;
 
-//            MatrixXf noise_covariance = rawSegment * rawSegment.transpose();// noise_covariance == raw_covariance
-//            noise_covariance.array() -= samples * (mu * mu.transpose()).array();
-//            noise_covariance.array() /= (samples - 1);
+            return makeCovariance(m_accResult);
+        }
 
-//            std::cout << "Noise Covariance:\n" << noise_covariance.block(0,0,10,10) << std::endl;
+        default: {
+            reduce(m_accResult, blockResult);
 
-//            printf("%d raw buffer (%d x %d) generated\r\n", count, tmp.rows(), tmp.cols());
+            if(m_accResult.dN < iNewMaxSamples) {
+                return FiffCov();
+            }
 
-        m_lData.clear();
-        m_iSamples = 0;
+            FiffCov computedCov = makeCovariance(m_accResult);
+            reset();
 
-        return computedCov;
-    } else {
-        qWarning() << "[RtCov::estimateCovariance] Number of samples equals zero. Regularization not possible. Returning empty covariance estimation.";
-        return FiffCov();
+            return computedCov;
+        }
     }
+}
+
+//=============================================================================================================
 
+void RtCov::setWindowMode(WindowMode mode)
+{
+    m_windowMode = mode;
+    reset();
+}
+
+//=============================================================================================================
+
+void RtCov::setUpdateInterval(int iSamples)
+{
+    m_iUpdateInterval = qMax(iSamples, 0);
+}
+
+//=============================================================================================================
+
+void RtCov::reset()
+{
+    m_iSamples = 0;
+    m_iSamplesSinceUpdate = 0;
+
+    m_accResult = RtCovComputeResult();
+    m_accResult.dN = 0.0;
+    m_chunkResult = RtCovComputeResult();
+    m_chunkResult.dN = 0.0;
+    m_lChunkResults.clear();
 }
 
 //=============================================================================================================
@@ -149,8 +181,13 @@ FiffCov RtCov::estimateCovariance(const Eigen::MatrixXd& matData,
 RtCovComputeResult RtCov::compute(const MatrixXd &matData)
 {
     RtCovComputeResult result;
-    result.mu = matData.rowwise().sum();
-    result.matData = matData * matData.transpose();
+    result.dN = matData.cols();
+    result.mu = matData.rowwise().mean();
+
+    MatrixXd matCentered = matData.colwise() - result.mu;
+    result.matData = MatrixXd::Zero(matData.rows(), matData.rows());
+    result.matData.selfadjointView<Lower>().rankUpdate(matCentered);
+
     return result;
 }
 
@@ -158,11 +195,81 @@ RtCovComputeResult RtCov::compute(const MatrixXd &matData)
 
 void RtCov::reduce(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult)
 {
-    if(finalResult.matData.size() == 0 || finalResult.mu.size() == 0) {
-        finalResult.mu = tempResult.mu;
-        finalResult.matData = tempResult.matData;
-    } else {
-        finalResult.mu += tempResult.mu;
-        finalResult.matData += tempResult.matData;
+    if(tempResult.dN <= 0.0) {
+        return;
+    }
+
+    if(finalResult.dN <= 0.0 || finalResult.mu.size() != tempResult.mu.size()) {
+        finalResult = tempResult;
+        return;
+    }
+
+    // Pairwise update of the co-moment (Chan et al.)
+    const double dN = finalResult.dN + tempResult.dN;
+    VectorXd vecDelta = tempResult.mu - finalResult.mu;
+
+    finalResult.matData += tempResult.matData;
+    finalResult.matData.selfadjointView<Lower>().rankUpdate(vecDelta, finalResult.dN * tempResult.dN / dN);
+    finalResult.mu += vecDelta * (tempResult.dN / dN);
+    finalResult.dN = dN;
+}
+
+//=============================================================================================================
+
+void RtCov::remove(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult)
+{
+    const double dN = finalResult.dN - tempResult.dN;
+
+    if(dN <= 0.0 || finalResult.mu.size() != tempResult.mu.size()) {
+        finalResult = RtCovComputeResult();
+        finalResult.dN = 0.0;
+        return;
+    }
+
+    // Inverse of the pairwise update in reduce()
+    VectorXd vecMu = (finalResult.dN * finalResult.mu - tempResult.dN * tempResult.mu) / dN;
+    VectorXd vecDelta = tempResult.mu - vecMu;
+
+    finalResult.matData -= tempResult.matData;
+    finalResult.matData.selfadjointView<Lower>().rankUpdate(vecDelta, -dN * tempResult.dN / finalResult.dN);
+    finalResult.mu = vecMu;
+    finalResult.dN = dN;
+}
+
+//=============================================================================================================
+
+FiffCov RtCov::makeCovariance(const RtCovComputeResult &result) const
+{
+    if(result.dN <= 1.0) {
+        qWarning() << "[RtCov::makeCovariance] Not enough samples. Regularization not possible. Returning empty covariance estimation.";
+        return FiffCov();
     }
+
+    FiffCov computedCov;
+    computedCov.data = result.matData.selfadjointView<Lower>();
+    computedCov.data /= (result.dN - 1.0);
+
+    QStringList exclude;
+    for(int i = 0; i<m_fiffInfo.chs.size(); i++) {
+        if(m_fiffInfo.chs.at(i).kind != FIFFV_MEG_CH &&
+           m_fiffInfo.chs.at(i).kind != FIFFV_EEG_CH) {
+            exclude << m_fiffInfo.chs.at(i).ch_name;
+        }
+    }
+    bool doProj = true;
+
+    computedCov.kind = FIFFV_MNE_NOISE_COV;
+    computedCov.diag = false;
+    computedCov.dim = computedCov.data.rows();
+
+    //ToDo do picks
+    computedCov.names = m_fiffInfo.ch_names;
+    computedCov.projs = m_fiffInfo.projs;
+    computedCov.bads = m_fiffInfo.bads;
+    computedCov.nfree = qRound(result.dN);
+
+    // regularize noise covariance
+    computedCov = computedCov.regularize(m_fiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+
+    return computedCov;
 }
@@ -51,6 +51,7 @@
 
 #include <QSharedPointer>
 #include <QThread>
+#include <QList>
 
 //=============================================================================================================
 // EIGEN INCLUDES
@@ -78,13 +79,15 @@ namespace RTPROCESSINGLIB
 //=============================================================================================================
 
 struct RtCovComputeResult {
-    Eigen::VectorXd mu;
-    Eigen::MatrixXd matData;
+    double          dN;             /**< The (effective) number of samples. */
+    Eigen::VectorXd mu;             /**< The mean of the samples. */
+    Eigen::MatrixXd matData;        /**< The co-moment sum((x - mu)(x - mu)'), only the lower triangle is valid. */
 };
 
 //=============================================================================================================
 /**
- * Real-time covariance worker.
+ * Real-time covariance worker. The incoming blocks are reduced to their mean and co-moment right away, so the
+ * state is O(channels^2) and no raw data is kept.
  *
  * @brief Real-time covariance worker.
  */
@@ -93,42 +96,98 @@ class RTPROCESINGSHARED_EXPORT RtCov : public QObject
     Q_OBJECT
 
 public:
+    enum WindowMode {
+        Block,                      /**< Estimate over consecutive, non-overlapping windows (default). */
+        Sliding,                    /**< Estimate over the last window, which moves on by the update interval. */
+        Exponential                 /**< Exponentially forget old samples with a time constant of one window. */
+    };
+
     RtCov(QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
 
     //=========================================================================================================
     /**
      * Perform actual covariance estimation.
      *
-     * @param[in] inputData  Data to estimate the covariance from.
+     * @param[in] inputData          Data to estimate the covariance from.
+     * @param[in] iNewMaxSamples     The window length in samples.
+     *
+     * @return   The covariance estimate, empty if no new estimate is due.
      */
     FIFFLIB::FiffCov estimateCovariance(const Eigen::MatrixXd& matData,
                                         int iNewMaxSamples);
 
+    //=========================================================================================================
+    /**
+     * Sets how the samples are windowed. Resets the accumulated data.
+     *
+     * @param[in] mode   The window mode.
+     */
+    void setWindowMode(WindowMode mode);
+
+    //=========================================================================================================
+    /**
+     * Sets after how many new samples an estimate is returned in the Sliding and Exponential modes, once the
+     * first window is complete. 0 (default) returns an estimate once per window length.
+     *
+     * @param[in] iSamples   The update interval in samples.
+     */
+    void setUpdateInterval(int iSamples);
+
+    //=========================================================================================================
+    /**
+     * Discards the accumulated data.
+     */
+    void reset();
+
 protected:
     //=========================================================================================================
     /**
-     * Computer multiplication with transposed.
+     * Computes the mean and the co-moment of a data block.
      *
-     * @param[in] matData  Data to self multiply with.
+     * @param[in] matData  The data block.
      *
-     * @return   The multiplication result.
+     * @return   The block moments.
      */
     static RtCovComputeResult compute(const Eigen::MatrixXd &matData);
 
     //=========================================================================================================
     /**
-     * Computer multiplication with transposed.
+     * Adds the moments of a block to the accumulated ones.
      *
-     * @param[out]   finalResult     The final covariance estimation.
-     * @param[in]    tempResult      The intermediate result from the compute function
+     * @param[out]   finalResult     The accumulated moments.
+     * @param[in]    tempResult      The block moments from the compute function.
      */
     static void reduce(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult);
 
-    int                     m_iSamples;                 /**< The number of stored samples. */
+    //=========================================================================================================
+    /**
+     * Subtracts the moments of a block, which were added before, from the accumulated ones.
+     *
+     * @param[out]   finalResult     The accumulated moments.
+     * @param[in]    tempResult      The block moments to remove.
+     */
+    static void remove(RtCovComputeResult& finalResult, const RtCovComputeResult &tempResult);
+
+    //=========================================================================================================
+    /**
+     * Creates the regularized covariance from the accumulated moments.
+     *
+     * @param[in] result     The accumulated moments.
+     *
+     * @return   The covariance.
+     */
+    FIFFLIB::FiffCov makeCovariance(const RtCovComputeResult &result) const;
+
+    WindowMode                  m_windowMode;               /**< The window mode. */
+    int                         m_iUpdateInterval;          /**< Samples between two estimates, 0 for one per window. */
+    qint64                      m_iSamples;                 /**< The number of samples seen since the last reset. */
+    int                         m_iSamplesSinceUpdate;      /**< The number of samples since the last estimate. */
 
-    QList<Eigen::MatrixXd>  m_lData;                    /**< The stored data blocks. */
+    RtCovComputeResult          m_accResult;                /**< The moments of the current window. */
+    RtCovComputeResult          m_chunkResult;              /**< The moments of the samples since the last estimate (Sliding mode). */
+    QList<RtCovComputeResult>   m_lChunkResults;            /**< The moments of the update intervals in the current window (Sliding mode). */
 
-    FIFFLIB::FiffInfo       m_fiffInfo;                 /**< Holds the fiff measurement information. */
+    FIFFLIB::FiffInfo           m_fiffInfo;                 /**< Holds the fiff measurement information. */
 };
 
 //=============================================================================================================
@@ -93,6 +93,7 @@ SOURCES += \
     helpers/cosinefilter.cpp \
     helpers/parksmcclellan.cpp \
     helpers/filterkernel.cpp \
+    helpers/iirfilter.cpp \
     helpers/filterio.cpp \
 
 HEADERS +=  \
@@ -111,6 +112,7 @@ HEADERS +=  \
     helpers/cosinefilter.h \
     helpers/parksmcclellan.h \
     helpers/filterkernel.h \
+    helpers/iirfilter.h \
     helpers/filterio.h \
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
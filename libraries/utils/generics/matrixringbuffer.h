@@ -0,0 +1,381 @@
+//=============================================================================================================
+/**
+ * @file     matrixringbuffer.h
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief     MatrixRingBuffer class declaration
+ *
+ */
+
+#ifndef MATRIXRINGBUFFER_H
+#define MATRIXRINGBUFFER_H
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+#include <vector>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QThread>
+
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+//=============================================================================================================
+// DEFINE NAMESPACE UTILSLIB
+//=============================================================================================================
+
+namespace UTILSLIB
+{
+
+//=============================================================================================================
+/**
+ * TEMPLATE MATRIX RING BUFFER
+ *
+ * @brief Lock-free single producer/single consumer ring of preallocated matrix slots.
+ *
+ * The slots are allocated once with a fixed shape. The producer fills a slot in place (beginWrite/commitWrite)
+ * or copies into it (push), the consumer works on a slot in place (beginRead/commitRead) or swaps its content
+ * out (pop). Swapping hands the slot storage over without copying and leaves the consumer's previous buffer
+ * in the slot for reuse. Exactly one thread may write and exactly one thread may read at a time.
+ */
+template<typename _Tp>
+class MatrixRingBuffer
+{
+public:
+    typedef QSharedPointer<MatrixRingBuffer> SPtr;              /**< Shared pointer type for MatrixRingBuffer. */
+    typedef QSharedPointer<const MatrixRingBuffer> ConstSPtr;   /**< Const shared pointer type for MatrixRingBuffer. */
+
+    typedef Eigen::Matrix<_Tp, Eigen::Dynamic, Eigen::Dynamic> MatrixType;  /**< Slot matrix type. */
+
+    //=========================================================================================================
+    /**
+     * Constructs a MatrixRingBuffer.
+     *
+     * @param [in] uiMaxNumElements  number of slots.
+     * @param [in] iRows             number of rows each slot is preallocated with.
+     * @param [in] iCols             number of columns each slot is preallocated with.
+     */
+    explicit MatrixRingBuffer(unsigned int uiMaxNumElements,
+                              int iRows = 0,
+                              int iCols = 0);
+
+    //=========================================================================================================
+    /**
+     * Reallocates all slots to the given shape. Must not be called while a producer or consumer is active.
+     *
+     * @param [in] iRows     number of rows.
+     * @param [in] iCols     number of columns.
+     */
+    void resize(int iRows,
+                int iCols);
+
+    //=========================================================================================================
+    /**
+     * Returns the next free slot for in place writing, or a null pointer if the buffer is full.
+     * The slot is published with commitWrite.
+     *
+     * @return the slot to write to.
+     */
+    inline MatrixType* beginWrite();
+
+    //=========================================================================================================
+    /**
+     * Publishes the slot returned by the last successful beginWrite to the consumer.
+     */
+    inline void commitWrite();
+
+    //=========================================================================================================
+    /**
+     * Returns the oldest filled slot for in place reading, or a null pointer if the buffer is empty.
+     * The slot is released with commitRead.
+     *
+     * @return the slot to read from.
+     */
+    inline MatrixType* beginRead();
+
+    //=========================================================================================================
+    /**
+     * Releases the slot returned by the last successful beginRead back to the producer.
+     */
+    inline void commitRead();
+
+    //=========================================================================================================
+    /**
+     * Copies an element into the next free slot. Waits until a slot is free or the timeout has expired.
+     * No memory is allocated as long as the element matches the slot shape.
+     *
+     * @param [in] newElement    the element to add.
+     *
+     * @return true if the element was added, false on timeout.
+     */
+    inline bool push(const MatrixType& newElement);
+
+    //=========================================================================================================
+    /**
+     * Swaps the oldest element out of the buffer (first in first out). Waits until an element is available or
+     * the timeout has expired. The previous storage of element is kept in the slot and reused by the producer.
+     *
+     * @param [out] element      the oldest element.
+     *
+     * @return true if an element was returned, false on timeout.
+     */
+    inline bool pop(MatrixType& element);
+
+    //=========================================================================================================
+    /**
+     * Clears the buffer. Must not be called while a producer or consumer is active.
+     */
+    void clear();
+
+    //=========================================================================================================
+    /**
+     * Returns the number of elements available for reading.
+     */
+    inline int getFreeElementsRead() const;
+
+    //=========================================================================================================
+    /**
+     * Returns the number of slots available for writing.
+     */
+    inline int getFreeElementsWrite() const;
+
+private:
+    //=========================================================================================================
+    /**
+     * Waits until the given check succeeds or the timeout has expired.
+     *
+     * @param [in] pCheck    pointer to the member function to poll.
+     *
+     * @return the last result of the check.
+     */
+    inline bool waitFor(int (MatrixRingBuffer::*pCheck)() const);
+
+    //=========================================================================================================
+    /**
+     * Returns the slot index following the given one.
+     *
+     * @param [in] index     the slot index.
+     *
+     * @return the next slot index.
+     */
+    inline int nextIndex(int index) const;
+
+    int                         m_iNumSlots;            /**< Holds the number of slots, one more than the number of elements the buffer can hold.*/
+    std::vector<MatrixType>     m_vecSlots;             /**< Holds the preallocated slots.*/
+    QAtomicInt                  m_iReadIndex;           /**< Holds the index of the next slot to read. Only the consumer stores to it.*/
+    QAtomicInt                  m_iWriteIndex;          /**< Holds the index of the next slot to write. Only the producer stores to it.*/
+    int                         m_iTimeout;             /**< Holds the timeout value in ms after which push and pop will return false.*/
+};
+
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+MatrixRingBuffer<_Tp>::MatrixRingBuffer(unsigned int uiMaxNumElements,
+                                        int iRows,
+                                        int iCols)
+: m_iNumSlots(static_cast<int>(uiMaxNumElements) + 1)
+, m_vecSlots(m_iNumSlots, MatrixType(iRows, iCols))
+, m_iReadIndex(0)
+, m_iWriteIndex(0)
+, m_iTimeout(1000)
+{
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+void MatrixRingBuffer<_Tp>::resize(int iRows,
+                                   int iCols)
+{
+    for(MatrixType& matSlot : m_vecSlots) {
+        matSlot.resize(iRows, iCols);
+    }
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline typename MatrixRingBuffer<_Tp>::MatrixType* MatrixRingBuffer<_Tp>::beginWrite()
+{
+    const int iWrite = m_iWriteIndex.loadAcquire();
+
+    if(nextIndex(iWrite) == m_iReadIndex.loadAcquire()) {
+        return Q_NULLPTR;
+    }
+
+    return &m_vecSlots[iWrite];
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline void MatrixRingBuffer<_Tp>::commitWrite()
+{
+    m_iWriteIndex.storeRelease(nextIndex(m_iWriteIndex.loadAcquire()));
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline typename MatrixRingBuffer<_Tp>::MatrixType* MatrixRingBuffer<_Tp>::beginRead()
+{
+    const int iRead = m_iReadIndex.loadAcquire();
+
+    if(iRead == m_iWriteIndex.loadAcquire()) {
+        return Q_NULLPTR;
+    }
+
+    return &m_vecSlots[iRead];
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline void MatrixRingBuffer<_Tp>::commitRead()
+{
+    m_iReadIndex.storeRelease(nextIndex(m_iReadIndex.loadAcquire()));
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool MatrixRingBuffer<_Tp>::push(const MatrixType& newElement)
+{
+    if(!waitFor(&MatrixRingBuffer::getFreeElementsWrite)) {
+        return false;
+    }
+
+    *beginWrite() = newElement;
+    commitWrite();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool MatrixRingBuffer<_Tp>::pop(MatrixType& element)
+{
+    if(!waitFor(&MatrixRingBuffer::getFreeElementsRead)) {
+        return false;
+    }
+
+    element.swap(*beginRead());
+    commitRead();
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+void MatrixRingBuffer<_Tp>::clear()
+{
+    m_iReadIndex.storeRelease(0);
+    m_iWriteIndex.storeRelease(0);
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline int MatrixRingBuffer<_Tp>::getFreeElementsRead() const
+{
+    const int iUsed = m_iWriteIndex.loadAcquire() - m_iReadIndex.loadAcquire();
+
+    return iUsed < 0 ? iUsed + m_iNumSlots : iUsed;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline int MatrixRingBuffer<_Tp>::getFreeElementsWrite() const
+{
+    return m_iNumSlots - 1 - getFreeElementsRead();
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline bool MatrixRingBuffer<_Tp>::waitFor(int (MatrixRingBuffer::*pCheck)() const)
+{
+    if((this->*pCheck)() > 0) {
+        return true;
+    }
+
+    // Spin briefly for low latency, then back off so an idle consumer does not burn a core
+    QElapsedTimer timer;
+    timer.start();
+
+    for(int i = 0; (this->*pCheck)() <= 0; ++i) {
+        if(timer.elapsed() >= m_iTimeout) {
+            return false;
+        }
+
+        if(i < 64) {
+            QThread::yieldCurrentThread();
+        } else {
+            QThread::usleep(50);
+        }
+    }
+
+    return true;
+}
+
+//=============================================================================================================
+
+template<typename _Tp>
+inline int MatrixRingBuffer<_Tp>::nextIndex(int index) const
+{
+    return ++index == m_iNumSlots ? 0 : index;
+}
+
+//=============================================================================================================
+// TYPEDEF
+//=============================================================================================================
+
+typedef MatrixRingBuffer<double>    MatrixRingBuffer_double;    /**< Defines MatrixRingBuffer of Eigen::MatrixXd slots.*/
+typedef MatrixRingBuffer<float>     MatrixRingBuffer_float;     /**< Defines MatrixRingBuffer of Eigen::MatrixXf slots.*/
+
+} // NAMESPACE
+
+#endif // MATRIXRINGBUFFER_H
@@ -88,6 +88,7 @@ HEADERS += \
     sphere.h \
     simplex_algorithm.h \
     generics/circularbuffer.h \
+    generics/matrixringbuffer.h \
     generics/commandpattern.h \
     generics/observerpattern.h \
     generics/applicationlogger.h \
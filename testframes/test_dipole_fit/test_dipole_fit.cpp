@@ -70,6 +70,7 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitParallel();
     void cleanupTestCase();
 
 private:
@@ -258,6 +259,56 @@ void TestDipoleFit::dipoleFitAdvanced()
 
 //=============================================================================================================
 
+void TestDipoleFit::dipoleFitParallel()
+{
+    QString refFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/ref_dip_fit.dat");
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Dipole Fit Settings >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    //Same as dipoleFitSimple with --threads 4, the time points are fitted independently so the result has to match
+    DipoleFitSettings settings;
+    testFile.setFileName(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = true;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+    settings.nthreads = 4;
+    settings.dipname = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/dip_fit_parallel.dat";
+
+    settings.checkIntegrity();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Dipole Fit Settings Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    //*********************************************************************************************************
+    // Compute Dipole Fit
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute Parallel Dipole Fit >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    DipoleFit dipFit(&settings);
+    ECDSet set = dipFit.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute Parallel Dipole Fit Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    set.save_dipoles_dip(settings.dipname);
+    m_ECDSet = ECDSet::read_dipoles_dip(settings.dipname);
+    m_refECDSet = ECDSet::read_dipoles_dip(refFileName);
+
+    compareFit();
+}
+
+//=============================================================================================================
+
 void TestDipoleFit::compareFit()
 {
     //*********************************************************************************************************
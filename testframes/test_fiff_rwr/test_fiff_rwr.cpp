@@ -57,6 +57,45 @@
 using namespace FIFFLIB;
 using namespace Eigen;
 
+//=============================================================================================================
+/**
+ * DECLARE CLASS GatedFile
+ *
+ * @brief The GatedFile class is a QFile whose writes can be held back, to simulate a disk which can not keep up
+ *
+ */
+class GatedFile : public QFile
+{
+public:
+    GatedFile(const QString& sName)
+    : QFile(sName)
+    , m_bGated(false)
+    {
+    }
+
+    void setGated(bool bGated)
+    {
+        m_bGated.storeRelease(bGated ? 1 : 0);
+        if(!bGated) {
+            m_semGate.release();
+        }
+    }
+
+protected:
+    qint64 writeData(const char* data, qint64 len) override
+    {
+        if(m_bGated.loadAcquire()) {
+            m_semGate.acquire();
+            m_semGate.release();
+        }
+        return QFile::writeData(data, len);
+    }
+
+private:
+    QAtomicInt  m_bGated;
+    QSemaphore  m_semGate;
+};
+
 //=============================================================================================================
 /**
  * DECLARE CLASS TestFiffRWR
@@ -76,6 +115,14 @@ private slots:
     void compareData();
     void compareTimes();
     void compareInfo();
+    void compareMappedData();
+    void compareSelectedData();
+    void compareAsyncWrittenData();
+    void compareAsyncSkippedData();
+    void compareCachedDir();
+    void compareSinglePrecisionData();
+    void compareUncalibratedData();
+    void compareProjectedData();
     void cleanupTestCase();
 
 private:
@@ -308,6 +355,346 @@ void TestFiffRWR::compareInfo()
 
 //=============================================================================================================
 
+void TestFiffRWR::compareMappedData()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp + 100;
+    fiff_int_t to = from + 2*ceil(rawFirstInRaw.info.sfreq);
+
+    MatrixXd mData, mTimes;
+    QVERIFY( rawFirstInRaw.read_raw_segment(mData, mTimes, from, to) );
+
+    QVERIFY( rawFirstInRaw.file->map_file() );
+
+    MatrixXd mMappedData, mMappedTimes;
+    QVERIFY( rawFirstInRaw.read_raw_segment(mMappedData, mMappedTimes, from, to) );
+
+    rawFirstInRaw.file->unmap_file();
+
+    QVERIFY( mData.rows() == mMappedData.rows() && mData.cols() == mMappedData.cols() );
+    QVERIFY( (mData - mMappedData).cwiseAbs().maxCoeff() < dEpsilon );
+    QVERIFY( (mTimes - mMappedTimes).cwiseAbs().maxCoeff() < dEpsilon );
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareSelectedData()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp + 100;
+    fiff_int_t to = from + 2*ceil(rawFirstInRaw.info.sfreq);
+
+    MatrixXd mData, mTimes;
+    QVERIFY( rawFirstInRaw.read_raw_segment(mData, mTimes, from, to) );
+
+    RowVectorXi vSel = rawFirstInRaw.info.pick_types(false, true, false);
+    QVERIFY( vSel.cols() > 0 );
+
+    MatrixXd mSelData, mSelTimes;
+    QVERIFY( rawFirstInRaw.read_raw_segment(mSelData, mSelTimes, from, to, vSel) );
+
+    QVERIFY( mSelData.rows() == vSel.cols() && mSelData.cols() == mData.cols() );
+    for( qint32 i = 0; i < vSel.cols(); ++i )
+    {
+        QVERIFY( (mData.row(vSel[i]) - mSelData.row(i)).cwiseAbs().maxCoeff() < dEpsilon );
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareAsyncWrittenData()
+{
+    QFile t_fileOut(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw_test_rwr_async_out.fif");
+
+    RowVectorXd vCals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, rawFirstInRaw.info, vCals);
+
+    fiff_int_t from = rawFirstInRaw.first_samp;
+    fiff_int_t to = rawFirstInRaw.last_samp;
+    fiff_int_t quantum = ceil(rawFirstInRaw.info.sfreq);
+
+    if (from > 0)
+        outfid->write_int(FIFF_FIRST_SAMPLE,&from);
+
+    // Use a small queue, so the writer has to apply backpressure
+    FiffRawWriter writer(outfid, vCals, 2);
+    QVERIFY( writer.start() );
+
+    MatrixXd mData, mTimes;
+    for(fiff_int_t first = from; first < to; first+=quantum)
+    {
+        fiff_int_t last = qMin(first+quantum-1, to);
+        QVERIFY( rawFirstInRaw.read_raw_segment(mData, mTimes, first, last) );
+        QVERIFY( writer.write_raw_buffer(mData) );
+    }
+
+    writer.stop();
+    outfid->finish_writing_raw();
+
+    FiffRawWriter::Statistics stats = writer.getStatistics();
+    QVERIFY( stats.iNumDroppedBuffers == 0 );
+    QVERIFY( stats.iNumFailedBuffers == 0 );
+    QVERIFY( !writer.hasError() );
+    QVERIFY( stats.iNumWrittenBuffers == rawSecondInRaw.rawdir.size() );
+
+    FiffRawData rawAsyncInRaw(t_fileOut);
+
+    MatrixXd mSyncData, mAsyncData;
+    QVERIFY( rawSecondInRaw.read_raw_segment(mSyncData, mTimes, from, to) );
+    QVERIFY( rawAsyncInRaw.read_raw_segment(mAsyncData, mTimes, from, to) );
+
+    QVERIFY( mSyncData.rows() == mAsyncData.rows() && mSyncData.cols() == mAsyncData.cols() );
+    QVERIFY( (mSyncData - mAsyncData).cwiseAbs().maxCoeff() < dEpsilon );
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareAsyncSkippedData()
+{
+    GatedFile t_fileOut(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw_test_rwr_skip_out.fif");
+
+    RowVectorXd vCals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, rawFirstInRaw.info, vCals);
+
+    // Quarter second buffers, so five of them fit into the truncated test file
+    fiff_int_t from = rawFirstInRaw.first_samp;
+    fiff_int_t quantum = ceil(rawFirstInRaw.info.sfreq / 4.0);
+    outfid->write_int(FIFF_FIRST_SAMPLE,&from);
+
+    QList<MatrixXd> lBuffers;
+    MatrixXd mData, mTimes;
+    for(int k = 0; k < 5; ++k)
+    {
+        QVERIFY( rawFirstInRaw.read_raw_segment(mData, mTimes, from + k*quantum, from + (k+1)*quantum - 1) );
+        lBuffers.append(mData);
+    }
+
+    FiffRawWriter writer(outfid, vCals, 1);
+    QVERIFY( writer.start() );
+
+    // Hold the writer in its first device write, so the queue fills up
+    t_fileOut.setGated(true);
+    QVERIFY( writer.write_raw_buffer(lBuffers[0]) );
+    QTRY_VERIFY( writer.getStatistics().iQueueSize == 0 );
+    QVERIFY( writer.write_raw_buffer(lBuffers[1], 0) );
+    QVERIFY( !writer.write_raw_buffer(lBuffers[2], 0) );
+    QVERIFY( !writer.write_raw_buffer(lBuffers[3], 0) );
+    t_fileOut.setGated(false);
+
+    QVERIFY( writer.write_raw_buffer(lBuffers[4]) );
+
+    QVERIFY( writer.stop() );
+    outfid->finish_writing_raw();
+
+    FiffRawWriter::Statistics stats = writer.getStatistics();
+    QVERIFY( stats.iNumDroppedBuffers == 2 );
+    QVERIFY( stats.iNumWrittenBuffers == 3 );
+    QVERIFY( stats.iNumSkipTags == 1 );
+
+    // The dropped buffers read as zeros and the last buffer keeps its time
+    FiffRawData rawSkippedInRaw(t_fileOut);
+    QVERIFY( rawSkippedInRaw.first_samp == from );
+    QVERIFY( rawSkippedInRaw.last_samp == from + 5*quantum - 1 );
+
+    MatrixXd mSkippedData;
+    QVERIFY( rawSkippedInRaw.read_raw_segment(mSkippedData, mTimes, from, from + 5*quantum - 1) );
+    QVERIFY( mSkippedData.cols() == 5*quantum );
+
+    for(int k = 0; k < 5; ++k)
+    {
+        MatrixXd mBlock = mSkippedData.middleCols(k*quantum, quantum);
+        if(k == 2 || k == 3) {
+            QVERIFY( (mBlock.array() == 0.0).all() );
+            continue;
+        }
+        for(qint32 i = 0; i < mBlock.rows(); ++i)
+        {
+            QVERIFY( (mBlock.row(i) - lBuffers[k].row(i)).cwiseAbs().maxCoeff() <= 1e-6 * lBuffers[k].row(i).cwiseAbs().maxCoeff() );
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareCachedDir()
+{
+    QString sFileName = QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw_test_rwr_out.fif";
+    QString sCacheName = FiffStream::dirCacheFileName(sFileName);
+    QVERIFY( !sCacheName.isEmpty() );
+    QFile::remove(sCacheName);
+
+    FiffStream::setDirCacheEnabled(true);
+
+    // The first open scans the file and writes the cache, the second one loads it
+    QFile t_fileScanned(sFileName);
+    FiffStream::SPtr pStreamScanned(new FiffStream(&t_fileScanned));
+    QVERIFY( pStreamScanned->open() );
+    QVERIFY( QFile::exists(sCacheName) );
+    QVERIFY( !QFile::exists(sFileName + ".dircache") );
+
+    QFile t_fileCached(sFileName);
+    FiffStream::SPtr pStreamCached(new FiffStream(&t_fileCached));
+    QVERIFY( pStreamCached->open() );
+
+    QVERIFY( pStreamScanned->dir().size() == pStreamCached->dir().size() );
+    for( qint32 i = 0; i < pStreamScanned->dir().size(); ++i )
+    {
+        QVERIFY( pStreamScanned->dir()[i]->kind == pStreamCached->dir()[i]->kind );
+        QVERIFY( pStreamScanned->dir()[i]->pos == pStreamCached->dir()[i]->pos );
+    }
+
+    QVERIFY( pStreamScanned->dirtree()->nent_tree == pStreamCached->dirtree()->nent_tree );
+    QVERIFY( pStreamScanned->dirtree()->dir_tree_find(FIFFB_RAW_DATA).size() == pStreamCached->dirtree()->dir_tree_find(FIFFB_RAW_DATA).size() );
+    QVERIFY( pStreamScanned->dirtree()->dir_tree_find(FIFFB_MEAS_INFO).size() == pStreamCached->dirtree()->dir_tree_find(FIFFB_MEAS_INFO).size() );
+
+    QFile t_fileRaw(sFileName);
+    FiffRawData rawCachedInRaw(t_fileRaw);
+    MatrixXd mData, mTimes;
+    QVERIFY( rawCachedInRaw.read_raw_segment(mData, mTimes, rawSecondInRaw.first_samp, rawSecondInRaw.last_samp) );
+    QVERIFY( rawCachedInRaw.info.nchan == rawSecondInRaw.info.nchan );
+
+    FiffStream::setDirCacheEnabled(false);
+
+    pStreamScanned->close();
+    pStreamCached->close();
+    QFile::remove(sCacheName);
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareSinglePrecisionData()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp + 100;
+    fiff_int_t to = from + 2*ceil(rawFirstInRaw.info.sfreq);
+
+    RowVectorXi vSel = rawFirstInRaw.info.pick_types(true, true, false);
+    QVERIFY( vSel.cols() > 0 );
+
+    // All channels and a selection, the samples are decoded and calibrated in float
+    for( const RowVectorXi& vecSel : QList<RowVectorXi>() << RowVectorXi() << vSel )
+    {
+        MatrixXd mData, mTimes;
+        QVERIFY( rawFirstInRaw.read_raw_segment(mData, mTimes, from, to, vecSel) );
+
+        MatrixXf mFloatData;
+        MatrixXd mFloatTimes;
+        QVERIFY( rawFirstInRaw.read_raw_segment(mFloatData, mFloatTimes, from, to, vecSel) );
+
+        QVERIFY( mData.rows() == mFloatData.rows() && mData.cols() == mFloatData.cols() );
+        QVERIFY( (mTimes - mFloatTimes).cwiseAbs().maxCoeff() < dEpsilon );
+
+        for( qint32 i = 0; i < mData.rows(); ++i )
+        {
+            QVERIFY( (mData.row(i) - mFloatData.row(i).cast<double>()).cwiseAbs().maxCoeff() <= 1e-6 * mData.row(i).cwiseAbs().maxCoeff() );
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareUncalibratedData()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp + 100;
+    fiff_int_t to = from + 2*ceil(rawFirstInRaw.info.sfreq);
+
+    // Without projector and compensator the calibrated data is the stored data scaled by the calibration factors
+    FiffRawData rawCalibrated(rawFirstInRaw);
+    rawCalibrated.proj = MatrixXd();
+    rawCalibrated.comp = FiffCtfComp();
+
+    RowVectorXi vSel = rawFirstInRaw.info.pick_types(false, true, false);
+    QVERIFY( vSel.cols() > 0 );
+
+    for( const RowVectorXi& vecSel : QList<RowVectorXi>() << RowVectorXi() << vSel )
+    {
+        MatrixXi mIntData;
+        RowVectorXd vCals;
+        MatrixXd mIntTimes;
+
+        // Float buffers have no integer representation and are rejected
+        if( rawCalibrated.rawdir.first().ent && rawCalibrated.rawdir.first().ent->type == FIFFT_FLOAT )
+        {
+            QVERIFY( !rawCalibrated.read_raw_segment_uncalibrated(mIntData, vCals, mIntTimes, from, to, vecSel) );
+            continue;
+        }
+
+        QVERIFY( rawCalibrated.read_raw_segment_uncalibrated(mIntData, vCals, mIntTimes, from, to, vecSel) );
+
+        MatrixXd mData, mTimes;
+        QVERIFY( rawCalibrated.read_raw_segment(mData, mTimes, from, to, vecSel) );
+
+        QVERIFY( mData.rows() == mIntData.rows() && mData.cols() == mIntData.cols() );
+        QVERIFY( vCals.cols() == mData.rows() );
+        QVERIFY( (mTimes - mIntTimes).cwiseAbs().maxCoeff() < dEpsilon );
+
+        MatrixXd mScaledData = vCals.asDiagonal() * mIntData.cast<double>();
+        for( qint32 i = 0; i < mData.rows(); ++i )
+        {
+            QVERIFY( (mData.row(i) - mScaledData.row(i)).cwiseAbs().maxCoeff() <= dEpsilon * mData.row(i).cwiseAbs().maxCoeff() );
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestFiffRWR::compareProjectedData()
+{
+    fiff_int_t from = rawFirstInRaw.first_samp + 100;
+    fiff_int_t to = from + 2*ceil(rawFirstInRaw.info.sfreq);
+
+    // Calibrated data without projector and compensator
+    FiffRawData rawCalibrated(rawFirstInRaw);
+    rawCalibrated.proj = MatrixXd();
+    rawCalibrated.comp = FiffCtfComp();
+
+    MatrixXd mCalibrated, mTimes;
+    QVERIFY( rawCalibrated.read_raw_segment(mCalibrated, mTimes, from, to) );
+
+    // SSP operator of the file
+    FiffRawData rawProjected(rawCalibrated);
+    for( qint32 k = 0; k < rawProjected.info.projs.size(); ++k )
+        rawProjected.info.projs[k].active = true;
+    QVERIFY( rawProjected.info.make_projector(rawProjected.proj) > 0 );
+
+    // Compensator which mixes the first MEG channel into all other MEG channels
+    RowVectorXi vMeg = rawFirstInRaw.info.pick_types(true, false, false);
+    RowVectorXi vEeg = rawFirstInRaw.info.pick_types(false, true, false);
+    QVERIFY( vMeg.cols() > 1 && vEeg.cols() > 0 );
+
+    MatrixXd mComp = MatrixXd::Identity(rawFirstInRaw.info.nchan, rawFirstInRaw.info.nchan);
+    for( qint32 i = 1; i < vMeg.cols(); ++i )
+        mComp(vMeg[i], vMeg[0]) = -0.5;
+
+    FiffRawData rawCompensated(rawProjected);
+    rawCompensated.comp.kind = 1;
+    rawCompensated.comp.data->data = mComp;
+
+    // Without a selection all channels are mixed, with a selection only the channels which the selected rows of
+    // the operators mix are gathered
+    QList<QPair<FiffRawData*, MatrixXd> > lOperators;
+    lOperators << qMakePair(&rawProjected, MatrixXd(rawProjected.proj))
+               << qMakePair(&rawCompensated, MatrixXd(rawProjected.proj * mComp));
+
+    for( const QPair<FiffRawData*, MatrixXd>& pairOperator : lOperators )
+    {
+        MatrixXd mReference = pairOperator.second * mCalibrated;
+
+        for( const RowVectorXi& vecSel : QList<RowVectorXi>() << RowVectorXi() << vMeg << vEeg )
+        {
+            MatrixXd mData, mDataTimes;
+            QVERIFY( pairOperator.first->read_raw_segment(mData, mDataTimes, from, to, vecSel) );
+            QVERIFY( mData.rows() == (vecSel.cols() == 0 ? mReference.rows() : vecSel.cols()) );
+            QVERIFY( mData.cols() == mReference.cols() );
+
+            for( qint32 i = 0; i < mData.rows(); ++i )
+            {
+                qint32 iRow = vecSel.cols() == 0 ? i : vecSel[i];
+                QVERIFY( (mData.row(i) - mReference.row(iRow)).cwiseAbs().maxCoeff() <= dEpsilon * mReference.row(iRow).cwiseAbs().maxCoeff() );
+            }
+        }
+    }
+}
+
+//=============================================================================================================
+
 void TestFiffRWR::cleanupTestCase()
 {
 }
@@ -84,12 +84,19 @@ private slots:
     void initTestCase();
     void compareData();
     void compareTimes();
+    void compareIirStreaming();
+    void compareOverlapSave();
+    void compareBatchedFft();
+    void compareSinglePrecision();
     void cleanupTestCase();
 
 private:
     double dEpsilon;
+    double dSFreq;
     int iOrder;
 
+    RowVectorXi vPicks;
+
     MatrixXd mFirstInData;
     MatrixXd mFirstInTimes;
     MatrixXd mFirstFiltered;
@@ -138,7 +145,7 @@ void TestFiltering::initTestCase()
     rawFirstInRaw = FiffRawData(t_fileIn);
 
     // Only filter MEG channels
-    RowVectorXi vPicks = rawFirstInRaw.info.pick_types(true, true, false);
+    vPicks = rawFirstInRaw.info.pick_types(true, true, false);
     RowVectorXd vCals;
     FiffStream::SPtr outfid = FiffStream::start_writing_raw(t_fileOut, rawFirstInRaw.info, vCals);
 
@@ -151,7 +158,7 @@ void TestFiltering::initTestCase()
     // initialize filter settings
     QString sFilterName = "example_cosine";
     FilterKernel::FilterType type = FilterKernel::BPF;
-    double dSFreq = rawFirstInRaw.info.sfreq;
+    dSFreq = rawFirstInRaw.info.sfreq;
     double dCenterfreq = 10;
     double dBandwidth = 10;
     double dTransition = 1;
@@ -231,6 +238,178 @@ void TestFiltering::compareTimes()
     QVERIFY( mTimesDiff.sum() < dEpsilon );
 }
 
+void TestFiltering::compareIirStreaming()
+{
+    // Filtering the data in small blocks has to give the same result as filtering it at once, since the biquad
+    // states are carried over from block to block
+    FilterKernel iirKernel("example_butterworth",
+                           FilterKernel::BPF,
+                           4,
+                           10.0/(dSFreq/2.0),
+                           10.0/(dSFreq/2.0),
+                           0.0,
+                           dSFreq,
+                           FilterKernel::Butterworth);
+    QVERIFY(iirKernel.isIir());
+
+    MatrixXd mDataIn = mFirstInData.leftCols(2000);
+    MatrixXd mFilteredAtOnce = RTPROCESSINGLIB::filterData(mDataIn,
+                                                           iirKernel);
+
+    FilterOverlapAdd filterStream;
+    MatrixXd mFilteredStream(mDataIn.rows(), mDataIn.cols());
+    int iBlockSize = 17;
+    for(int i = 0; i < mDataIn.cols(); i += iBlockSize) {
+        int iNumSamples = qMin(iBlockSize, int(mDataIn.cols()) - i);
+        mFilteredStream.middleCols(i, iNumSamples) = filterStream.calculate(mDataIn.middleCols(i, iNumSamples),
+                                                                            iirKernel);
+    }
+
+    MatrixXd mDataDiff = mFilteredAtOnce - mFilteredStream;
+    QVERIFY( mDataDiff.cwiseAbs().maxCoeff() < dEpsilon * mDataIn.cwiseAbs().maxCoeff() );
+}
+
+//=============================================================================================================
+
+void TestFiltering::compareOverlapSave()
+{
+    // Streaming the data through the overlap save filter in blocks shorter than the filter has to give the same
+    // result as the overlap add of blocks longer than the filter
+    FilterKernel firKernel("example_cosine",
+                           FilterKernel::BPF,
+                           iOrder,
+                           10.0/(dSFreq/2.0),
+                           10.0/(dSFreq/2.0),
+                           1.0/(dSFreq/2.0),
+                           dSFreq,
+                           FilterKernel::Cosine);
+
+    MatrixXd mDataIn = mFirstInData.leftCols(6 * iOrder);
+
+    // Overlap add reference. The first samples of each block are complete once the overlap of the last block is added.
+    FilterOverlapAdd filterOverlapAdd;
+    MatrixXd mFilteredOverlapAdd(mDataIn.rows(), mDataIn.cols());
+    int iBlockSize = 2 * iOrder;
+    for(int i = 0; i < mDataIn.cols(); i += iBlockSize) {
+        mFilteredOverlapAdd.middleCols(i, iBlockSize) = filterOverlapAdd.calculate(mDataIn.middleCols(i, iBlockSize),
+                                                                                   firKernel,
+                                                                                   vPicks,
+                                                                                   true,
+                                                                                   true,
+                                                                                   true).leftCols(iBlockSize);
+    }
+
+    // Overlap save with blocks shorter than the filter, the channels which are not picked are only delayed
+    FilterOverlapSave filterOverlapSave(firKernel,
+                                        mDataIn.rows(),
+                                        100,
+                                        vPicks);
+    QVERIFY(filterOverlapSave.isInitialized());
+    QCOMPARE(filterOverlapSave.getDelay(), iOrder/2);
+
+    MatrixXd mFilteredOverlapSave(mDataIn.rows(), mDataIn.cols());
+    iBlockSize = 100;
+    for(int i = 0; i < mDataIn.cols(); i += iBlockSize) {
+        int iNumSamples = qMin(iBlockSize, int(mDataIn.cols()) - i);
+        MatrixXd mBlock = mDataIn.middleCols(i, iNumSamples);
+        QVERIFY(filterOverlapSave.filter(mBlock));
+        mFilteredOverlapSave.middleCols(i, iNumSamples) = mBlock;
+    }
+
+    // FilterOverlapAdd streams blocks shorter than the filter through its overlap save filter, the blocks are
+    // filtered in pieces of the first block size
+    FilterOverlapAdd filterStream;
+    MatrixXd mFilteredStream(mDataIn.rows(), mDataIn.cols());
+    iBlockSize = 300;
+    for(int i = 0; i < mDataIn.cols(); i += iBlockSize) {
+        int iNumSamples = qMin(iBlockSize, int(mDataIn.cols()) - i);
+        mFilteredStream.middleCols(i, iNumSamples) = filterStream.calculate(mDataIn.middleCols(i, iNumSamples),
+                                                                            FilterKernel::BPF,
+                                                                            10,
+                                                                            10,
+                                                                            1,
+                                                                            dSFreq,
+                                                                            iOrder,
+                                                                            FilterKernel::Cosine,
+                                                                            vPicks);
+    }
+
+    double dMax = mDataIn.cwiseAbs().maxCoeff();
+    QVERIFY( (mFilteredOverlapSave - mFilteredOverlapAdd).cwiseAbs().maxCoeff() < dEpsilon * dMax );
+    QVERIFY( (mFilteredStream - mFilteredOverlapAdd).cwiseAbs().maxCoeff() < dEpsilon * dMax );
+}
+
+//=============================================================================================================
+
+void TestFiltering::compareBatchedFft()
+{
+    // Filtering all channels with one call has to give the same result as filtering each channel on its own
+    FilterKernel firKernel("example_cosine",
+                           FilterKernel::BPF,
+                           iOrder,
+                           10.0/(dSFreq/2.0),
+                           10.0/(dSFreq/2.0),
+                           1.0/(dSFreq/2.0),
+                           dSFreq,
+                           FilterKernel::Cosine);
+
+    MatrixXd mDataIn = mFirstInData.leftCols(3000);
+    double dMax = mDataIn.cwiseAbs().maxCoeff();
+
+    for(bool bKeepOverhead : QList<bool>() << false << true) {
+        MatrixXd mFilteredBatched = mDataIn;
+        firKernel.applyFftFilter(mFilteredBatched, bKeepOverhead);
+
+        for(int i = 0; i < mDataIn.rows(); ++i) {
+            RowVectorXd vecFiltered = mDataIn.row(i);
+            firKernel.applyFftFilter(vecFiltered, bKeepOverhead);
+
+            QVERIFY(mFilteredBatched.cols() == vecFiltered.cols());
+            QVERIFY( (mFilteredBatched.row(i) - vecFiltered).cwiseAbs().maxCoeff() < dEpsilon * dMax );
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestFiltering::compareSinglePrecision()
+{
+    // Filtering single precision data has to give the double precision result up to the rounding of the output
+    FilterKernel firKernel("example_cosine",
+                           FilterKernel::BPF,
+                           iOrder,
+                           10.0/(dSFreq/2.0),
+                           10.0/(dSFreq/2.0),
+                           1.0/(dSFreq/2.0),
+                           dSFreq,
+                           FilterKernel::Cosine);
+
+    MatrixXf mDataIn = mFirstInData.leftCols(3000).cast<float>();
+
+    for(bool bKeepOverhead : QList<bool>() << false << true) {
+        MatrixXd mFiltered = RTPROCESSINGLIB::filterData(MatrixXd(mDataIn.cast<double>()),
+                                                         firKernel,
+                                                         vPicks,
+                                                         true,
+                                                         bKeepOverhead);
+        MatrixXf mFilteredFloat = RTPROCESSINGLIB::filterData(mDataIn,
+                                                              firKernel,
+                                                              vPicks,
+                                                              true,
+                                                              bKeepOverhead);
+
+        QVERIFY(mFiltered.rows() == mFilteredFloat.rows());
+        QVERIFY(mFiltered.cols() == mFilteredFloat.cols());
+
+        for(int i = 0; i < mFiltered.rows(); ++i) {
+            double dMax = mDataIn.row(i).cwiseAbs().maxCoeff();
+            QVERIFY( (mFiltered.row(i) - mFilteredFloat.row(i).cast<double>()).cwiseAbs().maxCoeff() <= 1e-5 * dMax );
+        }
+    }
+}
+
+//=============================================================================================================
+
 void TestFiltering::cleanupTestCase()
 {
 }
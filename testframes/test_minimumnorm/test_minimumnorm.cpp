@@ -0,0 +1,283 @@
+//=============================================================================================================
+/**
+ * @file     test_minimumnorm.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the kernel application of the MinimumNorm class
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <fiff/fiff_evoked.h>
+#include <fiff/fiff_cov.h>
+
+#include <mne/mne_forwardsolution.h>
+#include <mne/mne_inverse_operator.h>
+#include <mne/mne_sourceestimate.h>
+
+#include <fs/label.h>
+
+#include <inverse/minimumNorm/minimumnorm.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace MNELIB;
+using namespace FSLIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestMinimumNorm
+ *
+ * @brief The TestMinimumNorm class verifies the batched and blocked application of the imaging kernel
+ *
+ */
+class TestMinimumNorm: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinimumNorm();
+
+private slots:
+    void initTestCase();
+    void compareNoiseNormalization();
+    void compareBatchedInverse();
+    void compareBatchedInverseFactorized();
+    void compareBatchedInverseSinglePrecision();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+     * Computes the solution of each epoch with calculateInverse(MatrixXd) and compares it to the result of
+     * calculateInverse(QList<MatrixXd>).
+     *
+     * @param[in] minimumNorm    The set up minimum norm.
+     * @param[in] lReference     The reference solutions, one per epoch.
+     * @param[in] dEps           The allowed relative error.
+     */
+    void compareEpochs(const MinimumNorm& minimumNorm,
+                       const QList<MatrixXd>& lReference,
+                       double dEps);
+
+    double dEpsilon;
+
+    FiffEvoked evoked;
+    MNEInverseOperator inverseOperator;
+    QList<MatrixXd> lEpochs;
+    float fTMin;
+    float fTStep;
+};
+
+//=============================================================================================================
+
+TestMinimumNorm::TestMinimumNorm()
+: dEpsilon(1e-10)
+, fTMin(0.0f)
+, fTStep(0.0f)
+{
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    QFile t_fileFwd(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/ref-sample_audvis-meg-eeg-oct-6-fwd.fif");
+    QFile t_fileCov(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-cov.fif");
+    QFile t_fileEvoked(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif");
+
+    QPair<float, float> baseline(-1.0f, -1.0f);
+    evoked = FiffEvoked(t_fileEvoked, 0, baseline);
+    QVERIFY(!evoked.isEmpty());
+
+    MNEForwardSolution t_Fwd(t_fileFwd);
+    QVERIFY(!t_Fwd.isEmpty());
+
+    FiffCov noise_cov(t_fileCov);
+    noise_cov = noise_cov.regularize(evoked.info, 0.05, 0.05, 0.1, true);
+
+    inverseOperator = MNEInverseOperator(evoked.info, t_Fwd, noise_cov, 0.2f, 0.8f);
+
+    // Split the evoked data, picked to the channels of the inverse operator, into epochs of unequal length
+    FiffEvoked t_evokedPicked = evoked.pick_channels(inverseOperator.noise_cov->names);
+    qint32 iNSamples = t_evokedPicked.data.cols();
+    qint32 iFirst = iNSamples / 3;
+    qint32 iSecond = iNSamples / 2;
+
+    lEpochs << t_evokedPicked.data.leftCols(iFirst)
+            << t_evokedPicked.data.middleCols(iFirst, iSecond - iFirst)
+            << t_evokedPicked.data.rightCols(iNSamples - iSecond);
+
+    fTMin = evoked.times[0];
+    fTStep = 1.0f / evoked.info.sfreq;
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareNoiseNormalization()
+{
+    // The noise normalization is folded into the kernel in place. Compare with the solution of the unnormalized
+    // kernel, pooled over the three orientations and scaled with the noise normalization afterwards.
+    MinimumNorm minimumNorm(inverseOperator, 1.0f / 9.0f, QString("dSPM"));
+    minimumNorm.doInverseSetup(evoked.nave, false);
+
+    MNEInverseOperator inv = minimumNorm.getPreparedInverseOperator();
+    QVERIFY(inv.noisenorm.rows() > 0);
+
+    Label label;
+    MatrixXd matKernel;
+    SparseMatrix<double> noise_norm;
+    QList<VectorXi> vertno;
+    QVERIFY(inv.assemble_kernel(label, QString("dSPM"), false, matKernel, noise_norm, vertno));
+
+    for(int i = 0; i < lEpochs.size(); ++i) {
+        MatrixXd matSol = matKernel * lEpochs.at(i);
+
+        if(inv.source_ori == FIFFV_MNE_FREE_ORI) {
+            MatrixXd matPooled(matSol.rows() / 3, matSol.cols());
+            for(int j = 0; j < matPooled.rows(); ++j) {
+                matPooled.row(j) = matSol.middleRows(3 * j, 3).colwise().norm();
+            }
+            matSol = matPooled;
+        }
+
+        matSol = inv.noisenorm * matSol;
+
+        MNESourceEstimate stc = minimumNorm.calculateInverse(lEpochs.at(i), fTMin, fTStep, false);
+        QVERIFY(stc.data.rows() == matSol.rows());
+        QVERIFY(stc.data.cols() == matSol.cols());
+        QVERIFY((stc.data - matSol).norm() <= dEpsilon * matSol.norm());
+    }
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareBatchedInverse()
+{
+    for(const QString& sMethod : QStringList() << "MNE" << "dSPM" << "sLORETA") {
+        MinimumNorm minimumNorm(inverseOperator, 1.0f / 9.0f, sMethod);
+        minimumNorm.doInverseSetup(evoked.nave, false);
+
+        QList<MatrixXd> lReference;
+        for(int i = 0; i < lEpochs.size(); ++i) {
+            lReference << minimumNorm.calculateInverse(lEpochs.at(i), fTMin, fTStep, false).data;
+        }
+
+        compareEpochs(minimumNorm, lReference, dEpsilon);
+    }
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareBatchedInverseFactorized()
+{
+    for(const QString& sMethod : QStringList() << "MNE" << "dSPM" << "sLORETA") {
+        MinimumNorm minimumNorm(inverseOperator, 1.0f / 9.0f, sMethod);
+        minimumNorm.doInverseSetup(evoked.nave, false);
+
+        QList<MatrixXd> lReference;
+        for(int i = 0; i < lEpochs.size(); ++i) {
+            lReference << minimumNorm.calculateInverse(lEpochs.at(i), fTMin, fTStep, false).data;
+        }
+
+        minimumNorm.setFactorizedKernel(true);
+        minimumNorm.doInverseSetup(evoked.nave, false);
+        QVERIFY(minimumNorm.getKernel().size() == 0);
+
+        compareEpochs(minimumNorm, lReference, 1e-8);
+    }
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareBatchedInverseSinglePrecision()
+{
+    MinimumNorm minimumNorm(inverseOperator, 1.0f / 9.0f, QString("dSPM"));
+    minimumNorm.doInverseSetup(evoked.nave, false);
+
+    QList<MatrixXd> lReference;
+    for(int i = 0; i < lEpochs.size(); ++i) {
+        lReference << minimumNorm.calculateInverse(lEpochs.at(i), fTMin, fTStep, false).data;
+    }
+
+    minimumNorm.setSinglePrecisionKernel(true);
+    minimumNorm.doInverseSetup(evoked.nave, false);
+    QVERIFY(minimumNorm.getKernel().size() == 0);
+
+    compareEpochs(minimumNorm, lReference, 1e-4);
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::compareEpochs(const MinimumNorm& minimumNorm,
+                                    const QList<MatrixXd>& lReference,
+                                    double dEps)
+{
+    QList<MNESourceEstimate> lBatched = minimumNorm.calculateInverse(lEpochs, fTMin, fTStep, false);
+    QVERIFY(lBatched.size() == lEpochs.size());
+
+    for(int i = 0; i < lEpochs.size(); ++i) {
+        MNESourceEstimate stc = minimumNorm.calculateInverse(lEpochs.at(i), fTMin, fTStep, false);
+
+        QVERIFY(lBatched.at(i).data.rows() == lReference.at(i).rows());
+        QVERIFY(lBatched.at(i).data.cols() == lReference.at(i).cols());
+        QVERIFY((lBatched.at(i).data - lReference.at(i)).norm() <= dEps * lReference.at(i).norm());
+        QVERIFY((lBatched.at(i).data - stc.data).norm() <= dEpsilon * stc.data.norm());
+    }
+}
+
+//=============================================================================================================
+
+void TestMinimumNorm::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestMinimumNorm)
+#include "test_minimumnorm.moc"
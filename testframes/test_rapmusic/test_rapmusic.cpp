@@ -0,0 +1,328 @@
+//=============================================================================================================
+/**
+ * @file     test_rapmusic.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the subspace correlation and the pair search of the RapMusic class
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <mne/mne_forwardsolution.h>
+
+#include <inverse/rapMusic/rapmusic.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * Exposes the internal steps of RapMusic to the test.
+ */
+class RapMusicTester : public RapMusic
+{
+public:
+    RapMusicTester(MNEForwardSolution& p_Fwd, int p_iN)
+    : RapMusic(p_Fwd, false, p_iN, 0.0)
+    {
+    }
+
+    using RapMusic::SubcorrTerms;
+    using RapMusic::calcSubcorrTerms;
+    using RapMusic::subcorr;
+    using RapMusic::calcPhi_s;
+    using RapMusic::calcA_k_1;
+    using RapMusic::calcOrthProj;
+    using RapMusic::getGainMatrixPair;
+    using RapMusic::m_ppPairIdxCombinations;
+    using RapMusic::m_iNumLeadFieldCombinations;
+    using RapMusic::m_iNumGridPoints;
+    using RapMusic::m_iNumChannels;
+};
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestRapMusic
+ *
+ * @brief The TestRapMusic class compares the cached subspace correlation and the pruned pair search of RAP MUSIC
+ *        with the direct subspace correlation and an exhaustive search
+ *
+ */
+class TestRapMusic: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRapMusic();
+
+private slots:
+    void initTestCase();
+    void compareSubcorr();
+    void comparePrunedSearch();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+     * Returns the signal subspace U_B of the measurement projected with the given orthogonal projector.
+     *
+     * @param[in] matOrthProj    The orthogonal projector.
+     * @param[in] matPhi_s       The signal subspace.
+     *
+     * @return the full rank left singular vectors of the projected signal subspace.
+     */
+    MatrixXd projectedSignalSubspace(const MatrixXd& matOrthProj,
+                                     const MatrixXd& matPhi_s);
+
+    double dEpsilon;
+
+    int iNumSources;
+    int iNumPairs;
+
+    MNEForwardSolution fwd;
+    MatrixXd matMeasurement;
+};
+
+//=============================================================================================================
+
+TestRapMusic::TestRapMusic()
+: dEpsilon(1e-8)
+, iNumSources(3)
+, iNumPairs(2)
+{
+}
+
+//=============================================================================================================
+
+void TestRapMusic::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    QFile t_fileFwd(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/Result/ref-sample_audvis-meg-eeg-oct-6-fwd.fif");
+    fwd = MNEForwardSolution(t_fileFwd);
+    QVERIFY(!fwd.isEmpty());
+    QVERIFY(!fwd.isFixedOrient());
+
+    // Keep the first grid points only, so that the exhaustive search over all pairs stays fast. The gain is scaled
+    // to unit mean column norm, the subspaces do not depend on the scale but the rank thresholds do.
+    int iNumGridPoints = qMin(200, int(fwd.sol->data.cols() / 3));
+    MatrixXd matGain = fwd.sol->data.leftCols(3 * iNumGridPoints);
+    matGain /= matGain.colwise().norm().mean();
+    fwd.sol->data = matGain;
+    fwd.sol->ncol = matGain.cols();
+
+    // Simulate three sources with fixed orientations. The topographies are slightly perturbed, so the measurement
+    // has rank three but does not match any grid point pair exactly and the maximal correlation is unique.
+    QVector<int> vecSourceIdx({17, 89, 151});
+    MatrixXd matTopo(matGain.rows(), iNumSources);
+    MatrixXd matTimeCourses(iNumSources, 50);
+
+    srand(42);
+    for(int i = 0; i < iNumSources; ++i) {
+        Vector3d vecOri = Vector3d::Random().normalized();
+        matTopo.col(i) = matGain.middleCols(3 * vecSourceIdx[i], 3) * vecOri;
+        matTopo.col(i) += 0.05 * matTopo.col(i).norm() * VectorXd::Random(matGain.rows()).normalized();
+
+        for(int j = 0; j < matTimeCourses.cols(); ++j) {
+            matTimeCourses(i, j) = std::sin(2.0 * M_PI * (i + 1) * j / matTimeCourses.cols() + i);
+        }
+    }
+
+    matMeasurement = matTopo * matTimeCourses;
+}
+
+//=============================================================================================================
+
+void TestRapMusic::compareSubcorr()
+{
+    RapMusicTester rapMusic(fwd, iNumPairs);
+
+    MatrixXd* pMatPhi_s = Q_NULLPTR;
+    int iRank = rapMusic.calcPhi_s(matMeasurement, pMatPhi_s);
+    QVERIFY(iRank == iNumSources);
+
+    MatrixXd matOrthProj = MatrixXd::Identity(rapMusic.m_iNumChannels, rapMusic.m_iNumChannels);
+    MatrixXd matA_k_1 = MatrixXd::Zero(rapMusic.m_iNumChannels, iNumPairs);
+    RapMusicTester::SubcorrTerms terms;
+    QList<int> lFoundPoints;
+
+    for(int r = 0; r < iNumPairs; ++r) {
+        MatrixXd matU_B = projectedSignalSubspace(matOrthProj, *pMatPhi_s);
+        rapMusic.calcSubcorrTerms(matU_B, matA_k_1, r, terms);
+
+        double dMaxRoh = -1.0;
+        int iMaxIdx = -1;
+
+        for(int i = 0; i < rapMusic.m_iNumLeadFieldCombinations; ++i) {
+            int iIdx1 = rapMusic.m_ppPairIdxCombinations[i]->x1;
+            int iIdx2 = rapMusic.m_ppPairIdxCombinations[i]->x2;
+
+            double dRoh = rapMusic.subcorr(iIdx1, iIdx2, terms);
+
+            if(dRoh > dMaxRoh) {
+                dMaxRoh = dRoh;
+                iMaxIdx = i;
+            }
+
+            // The projected gain of a point which was already found is partly zero, its rank depends on the
+            // threshold. Compare the pairs of the other points only.
+            if(lFoundPoints.contains(iIdx1) || lFoundPoints.contains(iIdx2)) {
+                continue;
+            }
+
+            RapMusic::MatrixX6T matG(rapMusic.m_iNumChannels, 6);
+            RapMusicTester::getGainMatrixPair(fwd.sol->data, matG, iIdx1, iIdx2);
+            RapMusic::MatrixX6T matProj_G = matOrthProj * matG;
+
+            double dRohRef = RapMusicTester::subcorr(matProj_G, matU_B);
+
+            QVERIFY2(std::fabs(dRoh - dRohRef) < dEpsilon,
+                     qPrintable(QString("Pair %1 - %2: %3 instead of %4").arg(iIdx1).arg(iIdx2).arg(dRoh).arg(dRohRef)));
+        }
+
+        // Subtract the best pair like calculateInverse does
+        int iIdx1 = rapMusic.m_ppPairIdxCombinations[iMaxIdx]->x1;
+        int iIdx2 = rapMusic.m_ppPairIdxCombinations[iMaxIdx]->x2;
+
+        RapMusic::MatrixX6T matG_k_1(rapMusic.m_iNumChannels, 6);
+        RapMusicTester::getGainMatrixPair(fwd.sol->data, matG_k_1, iIdx1, iIdx2);
+        RapMusic::MatrixX6T matProj_G_k_1 = matOrthProj * matG_k_1;
+
+        RapMusic::Vector6T vecPhi_k_1;
+        RapMusicTester::subcorr(matProj_G_k_1, matU_B, vecPhi_k_1);
+        RapMusicTester::calcA_k_1(matG_k_1, vecPhi_k_1, r, matA_k_1);
+        rapMusic.calcOrthProj(matA_k_1, matOrthProj);
+
+        lFoundPoints << iIdx1 << iIdx2;
+    }
+
+    delete pMatPhi_s;
+}
+
+//=============================================================================================================
+
+void TestRapMusic::comparePrunedSearch()
+{
+    RapMusicTester rapMusic(fwd, iNumPairs);
+
+    // Pruned search
+    QList<DipolePair<double> > lRapDipoles;
+    rapMusic.calculateInverse(matMeasurement, lRapDipoles);
+    QVERIFY(lRapDipoles.size() == iNumPairs);
+
+    // Exhaustive search along the same iterations
+    MatrixXd* pMatPhi_s = Q_NULLPTR;
+    rapMusic.calcPhi_s(matMeasurement, pMatPhi_s);
+
+    MatrixXd matOrthProj = MatrixXd::Identity(rapMusic.m_iNumChannels, rapMusic.m_iNumChannels);
+    MatrixXd matA_k_1 = MatrixXd::Zero(rapMusic.m_iNumChannels, iNumPairs);
+    RapMusicTester::SubcorrTerms terms;
+
+    for(int r = 0; r < iNumPairs; ++r) {
+        MatrixXd matU_B = projectedSignalSubspace(matOrthProj, *pMatPhi_s);
+        rapMusic.calcSubcorrTerms(matU_B, matA_k_1, r, terms);
+
+        double dMaxRoh = -1.0;
+        int iMaxIdx = -1;
+
+        for(int i = 0; i < rapMusic.m_iNumLeadFieldCombinations; ++i) {
+            double dRoh = rapMusic.subcorr(rapMusic.m_ppPairIdxCombinations[i]->x1,
+                                           rapMusic.m_ppPairIdxCombinations[i]->x2,
+                                           terms);
+
+            if(dRoh > dMaxRoh) {
+                dMaxRoh = dRoh;
+                iMaxIdx = i;
+            }
+        }
+
+        int iIdx1 = rapMusic.m_ppPairIdxCombinations[iMaxIdx]->x1;
+        int iIdx2 = rapMusic.m_ppPairIdxCombinations[iMaxIdx]->x2;
+
+        QCOMPARE(lRapDipoles.at(r).m_iIdx1, iIdx1);
+        QCOMPARE(lRapDipoles.at(r).m_iIdx2, iIdx2);
+        QVERIFY(std::fabs(lRapDipoles.at(r).m_vCorrelation - dMaxRoh) < dEpsilon);
+
+        RapMusic::MatrixX6T matG_k_1(rapMusic.m_iNumChannels, 6);
+        RapMusicTester::getGainMatrixPair(fwd.sol->data, matG_k_1, iIdx1, iIdx2);
+        RapMusic::MatrixX6T matProj_G_k_1 = matOrthProj * matG_k_1;
+
+        RapMusic::Vector6T vecPhi_k_1;
+        RapMusicTester::subcorr(matProj_G_k_1, matU_B, vecPhi_k_1);
+        RapMusicTester::calcA_k_1(matG_k_1, vecPhi_k_1, r, matA_k_1);
+        rapMusic.calcOrthProj(matA_k_1, matOrthProj);
+    }
+
+    delete pMatPhi_s;
+}
+
+//=============================================================================================================
+
+void TestRapMusic::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+MatrixXd TestRapMusic::projectedSignalSubspace(const MatrixXd& matOrthProj,
+                                               const MatrixXd& matPhi_s)
+{
+    MatrixXd matProj_Phi_s = matOrthProj * matPhi_s;
+    JacobiSVD<MatrixXd> svdProj_Phi_s(matProj_Phi_s, ComputeThinU);
+
+    // Keep the components with non-zero singular values, as RapMusic::useFullRank does
+    int iRank = 0;
+    while(iRank < svdProj_Phi_s.singularValues().size() && svdProj_Phi_s.singularValues()(iRank) > 0.00001) {
+        ++iRank;
+    }
+
+    return svdProj_Phi_s.matrixU().leftCols(qMax(iRank, 1));
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRapMusic)
+#include "test_rapmusic.moc"
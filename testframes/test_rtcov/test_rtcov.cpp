@@ -0,0 +1,302 @@
+//=============================================================================================================
+/**
+ * @file     test_rtcov.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the window modes of the RtCov class
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <fiff/fiff_raw_data.h>
+#include <fiff/fiff_cov.h>
+
+#include <rtprocessing/rtcov.h>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace RTPROCESSINGLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * Exposes the accumulated moments of RtCov to the test.
+ */
+class RtCovTester : public RtCov
+{
+public:
+    RtCovTester(QSharedPointer<FiffInfo> pFiffInfo)
+    : RtCov(pFiffInfo)
+    {
+    }
+
+    using RtCov::makeCovariance;
+    using RtCov::m_accResult;
+};
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestRtCov
+ *
+ * @brief The TestRtCov class compares the incrementally updated covariance of the Sliding and Exponential window
+ *        modes with a covariance computed directly over the same samples
+ *
+ */
+class TestRtCov: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtCov();
+
+private slots:
+    void initTestCase();
+    void compareBlock();
+    void compareSliding();
+    void compareExponential();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+     * Computes the weighted mean and co-moment of the data directly.
+     *
+     * @param[in] matSamples     The data (channels x samples).
+     * @param[in] vecWeights     The weight of each sample.
+     *
+     * @return   The moments.
+     */
+    RtCovComputeResult directMoments(const MatrixXd& matSamples,
+                                     const VectorXd& vecWeights);
+
+    //=========================================================================================================
+    /**
+     * Compares the accumulated moments and the estimated covariance with the directly computed ones.
+     *
+     * @param[in] rtCov      The real-time covariance.
+     * @param[in] cov        The covariance returned by RtCov::estimateCovariance.
+     * @param[in] reference  The directly computed moments.
+     */
+    void compareMoments(RtCovTester& rtCov,
+                        const FiffCov& cov,
+                        const RtCovComputeResult& reference);
+
+    double dEpsilon;
+    int iWindowSize;
+    int iBlockSize;
+    int iNumBlocks;
+
+    QSharedPointer<FiffInfo> pFiffInfo;
+    MatrixXd matData;
+};
+
+//=============================================================================================================
+
+TestRtCov::TestRtCov()
+: dEpsilon(1e-10)
+, iWindowSize(600)
+, iBlockSize(100)
+, iNumBlocks(24)
+{
+}
+
+//=============================================================================================================
+
+void TestRtCov::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    QFile t_fileIn(QCoreApplication::applicationDirPath() + "/mne-cpp-test-data/MEG/sample/sample_audvis_trunc_raw.fif");
+    FiffRawData raw(t_fileIn);
+
+    MatrixXd matTimes;
+    QVERIFY(raw.read_raw_segment(matData, matTimes, raw.first_samp, raw.first_samp + iNumBlocks * iBlockSize - 1));
+    QVERIFY(matData.cols() == iNumBlocks * iBlockSize);
+
+    // Scale the channels to unit variance, so that the relative errors are not dominated by the EEG channels
+    for(int i = 0; i < matData.rows(); ++i) {
+        double dStd = std::sqrt((matData.row(i).array() - matData.row(i).mean()).square().mean());
+        if(dStd > 0.0) {
+            matData.row(i) /= dStd;
+        }
+    }
+
+    pFiffInfo = QSharedPointer<FiffInfo>(new FiffInfo(raw.info));
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareBlock()
+{
+    RtCovTester rtCov(pFiffInfo);
+
+    int iNumEstimates = 0;
+
+    for(int i = 0; i < matData.cols(); i += iBlockSize) {
+        FiffCov cov = rtCov.estimateCovariance(matData.middleCols(i, iBlockSize), iWindowSize);
+
+        if(cov.data.size() == 0) {
+            continue;
+        }
+
+        // The window ends with the current block and the accumulated moments were reset
+        MatrixXd matWindow = matData.middleCols(i + iBlockSize - iWindowSize, iWindowSize);
+        RtCovComputeResult reference = directMoments(matWindow, VectorXd::Ones(iWindowSize));
+
+        QVERIFY(rtCov.m_accResult.dN == 0.0);
+        QVERIFY((cov.data - rtCov.makeCovariance(reference).data).norm() <= dEpsilon * cov.data.norm());
+        ++iNumEstimates;
+    }
+
+    QCOMPARE(iNumEstimates, int(matData.cols() / iWindowSize));
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareSliding()
+{
+    // The update interval does not divide the block size, so the intervals are closed at block boundaries
+    RtCovTester rtCov(pFiffInfo);
+    rtCov.setWindowMode(RtCov::Sliding);
+    rtCov.setUpdateInterval(150);
+
+    int iNumEstimates = 0;
+
+    for(int i = 0; i < matData.cols(); i += iBlockSize) {
+        FiffCov cov = rtCov.estimateCovariance(matData.middleCols(i, iBlockSize), iWindowSize);
+
+        if(cov.data.size() == 0) {
+            continue;
+        }
+
+        // The window consists of the last samples, old update intervals were removed again
+        int iN = qRound(rtCov.m_accResult.dN);
+        QVERIFY(iN >= iWindowSize);
+        QVERIFY(iN < iWindowSize + 2 * iBlockSize);
+
+        MatrixXd matWindow = matData.middleCols(i + iBlockSize - iN, iN);
+        compareMoments(rtCov, cov, directMoments(matWindow, VectorXd::Ones(iN)));
+        ++iNumEstimates;
+    }
+
+    QVERIFY(iNumEstimates >= 5);
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareExponential()
+{
+    RtCovTester rtCov(pFiffInfo);
+    rtCov.setWindowMode(RtCov::Exponential);
+    rtCov.setUpdateInterval(iBlockSize);
+
+    // Each block forgets the samples seen before with the factor exp(-block size / window size)
+    const double dForget = std::exp(-double(iBlockSize) / iWindowSize);
+    VectorXd vecWeights(matData.cols());
+
+    int iNumEstimates = 0;
+
+    for(int i = 0; i < matData.cols(); i += iBlockSize) {
+        vecWeights.head(i) *= dForget;
+        vecWeights.segment(i, iBlockSize).setOnes();
+
+        FiffCov cov = rtCov.estimateCovariance(matData.middleCols(i, iBlockSize), iWindowSize);
+
+        if(cov.data.size() == 0) {
+            QVERIFY(i + iBlockSize < iWindowSize);
+            continue;
+        }
+
+        compareMoments(rtCov, cov, directMoments(matData.leftCols(i + iBlockSize), vecWeights.head(i + iBlockSize)));
+        ++iNumEstimates;
+    }
+
+    QCOMPARE(iNumEstimates, int((matData.cols() - iWindowSize) / iBlockSize) + 1);
+}
+
+//=============================================================================================================
+
+void TestRtCov::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+RtCovComputeResult TestRtCov::directMoments(const MatrixXd& matSamples,
+                                            const VectorXd& vecWeights)
+{
+    RtCovComputeResult result;
+    result.dN = vecWeights.sum();
+    result.mu = matSamples * vecWeights / result.dN;
+
+    MatrixXd matCentered = matSamples.colwise() - result.mu;
+    result.matData = matCentered * vecWeights.asDiagonal() * matCentered.transpose();
+
+    return result;
+}
+
+//=============================================================================================================
+
+void TestRtCov::compareMoments(RtCovTester& rtCov,
+                               const FiffCov& cov,
+                               const RtCovComputeResult& reference)
+{
+    const RtCovComputeResult& result = rtCov.m_accResult;
+
+    // Only the lower triangle of the accumulated co-moment is valid
+    MatrixXd matCoMoment = result.matData.selfadjointView<Lower>();
+
+    QVERIFY(std::fabs(result.dN - reference.dN) <= dEpsilon * reference.dN);
+    QVERIFY((result.mu - reference.mu).norm() <= dEpsilon * qMax(reference.mu.norm(), 1.0));
+    QVERIFY((matCoMoment - reference.matData).norm() <= dEpsilon * reference.matData.norm());
+
+    // The estimate is the regularized covariance of the accumulated moments
+    FiffCov covReference = rtCov.makeCovariance(reference);
+    QVERIFY((cov.data - covReference.data).norm() <= dEpsilon * covReference.data.norm());
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtCov)
+#include "test_rtcov.moc"
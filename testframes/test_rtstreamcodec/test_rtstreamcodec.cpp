@@ -0,0 +1,352 @@
+//=============================================================================================================
+/**
+ * @file     test_rtstreamcodec.cpp
+ * @author   agent <agent@local>
+ * @since    0.1.8
+ * @date     October, 2026
+ *
+ * @section  LICENSE
+ *
+ * Copyright (C) 2026, agent. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ * the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+ *       following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+ *       the following disclaimer in the documentation and/or other materials provided with the distribution.
+ *     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+ *       to endorse or promote products derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * @brief    Test for the encoding and decoding of the reduced real-time stream modes
+ *
+ */
+
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/applicationlogger.h>
+
+#include <fiff/fiff_stream.h>
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_constants.h>
+
+#include <communication/rtClient/rtstreamcodec.h>
+
+#include <limits>
+
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace COMMUNICATIONLIB;
+using namespace Eigen;
+
+//=============================================================================================================
+/**
+ * DECLARE CLASS TestRtStreamCodec
+ *
+ * @brief The TestRtStreamCodec class encodes raw buffers in the different stream modes and compares the decoded
+ *        buffers with the original ones
+ *
+ */
+class TestRtStreamCodec: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtStreamCodec();
+
+private slots:
+    void initTestCase();
+    void comparePlain();
+    void compareLossless();
+    void compareNearLossless();
+    void compareEscape();
+    void compareDecimation();
+    void compareChannelSubset();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+     * Encodes a buffer, reads the encoded tag back and decodes it.
+     *
+     * @param[in] codec      The codec to encode with.
+     * @param[in] matIn      The raw buffer (channels x samples).
+     * @param[out] matOut    The decoded buffer.
+     *
+     * @return true if an encoded tag was returned and could be decoded.
+     */
+    bool roundTrip(RtStreamCodec& codec,
+                   const MatrixXf& matIn,
+                   MatrixXf& matOut);
+
+    //=========================================================================================================
+    /**
+     * Checks that the error of each channel stays within half the quantisation step of the channel.
+     *
+     * @param[in] matIn      The encoded buffer.
+     * @param[in] matOut     The decoded buffer.
+     * @param[in] iBits      The number of quantisation bits.
+     */
+    void compareQuantised(const MatrixXf& matIn,
+                          const MatrixXf& matOut,
+                          int iBits);
+
+    int iNumChannels;
+    int iNumSamples;
+
+    MatrixXf matData;
+};
+
+//=============================================================================================================
+
+TestRtStreamCodec::TestRtStreamCodec()
+: iNumChannels(12)
+, iNumSamples(200)
+{
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::initTestCase()
+{
+    qInstallMessageHandler(UTILSLIB::ApplicationLogger::customLogWriter);
+
+    // Random walks with the amplitudes of MEG, EEG and stimulus channels
+    std::srand(42);
+    matData = MatrixXf::Random(iNumChannels, iNumSamples);
+    for(int j = 1; j < iNumSamples; ++j) {
+        matData.col(j) += matData.col(j-1);
+    }
+    for(int i = 0; i < iNumChannels; ++i) {
+        matData.row(i) *= std::pow(10.0f, -12.0f + 4.0f * (i % 4));
+    }
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::comparePlain()
+{
+    RtStreamCodec codec(1, RowVectorXi(), -1);
+    QVERIFY(codec.isDefault());
+
+    MatrixXf matDecoded;
+    QVERIFY(roundTrip(codec, matData, matDecoded));
+    QVERIFY(matDecoded.rows() == matData.rows() && matDecoded.cols() == matData.cols());
+    QVERIFY((matDecoded.array() == matData.array()).all());
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareLossless()
+{
+    RtStreamCodec codec(1, RowVectorXi(), 0);
+    QVERIFY(!codec.isDefault());
+
+    // Zeros and sign changes next to the random walks
+    MatrixXf matIn = matData;
+    matIn.row(0).setZero();
+    matIn.row(1) = matData.row(1) - RowVectorXf::Constant(iNumSamples, matData.row(1).mean());
+
+    MatrixXf matDecoded;
+    QVERIFY(roundTrip(codec, matIn, matDecoded));
+    QVERIFY(matDecoded.rows() == matIn.rows() && matDecoded.cols() == matIn.cols());
+    QVERIFY((matDecoded.array() == matIn.array()).all());
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareNearLossless()
+{
+    for(int iBits : QList<int>() << 2 << 8 << 16) {
+        RtStreamCodec codec(1, RowVectorXi(), iBits);
+
+        MatrixXf matDecoded;
+        QVERIFY(roundTrip(codec, matData, matDecoded));
+        QVERIFY(matDecoded.rows() == matData.rows() && matDecoded.cols() == matData.cols());
+        compareQuantised(matData, matDecoded, iBits);
+    }
+
+    // One bit can not represent a sign, it is raised to two
+    QVERIFY(RtStreamCodec(1, RowVectorXi(), 1).mode() == RtStreamCodec(1, RowVectorXi(), 2).mode());
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareEscape()
+{
+    // A single spike makes residuals far above the Rice parameter of the otherwise small deltas, which are
+    // stored verbatim after the escape code
+    MatrixXf matIn = matData;
+    matIn.row(2).setZero();
+    matIn(2, iNumSamples / 2) = 1.0e6f;
+    matIn(3, iNumSamples / 3) = -matIn(3, iNumSamples / 3) * 1.0e4f;
+
+    MatrixXf matDecoded;
+
+    RtStreamCodec codecLossless(1, RowVectorXi(), 0);
+    QVERIFY(roundTrip(codecLossless, matIn, matDecoded));
+    QVERIFY((matDecoded.array() == matIn.array()).all());
+
+    RtStreamCodec codecNearLossless(1, RowVectorXi(), 16);
+    QVERIFY(roundTrip(codecNearLossless, matIn, matDecoded));
+    compareQuantised(matIn, matDecoded, 16);
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareDecimation()
+{
+    // Buffer lengths which are no multiple of the decimation, incomplete blocks carry over to the next buffer
+    const int iDecimation = 3;
+    RtStreamCodec codec(iDecimation, RowVectorXi(), -1);
+
+    QList<int> lBufferSizes;
+    lBufferSizes << 2 << 10 << 7 << 1 << 4;
+
+    MatrixXf matDecoded = MatrixXf::Zero(iNumChannels, 0);
+    int iFrom = 0;
+    int iCarry = 0;
+    for(int iSize : lBufferSizes) {
+        MatrixXf matBuffer;
+        bool bEncoded = roundTrip(codec, matData.middleCols(iFrom, iSize), matBuffer);
+        iFrom += iSize;
+
+        // Nothing is sent for buffers which do not complete an output sample
+        QCOMPARE(bEncoded, (iCarry + iSize) / iDecimation > 0);
+        iCarry = (iCarry + iSize) % iDecimation;
+        if(bEncoded) {
+            matDecoded.conservativeResize(NoChange, matDecoded.cols() + matBuffer.cols());
+            matDecoded.rightCols(matBuffer.cols()) = matBuffer;
+        }
+    }
+
+    QCOMPARE(int(matDecoded.cols()), iFrom / iDecimation);
+
+    for(int j = 0; j < matDecoded.cols(); ++j) {
+        VectorXf vecMean = matData.middleCols(j * iDecimation, iDecimation).rowwise().mean();
+        for(int i = 0; i < iNumChannels; ++i) {
+            QVERIFY(std::fabs(matDecoded(i,j) - vecMean[i]) <= 1e-5f * matData.row(i).cwiseAbs().maxCoeff());
+        }
+    }
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareChannelSubset()
+{
+    // Indices which are out of range are skipped
+    RowVectorXi vecChannels(5);
+    vecChannels << 5, 999, 1, -1, 7;
+    RtStreamCodec codec(2, vecChannels, 8);
+
+    MatrixXf matDecoded;
+    QVERIFY(roundTrip(codec, matData.leftCols(20), matDecoded));
+    QVERIFY(matDecoded.rows() == 3 && matDecoded.cols() == 10);
+
+    MatrixXf matPicked(3, 10);
+    int iRow = 0;
+    for(int iChannel : QList<int>() << 5 << 1 << 7) {
+        for(int j = 0; j < 10; ++j) {
+            matPicked(iRow, j) = matData.block(iChannel, 2 * j, 1, 2).mean();
+        }
+        ++iRow;
+    }
+    compareQuantised(matPicked, matDecoded, 8);
+
+    // The measurement info describes the streamed channels and the decimated sampling frequency
+    FiffInfo info;
+    for(int i = 0; i < iNumChannels; ++i) {
+        FiffChInfo chInfo;
+        chInfo.ch_name = QString("CH %1").arg(i);
+        info.chs.append(chInfo);
+        info.ch_names.append(chInfo.ch_name);
+    }
+    info.nchan = iNumChannels;
+    info.sfreq = 600.0f;
+    info.lowpass = 200.0f;
+
+    FiffInfo infoReduced = codec.reduceInfo(info);
+    QCOMPARE(infoReduced.nchan, 3);
+    QCOMPARE(infoReduced.ch_names, QStringList() << "CH 5" << "CH 1" << "CH 7");
+    QCOMPARE(infoReduced.chs.size(), 3);
+    QCOMPARE(infoReduced.chs[1].ch_name, QString("CH 1"));
+    QCOMPARE(infoReduced.sfreq, 300.0f);
+    QCOMPARE(infoReduced.lowpass, 150.0f);
+
+    // Only the compression may change without a new measurement info
+    QVERIFY(codec.hasSameLayout(RtStreamCodec(2, vecChannels, 0)));
+    QVERIFY(!codec.hasSameLayout(RtStreamCodec(1, vecChannels, 8)));
+    QVERIFY(!codec.hasSameLayout(RtStreamCodec(2, RowVectorXi(), 8)));
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::cleanupTestCase()
+{
+}
+
+//=============================================================================================================
+
+bool TestRtStreamCodec::roundTrip(RtStreamCodec& codec,
+                                  const MatrixXf& matIn,
+                                  MatrixXf& matOut)
+{
+    QByteArray baTag = codec.encode(matIn);
+    if(baTag.isEmpty()) {
+        return false;
+    }
+
+    FiffStream stream(&baTag, QIODevice::ReadOnly);
+    FiffTag::SPtr pTag;
+    if(!stream.read_tag(pTag, 0) || pTag->kind != FIFF_MNE_RT_STREAM_BUFFER) {
+        return false;
+    }
+
+    return RtStreamCodec::decode(*pTag, matOut);
+}
+
+//=============================================================================================================
+
+void TestRtStreamCodec::compareQuantised(const MatrixXf& matIn,
+                                         const MatrixXf& matOut,
+                                         int iBits)
+{
+    QVERIFY(matIn.rows() == matOut.rows() && matIn.cols() == matOut.cols());
+
+    for(int i = 0; i < matIn.rows(); ++i) {
+        // Half a step plus the rounding of the float arithmetic
+        const float fMaxAbs = matIn.row(i).cwiseAbs().maxCoeff();
+        const float fStep = fMaxAbs / static_cast<float>((1 << (iBits - 1)) - 1);
+        const float fBound = 0.5f * fStep + 4.0f * std::numeric_limits<float>::epsilon() * fMaxAbs;
+
+        QVERIFY((matOut.row(i) - matIn.row(i)).cwiseAbs().maxCoeff() <= fBound);
+    }
+}
+
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtStreamCodec)
+#include "test_rtstreamcodec.moc"
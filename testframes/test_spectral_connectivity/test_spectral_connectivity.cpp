@@ -51,8 +51,11 @@
 #include <connectivity/metrics/debiasedsquaredweightedphaselagindex.h>
 #include <connectivity/metrics/crosscorrelation.h>
 #include <connectivity/connectivitysettings.h>
+#include <connectivity/connectivity.h>
 #include <connectivity/network/network.h>
 
+#include <rtprocessing/rtconnectivity.h>
+
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
@@ -71,6 +74,7 @@
 
 using namespace Eigen;
 using namespace CONNECTIVITYLIB;
+using namespace RTPROCESSINGLIB;
 using namespace UTILSLIB;
 
 //=============================================================================================================
@@ -97,6 +101,8 @@ private slots:
     void spectralConnectivityCoherence();
     void spectralConnectivityImagCoherence();
     void spectralConnectivityXCOR();
+    void spectralConnectivityCompactStorage();
+    void spectralConnectivityIncremental();
     void cleanupTestCase();
 
 private:
@@ -348,6 +354,100 @@ void TestSpectralConnectivity::spectralConnectivityXCOR()
 
 //=============================================================================================================
 
+void TestSpectralConnectivity::spectralConnectivityCompactStorage()
+{
+    //*********************************************************************************************************
+    // Compute Connectivity With And Without Compact Network Storage
+    //*********************************************************************************************************
+
+    Network network = PhaseLockingValue::calculate(m_connectivitySettings);
+
+    m_connectivitySettings.setCompactNetworkStorage(true);
+    Network networkCompact = PhaseLockingValue::calculate(m_connectivitySettings);
+    m_connectivitySettings.setCompactNetworkStorage(false);
+
+    QVERIFY(networkCompact.isCompactStorage());
+
+    //*********************************************************************************************************
+    // Compare Networks. Compact storage keeps the weights as floats.
+    //*********************************************************************************************************
+
+    double dThreshold = network.getFullConnectivityMatrix()(0,1) / 2.0;
+    network.setThreshold(dThreshold);
+    networkCompact.setThreshold(dThreshold);
+
+    QVERIFY(network.getFullConnectivityMatrix().isApprox(networkCompact.getFullConnectivityMatrix(), 1e-5));
+    QVERIFY(network.getThresholdedConnectivityMatrix().isApprox(networkCompact.getThresholdedConnectivityMatrix(), 1e-5));
+    QCOMPARE(networkCompact.getThresholdedDistribution(), network.getThresholdedDistribution());
+    QCOMPARE(networkCompact.getMinMaxFullDegrees(), network.getMinMaxFullDegrees());
+
+    // Edge objects are created on demand
+    QCOMPARE(networkCompact.getFullEdges().size(), network.getFullEdges().size());
+    QCOMPARE(networkCompact.getThresholdedEdges().size(), network.getThresholdedEdges().size());
+}
+
+//=============================================================================================================
+
+void TestSpectralConnectivity::spectralConnectivityIncremental()
+{
+    //*********************************************************************************************************
+    // Feed the trials in chunks to the incremental worker and compare each result with a batch computation
+    // over the same window
+    //*********************************************************************************************************
+
+    QList<MatrixXd> matDataList = readConnectivityData();
+    QStringList lMethods = QStringList() << "WPLI" << "USPLI" << "PLI" << "COH" << "IMAGCOH" << "PLV" << "DSWPLI";
+    int iWindowSize = qMax(2, matDataList.size() / 2);
+    int iChunkSize = 3;
+
+    QVERIFY(!AbstractMetric::m_bStorageModeIsActive);
+
+    RtConnectivityWorker worker;
+    QList<Network> lIncrementalNetworks;
+    connect(&worker, &RtConnectivityWorker::resultReady,
+            [&lIncrementalNetworks](const QList<Network>& connectivityResults, const ConnectivitySettings&) {
+                lIncrementalNetworks = connectivityResults;
+            });
+
+    for(int i = 0; i < matDataList.size(); i += iChunkSize) {
+        ConnectivitySettings chunkSettings;
+        chunkSettings.setConnectivityMethods(lMethods);
+        chunkSettings.setFFTSize(matDataList.at(0).cols());
+        chunkSettings.setWindowType("hanning");
+        chunkSettings.append(matDataList.mid(i, iChunkSize));
+
+        lIncrementalNetworks.clear();
+        worker.doWorkIncremental(chunkSettings, iWindowSize);
+
+        // The storage mode must not leak into other connectivity computations
+        QVERIFY(!AbstractMetric::m_bStorageModeIsActive);
+
+        int iEnd = qMin(i + iChunkSize, matDataList.size());
+        int iStart = qMax(0, iEnd - iWindowSize);
+
+        ConnectivitySettings batchSettings;
+        batchSettings.setConnectivityMethods(lMethods);
+        batchSettings.setFFTSize(matDataList.at(0).cols());
+        batchSettings.setWindowType("hanning");
+        batchSettings.append(matDataList.mid(iStart, iEnd - iStart));
+
+        QList<Network> lBatchNetworks = Connectivity::calculate(batchSettings);
+
+        QCOMPARE(lIncrementalNetworks.size(), lBatchNetworks.size());
+
+        for(int j = 0; j < lBatchNetworks.size(); ++j) {
+            MatrixXd matIncremental = lIncrementalNetworks.at(j).getFullConnectivityMatrix();
+            MatrixXd matBatch = lBatchNetworks.at(j).getFullConnectivityMatrix();
+
+            QCOMPARE(lIncrementalNetworks.at(j).getConnectivityMethod(), lBatchNetworks.at(j).getConnectivityMethod());
+            QVERIFY(matIncremental.rows() == matBatch.rows() && matIncremental.cols() == matBatch.cols());
+            QVERIFY((matIncremental - matBatch).cwiseAbs().maxCoeff() < 1e-8);
+        }
+    }
+}
+
+//=============================================================================================================
+
 QList<MatrixXd> TestSpectralConnectivity::readConnectivityData()
 {
     MatrixXd inputTrials;
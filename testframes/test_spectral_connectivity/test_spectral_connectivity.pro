@@ -59,13 +59,19 @@ contains(MNECPP_CONFIG, static) {
 
 LIBS += -L$${MNE_LIBRARY_DIR}
 CONFIG(debug, debug|release) {
-    LIBS += -lmnecppConnectivityd \
+    LIBS += -lmnecppRtProcessingd \
+            -lmnecppConnectivityd \
+            -lmnecppInversed \
+            -lmnecppFwdd \
             -lmnecppMned \
             -lmnecppFiffd \
             -lmnecppFsd \
             -lmnecppUtilsd \
 } else {
-    LIBS += -lmnecppConnectivity \
+    LIBS += -lmnecppRtProcessing \
+            -lmnecppConnectivity \
+            -lmnecppInverse \
+            -lmnecppFwd \
             -lmnecppMne \
             -lmnecppFiff \
             -lmnecppFs \
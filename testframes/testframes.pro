@@ -54,6 +54,10 @@ SUBDIRS += \
     test_filtering \
     test_hpiFit \
     test_mne_forward_solution \
+    test_minimumnorm \
+    test_rapmusic \
+    test_rtcov \
+    test_rtstreamcodec \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \